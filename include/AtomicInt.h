@@ -34,6 +34,19 @@ public:
 	}
 #endif
 
+#if QT_VERSION < 0x050000
+	// Qt5 style explicitly ordered accessors
+	int loadAcquire() const
+	{
+		return const_cast<AtomicInt *>( this )->fetchAndAddAcquire( 0 );
+	}
+
+	void storeRelease( int newValue )
+	{
+		fetchAndStoreRelease( newValue );
+	}
+#endif
+
 };
 
 #else
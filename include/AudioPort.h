@@ -33,6 +33,7 @@
 #include "PlayHandle.h"
 
 class EffectChain;
+class FreezeCache;
 class FloatModel;
 class BoolModel;
 
@@ -87,6 +88,13 @@ public:
 		m_nextFxChannel = _chnl;
 	}
 
+	// record the output into / stream it from the given cache
+	// (NULL = none), has to be set with the mixer locked
+	void setFreezeCache( FreezeCache * cache )
+	{
+		m_freezeCache = cache;
+	}
+
 
 	const QString & name() const
 	{
@@ -121,6 +129,8 @@ private:
 
 	EffectChain * m_effects;
 
+	FreezeCache * m_freezeCache;
+
 	PlayHandleList m_playHandles;
 	QMutex m_playHandleLock;
 
@@ -28,6 +28,7 @@
 #include <QtCore/QMap>
 #include <QtCore/QMutex>
 
+#include "AtomicInt.h"
 #include "JournallingObject.h"
 #include "Model.h"
 #include "MidiTime.h"
@@ -144,7 +145,16 @@ public:
 
 	//! @brief Function that returns sample-exact data as a ValueBuffer
 	//! @return pointer to model's valueBuffer when s.ex.data exists, NULL otherwise
-	ValueBuffer * valueBuffer();
+	//! The buffer is computed once per period by the first caller, all
+	//! further calls within the same period return it without locking.
+	inline ValueBuffer * valueBuffer()
+	{
+		if( isValueBufferCurrent() )
+		{
+			return m_hasSampleExactData ? &m_valueBuffer : NULL;
+		}
+		return updateValueBuffer();
+	}
 
 	template<class T>
 	T initValue() const
@@ -323,6 +333,24 @@ private:
 	//! @param value will be modified to rounded value
 	template<class T> void roundAt( T &value, const T &where ) const;
 
+	//! computes this period's value buffer and publishes it
+	ValueBuffer * updateValueBuffer();
+
+	//! whether m_valueBuffer was computed in the current period - the
+	//! counter wraps around, which is fine as it's only compared for
+	//! equality
+	inline bool isValueBufferCurrent() const
+	{
+		return static_cast<unsigned int>(
+				m_lastUpdatedPeriod.loadAcquire() ) == s_periodCounter;
+	}
+
+	inline void publishValueBuffer()
+	{
+		m_lastUpdatedPeriod.storeRelease(
+					static_cast<int>( s_periodCounter ) );
+	}
+
 
 	DataType m_dataType;
 	ScaleType m_scaleType; //! scale type, linear by default
@@ -355,8 +383,11 @@ private:
 	static float s_copiedValue;
 
 	ValueBuffer m_valueBuffer;
-	long m_lastUpdatedPeriod;
-	static long s_periodCounter;
+	// period for which m_valueBuffer and m_hasSampleExactData are valid -
+	// written with release semantics after both have been updated so that
+	// readers seeing the current period can use them without locking
+	AtomicInt m_lastUpdatedPeriod;
+	static unsigned int s_periodCounter;
 
 	bool m_hasSampleExactData;
 
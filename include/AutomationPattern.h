@@ -82,6 +82,11 @@ public:
 				const bool quantPos = true,
 				const bool ignoreSurroundingPoints = true );
 
+	// adds many values at once, computing tangents and length and
+	// notifying views only once - unlike putValue() it never removes
+	// surrounding points
+	void putValues( const timeMap & values, const bool quantPos = true );
+
 	void removeValue( const MidiTime & time );
 
 	void recordValue(MidiTime time, float value);
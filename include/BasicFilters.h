@@ -148,6 +148,7 @@ class BiQuad
 public:
 	BiQuad() 
 	{
+		setCoeffs( 0.0f, 0.0f, 0.0f, 0.0f, 0.0f );
 		clearHistory();
 	}
 	virtual ~BiQuad() {}
@@ -176,6 +177,77 @@ public:
 		m_z2[ch] = m_b2 * in - m_a2 * out;
 		return out;
 	}
+
+	// process a block of interleaved frames in-place - coefficients and
+	// history are kept in locals and all channels of a frame are computed
+	// together so the compiler can vectorize the inner loop
+	inline void processBlock( float (*buf)[CHANNELS], const fpp_t frames )
+	{
+		const float a1 = m_a1, a2 = m_a2, b0 = m_b0, b1 = m_b1, b2 = m_b2;
+		float z1[CHANNELS], z2[CHANNELS];
+		for( int ch = 0; ch < CHANNELS; ++ch )
+		{
+			z1[ch] = m_z1[ch];
+			z2[ch] = m_z2[ch];
+		}
+		for( fpp_t f = 0; f < frames; ++f )
+		{
+			for( int ch = 0; ch < CHANNELS; ++ch )
+			{
+				const float in = buf[f][ch];
+				const float out = z1[ch] + b0 * in;
+				z1[ch] = b1 * in + z2[ch] - a1 * out;
+				z2[ch] = b2 * in - a2 * out;
+				buf[f][ch] = out;
+			}
+		}
+		for( int ch = 0; ch < CHANNELS; ++ch )
+		{
+			m_z1[ch] = z1[ch];
+			m_z2[ch] = z2[ch];
+		}
+	}
+	// like processBlock() above, but moves the coefficients linearly from
+	// their current values to the given ones, reaching them at the last
+	// frame
+	inline void processBlock( float (*buf)[CHANNELS], const fpp_t frames,
+					float ta1, float ta2, float tb0, float tb1,
+								float tb2 )
+	{
+		const float step = 1.0f / frames;
+		const float da1 = ( ta1 - m_a1 ) * step, da2 = ( ta2 - m_a2 ) * step,
+			db0 = ( tb0 - m_b0 ) * step, db1 = ( tb1 - m_b1 ) * step,
+			db2 = ( tb2 - m_b2 ) * step;
+		float a1 = m_a1, a2 = m_a2, b0 = m_b0, b1 = m_b1, b2 = m_b2;
+		float z1[CHANNELS], z2[CHANNELS];
+		for( int ch = 0; ch < CHANNELS; ++ch )
+		{
+			z1[ch] = m_z1[ch];
+			z2[ch] = m_z2[ch];
+		}
+		for( fpp_t f = 0; f < frames; ++f )
+		{
+			a1 += da1;
+			a2 += da2;
+			b0 += db0;
+			b1 += db1;
+			b2 += db2;
+			for( int ch = 0; ch < CHANNELS; ++ch )
+			{
+				const float in = buf[f][ch];
+				const float out = z1[ch] + b0 * in;
+				z1[ch] = b1 * in + z2[ch] - a1 * out;
+				z2[ch] = b2 * in - a2 * out;
+				buf[f][ch] = out;
+			}
+		}
+		for( int ch = 0; ch < CHANNELS; ++ch )
+		{
+			m_z1[ch] = z1[ch];
+			m_z2[ch] = z2[ch];
+		}
+		setCoeffs( ta1, ta2, tb0, tb1, tb2 );
+	}
 private:
 	float m_a1, m_a2, m_b0, m_b1, m_b2;
 	float m_z1 [CHANNELS], m_z2 [CHANNELS];
@@ -223,6 +295,8 @@ class BasicFilters
 {
 	MM_OPERATORS
 public:
+	typedef sample_t frame[CHANNELS];
+
 	enum FilterTypes
 	{
 		LowPass,
@@ -262,6 +336,13 @@ public:
 
 	inline void setFilterType( const int _idx )
 	{
+		if( _idx != m_filterIndex )
+		{
+			// coefficients of another type can't be interpolated from
+			m_coeffsValid = false;
+			m_filterIndex = _idx;
+		}
+
 		m_doubleFilter = _idx == DoubleLowPass || _idx == DoubleMoog;
 		if( !m_doubleFilter )
 		{
@@ -287,8 +368,12 @@ public:
 		m_doubleFilter( false ),
 		m_sampleRate( (float) _sample_rate ),
 		m_sampleRatio( 1.0f / m_sampleRate ),
-		m_subFilter( NULL )
+		m_subFilter( NULL ),
+		m_filterIndex( -1 ),
+		m_coeffsValid( false )
 	{
+		Coeffs c = {};
+		setCoeffs( c );
 		clearHistory();
 	}
 
@@ -332,6 +417,122 @@ public:
 	{
 		sample_t out;
 		switch( m_type )
+		{
+			case Moog: out = updateFilter<Moog>( _in0, _chnl ); break;
+			case Lowpass_RC12: out = updateFilter<Lowpass_RC12>( _in0, _chnl ); break;
+			case Bandpass_RC12: out = updateFilter<Bandpass_RC12>( _in0, _chnl ); break;
+			case Highpass_RC12: out = updateFilter<Highpass_RC12>( _in0, _chnl ); break;
+			case Lowpass_RC24: out = updateFilter<Lowpass_RC24>( _in0, _chnl ); break;
+			case Bandpass_RC24: out = updateFilter<Bandpass_RC24>( _in0, _chnl ); break;
+			case Highpass_RC24: out = updateFilter<Highpass_RC24>( _in0, _chnl ); break;
+			case Formantfilter: out = updateFilter<Formantfilter>( _in0, _chnl ); break;
+			case Lowpass_SV: out = updateFilter<Lowpass_SV>( _in0, _chnl ); break;
+			case Bandpass_SV: out = updateFilter<Bandpass_SV>( _in0, _chnl ); break;
+			case Highpass_SV: out = updateFilter<Highpass_SV>( _in0, _chnl ); break;
+			case Notch_SV: out = updateFilter<Notch_SV>( _in0, _chnl ); break;
+			case FastFormant: out = updateFilter<FastFormant>( _in0, _chnl ); break;
+			case Tripole: out = updateFilter<Tripole>( _in0, _chnl ); break;
+			default: out = m_biQuad.update( _in0, _chnl ); break;
+		}
+
+		if( m_doubleFilter )
+		{
+			return m_subFilter->update( out, _chnl );
+		}
+
+		// Clipper band limited sigmoid
+		return out;
+	}
+
+
+	//! filters a block of frames in-place with the current coefficients,
+	//! dispatching on the filter type once per block instead of per sample
+	inline void processBlock( frame * _buf, const fpp_t _frames )
+	{
+		switch( m_type )
+		{
+			case Moog: processKernel<Moog>( _buf, _frames ); break;
+			case Lowpass_RC12: processKernel<Lowpass_RC12>( _buf, _frames ); break;
+			case Bandpass_RC12: processKernel<Bandpass_RC12>( _buf, _frames ); break;
+			case Highpass_RC12: processKernel<Highpass_RC12>( _buf, _frames ); break;
+			case Lowpass_RC24: processKernel<Lowpass_RC24>( _buf, _frames ); break;
+			case Bandpass_RC24: processKernel<Bandpass_RC24>( _buf, _frames ); break;
+			case Highpass_RC24: processKernel<Highpass_RC24>( _buf, _frames ); break;
+			case Formantfilter: processKernel<Formantfilter>( _buf, _frames ); break;
+			case Lowpass_SV: processKernel<Lowpass_SV>( _buf, _frames ); break;
+			case Bandpass_SV: processKernel<Bandpass_SV>( _buf, _frames ); break;
+			case Highpass_SV: processKernel<Highpass_SV>( _buf, _frames ); break;
+			case Notch_SV: processKernel<Notch_SV>( _buf, _frames ); break;
+			case FastFormant: processKernel<FastFormant>( _buf, _frames ); break;
+			case Tripole: processKernel<Tripole>( _buf, _frames ); break;
+			default: m_biQuad.processBlock( _buf, _frames ); break;
+		}
+
+		if( m_doubleFilter )
+		{
+			m_subFilter->processBlock( _buf, _frames );
+		}
+	}
+
+
+	//! filters a block of frames in-place while moving the coefficients
+	//! linearly from their current values to the ones for _freq and _q,
+	//! so that modulated cutoff and resonance don't step from one block to
+	//! the next; the coefficients for _freq and _q are reached at the last
+	//! frame
+	inline void processBlock( frame * _buf, const fpp_t _frames,
+						float _freq, float _q )
+	{
+		if( !m_coeffsValid || _frames <= 1 )
+		{
+			calcFilterCoeffs( _freq, _q );
+			processBlock( _buf, _frames );
+			return;
+		}
+
+		Coeffs from, to, subFrom;
+		getCoeffs( from );
+		if( m_doubleFilter )
+		{
+			m_subFilter->getCoeffs( subFrom );
+		}
+		calcFilterCoeffs( _freq, _q );
+		getCoeffs( to );
+
+		rampBlock( _buf, _frames, from, to );
+		if( m_doubleFilter )
+		{
+			m_subFilter->rampBlock( _buf, _frames, subFrom, to );
+		}
+	}
+
+
+	//! runs the filter over a block, with RAMP the coefficients are
+	//! advanced by m_rampStep before each frame
+	template<int TYPE, bool RAMP = false>
+	inline void processKernel( frame * _buf, const fpp_t _frames )
+	{
+		for( fpp_t f = 0; f < _frames; ++f )
+		{
+			if( RAMP )
+			{
+				stepCoeffs<TYPE>();
+			}
+			for( ch_cnt_t ch = 0; ch < CHANNELS; ++ch )
+			{
+				_buf[f][ch] = updateFilter<TYPE>( _buf[f][ch], ch );
+			}
+		}
+	}
+
+
+	//! filters one sample of one channel - the filter type is a template
+	//! parameter so the switch is resolved at compile time
+	template<int TYPE>
+	inline sample_t updateFilter( sample_t _in0, ch_cnt_t _chnl )
+	{
+		sample_t out;
+		switch( TYPE )
 		{
 			case Moog:
 			{
@@ -420,7 +621,7 @@ public:
 				}
 
 				/* mix filter output into output buffer */
-				return m_type == Lowpass_SV 
+				return TYPE == Lowpass_SV 
 					? m_delay4[_chnl]
 					: m_delay3[_chnl];
 			}
@@ -507,7 +708,7 @@ public:
 					m_rchp0[_chnl] = hp;
 					m_rcbp0[_chnl] = bp;
 				}
-				return m_type == Highpass_RC12 ? hp : bp;
+				return TYPE == Highpass_RC12 ? hp : bp;
 			}
 
 			case Lowpass_RC24:
@@ -574,7 +775,7 @@ public:
 					m_rcbp0[_chnl] = bp;
 
 					// second stage gets the output of the first stage as input...
-					in = m_type == Highpass_RC24
+					in = TYPE == Highpass_RC24
 						? hp + m_rcbp1[_chnl] * m_rcq
 						: bp + m_rcbp1[_chnl] * m_rcq;
 
@@ -590,7 +791,7 @@ public:
 					m_rchp1[_chnl] = hp;
 					m_rcbp1[_chnl] = bp;
 				}
-				return m_type == Highpass_RC24 ? hp : bp;
+				return TYPE == Highpass_RC24 ? hp : bp;
 			}
 
 			case Formantfilter:
@@ -600,7 +801,7 @@ public:
 				sample_t hp, bp, in;
 
 				out = 0;
-				const int os = m_type == FastFormant ? 1 : 4; // no oversampling for fast formant
+				const int os = TYPE == FastFormant ? 1 : 4; // no oversampling for fast formant
 				for( int o = 0; o < os; ++o )
 				{
 					// first formant
@@ -687,7 +888,7 @@ public:
 
 					out += bp;
 				}
-            	return m_type == FastFormant ? out * 2.0f : out * 0.5f;
+            	return TYPE == FastFormant ? out * 2.0f : out * 0.5f;
 			}
 
 			default:
@@ -695,18 +896,15 @@ public:
 				break;
 		}
 
-		if( m_doubleFilter )
-		{
-			return m_subFilter->update( out, _chnl );
-		}
-
-		// Clipper band limited sigmoid
 		return out;
 	}
 
 
+
 	inline void calcFilterCoeffs( float _freq, float _q )
 	{
+		m_coeffsValid = true;
+
 		// temp coef vars
 		_q = qMax( _q, minQ() );
 
@@ -872,6 +1070,165 @@ public:
 
 
 private:
+	// snapshot of all coefficients, used to ramp between two
+	// calcFilterCoeffs() calls
+	struct Coeffs
+	{
+		float a1, a2, b0, b1, b2;
+		float r, p, k;
+		float rca, rcb, rcc, rcq;
+		float vfa[2], vfb[2], vfc[2], vfq;
+		float svf1, svf2, svq;
+	} ;
+
+	inline void getCoeffs( Coeffs & _c ) const
+	{
+		_c.a1 = m_biQuad.m_a1;
+		_c.a2 = m_biQuad.m_a2;
+		_c.b0 = m_biQuad.m_b0;
+		_c.b1 = m_biQuad.m_b1;
+		_c.b2 = m_biQuad.m_b2;
+		_c.r = m_r;
+		_c.p = m_p;
+		_c.k = m_k;
+		_c.rca = m_rca;
+		_c.rcb = m_rcb;
+		_c.rcc = m_rcc;
+		_c.rcq = m_rcq;
+		for( int i = 0; i < 2; ++i )
+		{
+			_c.vfa[i] = m_vfa[i];
+			_c.vfb[i] = m_vfb[i];
+			_c.vfc[i] = m_vfc[i];
+		}
+		_c.vfq = m_vfq;
+		_c.svf1 = m_svf1;
+		_c.svf2 = m_svf2;
+		_c.svq = m_svq;
+	}
+
+	inline void setCoeffs( const Coeffs & _c )
+	{
+		m_biQuad.setCoeffs( _c.a1, _c.a2, _c.b0, _c.b1, _c.b2 );
+		m_r = _c.r;
+		m_p = _c.p;
+		m_k = _c.k;
+		m_rca = _c.rca;
+		m_rcb = _c.rcb;
+		m_rcc = _c.rcc;
+		m_rcq = _c.rcq;
+		for( int i = 0; i < 2; ++i )
+		{
+			m_vfa[i] = _c.vfa[i];
+			m_vfb[i] = _c.vfb[i];
+			m_vfc[i] = _c.vfc[i];
+		}
+		m_vfq = _c.vfq;
+		m_svf1 = _c.svf1;
+		m_svf2 = _c.svf2;
+		m_svq = _c.svq;
+	}
+
+	// filters a block in-place while moving the coefficients linearly
+	// from _from to _to - the increments are calculated once and the
+	// type-specific kernel only adds the ones of its own coefficients
+	inline void rampBlock( frame * _buf, const fpp_t _frames,
+				const Coeffs & _from, const Coeffs & _to )
+	{
+		setCoeffs( _from );
+
+		const float step = 1.0f / _frames;
+		m_rampStep.r = ( _to.r - _from.r ) * step;
+		m_rampStep.p = ( _to.p - _from.p ) * step;
+		m_rampStep.k = ( _to.k - _from.k ) * step;
+		m_rampStep.rca = ( _to.rca - _from.rca ) * step;
+		m_rampStep.rcb = ( _to.rcb - _from.rcb ) * step;
+		m_rampStep.rcc = ( _to.rcc - _from.rcc ) * step;
+		m_rampStep.rcq = ( _to.rcq - _from.rcq ) * step;
+		for( int i = 0; i < 2; ++i )
+		{
+			m_rampStep.vfa[i] = ( _to.vfa[i] - _from.vfa[i] ) * step;
+			m_rampStep.vfb[i] = ( _to.vfb[i] - _from.vfb[i] ) * step;
+			m_rampStep.vfc[i] = ( _to.vfc[i] - _from.vfc[i] ) * step;
+		}
+		m_rampStep.vfq = ( _to.vfq - _from.vfq ) * step;
+		m_rampStep.svf1 = ( _to.svf1 - _from.svf1 ) * step;
+		m_rampStep.svf2 = ( _to.svf2 - _from.svf2 ) * step;
+		m_rampStep.svq = ( _to.svq - _from.svq ) * step;
+
+		switch( m_type )
+		{
+			case Moog: processKernel<Moog, true>( _buf, _frames ); break;
+			case Lowpass_RC12: processKernel<Lowpass_RC12, true>( _buf, _frames ); break;
+			case Bandpass_RC12: processKernel<Bandpass_RC12, true>( _buf, _frames ); break;
+			case Highpass_RC12: processKernel<Highpass_RC12, true>( _buf, _frames ); break;
+			case Lowpass_RC24: processKernel<Lowpass_RC24, true>( _buf, _frames ); break;
+			case Bandpass_RC24: processKernel<Bandpass_RC24, true>( _buf, _frames ); break;
+			case Highpass_RC24: processKernel<Highpass_RC24, true>( _buf, _frames ); break;
+			case Formantfilter: processKernel<Formantfilter, true>( _buf, _frames ); break;
+			case Lowpass_SV: processKernel<Lowpass_SV, true>( _buf, _frames ); break;
+			case Bandpass_SV: processKernel<Bandpass_SV, true>( _buf, _frames ); break;
+			case Highpass_SV: processKernel<Highpass_SV, true>( _buf, _frames ); break;
+			case Notch_SV: processKernel<Notch_SV, true>( _buf, _frames ); break;
+			case FastFormant: processKernel<FastFormant, true>( _buf, _frames ); break;
+			case Tripole: processKernel<Tripole, true>( _buf, _frames ); break;
+			default: m_biQuad.processBlock( _buf, _frames, _to.a1, _to.a2,
+						_to.b0, _to.b1, _to.b2 ); break;
+		}
+
+		// the summed up increments don't hit the target exactly
+		setCoeffs( _to );
+	}
+
+	// advances the coefficients used by TYPE by one step of the ramp
+	template<int TYPE>
+	inline void stepCoeffs()
+	{
+		switch( TYPE )
+		{
+			case Moog:
+			case Tripole:
+				m_r += m_rampStep.r;
+				m_p += m_rampStep.p;
+				m_k += m_rampStep.k;
+				break;
+			case Lowpass_RC12:
+			case Bandpass_RC12:
+			case Highpass_RC12:
+			case Lowpass_RC24:
+			case Bandpass_RC24:
+			case Highpass_RC24:
+				m_rca += m_rampStep.rca;
+				m_rcb += m_rampStep.rcb;
+				m_rcc += m_rampStep.rcc;
+				m_rcq += m_rampStep.rcq;
+				break;
+			case Formantfilter:
+			case FastFormant:
+				for( int i = 0; i < 2; ++i )
+				{
+					m_vfa[i] += m_rampStep.vfa[i];
+					m_vfb[i] += m_rampStep.vfb[i];
+					m_vfc[i] += m_rampStep.vfc[i];
+				}
+				m_vfq += m_rampStep.vfq;
+				break;
+			case Lowpass_SV:
+			case Bandpass_SV:
+			case Highpass_SV:
+			case Notch_SV:
+				m_svf1 += m_rampStep.svf1;
+				m_svf2 += m_rampStep.svf2;
+				m_svq += m_rampStep.svq;
+				break;
+			default:
+				break;
+		}
+	}
+
+	// per-frame increments of the coefficients while ramping
+	Coeffs m_rampStep;
+
 	// biquad filter
 	BiQuad<CHANNELS> m_biQuad;
 
@@ -887,8 +1244,6 @@ private:
 	// coeffs for Lowpass_SV (state-variant lowpass)
 	float m_svf1, m_svf2, m_svq;
 
-	typedef sample_t frame[CHANNELS];
-
 	// in/out history for moog-filter
 	frame m_y1, m_y2, m_y3, m_y4, m_oldx, m_oldy1, m_oldy2, m_oldy3;
 	// additional one for Tripole filter
@@ -911,6 +1266,11 @@ private:
 	float m_sampleRatio;
 	BasicFilters<CHANNELS> * m_subFilter;
 
+	// index passed to the last setFilterType() call
+	int m_filterIndex;
+	// whether calcFilterCoeffs() was called since the type was changed
+	bool m_coeffsValid;
+
 } ;
 
 
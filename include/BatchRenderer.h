@@ -0,0 +1,157 @@
+/*
+ * BatchRenderer.h - renders a list of projects one after another without
+ *                   restarting the engine
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#ifndef BATCH_RENDERER_H
+#define BATCH_RENDERER_H
+
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QList>
+#include <QtCore/QStringList>
+
+#include "export.h"
+#include "ProjectRenderer.h"
+#include "OutputSettings.h"
+
+class QIODevice;
+class RenderManager;
+
+
+/*! \brief Command line batch mode, see "--batch" in main.cpp.
+ *
+ *  Reads a job list with one job per line:
+ *
+ *      <project file> [<output>] [<option>=<value> ...]
+ *
+ *  Fields are separated by whitespace and can be put in double quotes,
+ *  lines starting with '#' are ignored. Supported options are format,
+ *  samplerate, bitrate, float, interpolation, oversampling, loop and tracks,
+ *  all of them default to what was given on the command line.
+ *
+ *  The engine and all plugin libraries are initialized once and reused for
+ *  every job, decoded samples are cached between jobs. Plugins can keep
+ *  their own shared data loaded between jobs with keepLoaded().
+ */
+class EXPORT BatchRenderer : public QObject
+{
+	Q_OBJECT
+public:
+	BatchRenderer( const Mixer::qualitySettings & qualitySettings,
+			const OutputSettings & outputSettings,
+			ProjectRenderer::ExportFileFormats fmt,
+			bool loop );
+	virtual ~BatchRenderer();
+
+	//! only keep every workers-th job starting at worker, has to be
+	//! called before readJobs() - used when rendering in several processes
+	void setWorker( int worker, int workers );
+
+	//! parses jobs from device, prints an error and returns false if a
+	//! line isn't valid
+	bool readJobs( QIODevice & device );
+
+	int jobCount() const
+	{
+		return m_jobs.size();
+	}
+
+	int failedJobs() const
+	{
+		return m_failedJobs;
+	}
+
+	void start();
+
+	//! true while a batch is being rendered
+	static bool isRunning();
+
+	//! keeps shared data like sound fonts loaded between jobs by holding
+	//! a reference to it, release( data ) drops that reference once the
+	//! batch is done
+	static void keepLoaded( void * data, void (* release)( void * ) );
+
+
+signals:
+	void finished();
+
+
+private slots:
+	void startNextJob();
+	void jobFinished();
+
+
+private:
+	struct Job
+	{
+		Job( const Mixer::qualitySettings & qs,
+				const OutputSettings & os,
+				ProjectRenderer::ExportFileFormats fmt,
+				bool _loop ) :
+			qualitySettings( qs ),
+			outputSettings( os ),
+			format( fmt ),
+			formatGiven( false ),
+			loop( _loop ),
+			tracks( false ),
+			line( 0 )
+		{
+		}
+
+		QString project;
+		QString output;
+		Mixer::qualitySettings qualitySettings;
+		OutputSettings outputSettings;
+		ProjectRenderer::ExportFileFormats format;
+		bool formatGiven;
+		bool loop;
+		bool tracks;
+		int line;
+	} ;
+
+	static QStringList splitLine( const QString & line );
+	bool parseOption( Job & job, const QString & option );
+
+	const Job m_defaults;
+	QList<Job> m_jobs;
+	int m_worker;
+	int m_workers;
+	int m_currentJob;
+	int m_failedJobs;
+
+	RenderManager * m_renderManager;
+
+	struct LoadedData
+	{
+		void * data;
+		void (* release)( void * );
+	} ;
+	static QList<LoadedData> s_loadedData;
+	static bool s_running;
+
+	QElapsedTimer m_totalTimer;
+	QElapsedTimer m_jobTimer;
+	qint64 m_loadTime;
+
+} ;
+
+
+#endif
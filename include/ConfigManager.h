@@ -180,6 +180,11 @@ public:
 	{
 		return m_workingDir + "recover.mmp";
 	}
+
+	const QString fftwWisdomFile() const
+	{
+		return m_workingDir + "fftw.wisdom";
+	}
 	
 	const QString & version() const
 	{
@@ -69,6 +69,15 @@ public:
 	void write( QTextStream& strm );
 	bool writeFile( const QString& fn );
 
+	// takes dataFile over and leaves formatting, compression and disk
+	// I/O to a background thread; returns false if the previous
+	// background write is still in progress
+	static bool writeFileInBackground( DataFile * dataFile,
+							const QString& fn );
+	static bool isWritingInBackground();
+	// waits for a pending background write and reports if it failed
+	static void waitForBackgroundWrite();
+
 	QDomElement& content()
 	{
 		return m_content;
@@ -109,6 +118,16 @@ private:
 
 	void cleanMetaNodes( QDomElement de );
 
+	QByteArray toByteArray();
+
+	// writes xml to a temporary file and moves it over fullName once it's
+	// safely on disk, returns false if the file couldn't be opened
+	// (opened is false then), written or replaced
+	static bool writeFileData( const QString& fullName,
+					const QByteArray& xml, bool keepBackup,
+								bool& opened );
+	static void showWriteError( const QString& fullName, bool opened );
+
 	// helper upgrade routines
 	void upgrade_0_2_1_20070501();
 	void upgrade_0_2_1_20070508();
@@ -140,6 +159,9 @@ private:
 	} ;
 	static typeDescStruct s_types[TypeCount];
 
+	class BackgroundWriter;
+	static BackgroundWriter * s_backgroundWriter;
+
 	QDomElement m_content;
 	QDomElement m_head;
 	Type m_type;
@@ -0,0 +1,96 @@
+/*
+ * FftAnalysisService.h - low priority thread doing spectrum analysis for
+ *                        the GUI off the audio thread
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#ifndef FFT_ANALYSIS_SERVICE_H
+#define FFT_ANALYSIS_SERVICE_H
+
+#include <QtCore/QList>
+#include <QtCore/QMutex>
+#include <QtCore/QThread>
+
+#include "AtomicInt.h"
+#include "export.h"
+#include "lmms_basics.h"
+
+
+class EXPORT FftAnalysisService : public QThread
+{
+public:
+	//! Base class for everything that wants to analyze audio. The audio
+	//! thread pushes frames via pushFrames() which never blocks, while
+	//! analyzeWindow() is called on the analysis thread for each complete window.
+	class EXPORT Client
+	{
+	public:
+		//! windowSize has to be a power of 2
+		Client( int windowSize );
+		virtual ~Client();
+
+		//! copies frames into the lock-free ring buffer - frames which
+		//! do not fit (analysis thread lagging behind) are dropped
+		void pushFrames( const sampleFrame * buf, const fpp_t frames );
+
+	protected:
+		//! called on the analysis thread with the latest complete window
+		virtual void analyzeWindow( const sampleFrame * window, int frames ) = 0;
+
+	private:
+		bool fetchWindow();
+
+		const int m_windowSize;
+		sampleFrame * m_ring;
+		sampleFrame * m_window;
+		// monotonic positions, written by one side each
+		AtomicInt m_writePos;
+		AtomicInt m_readPos;
+
+		friend class FftAnalysisService;
+
+	} ;
+
+	//! Registers client for analysis, starting the analysis thread if
+	//! needed. Call it once the client is fully constructed.
+	static void addClient( Client * client );
+
+	//! Unregisters client, waiting for a running analyzeWindow() to finish.
+	//! Call it at the very beginning of the client's destructor.
+	static void removeClient( Client * client );
+
+
+private:
+	FftAnalysisService();
+	virtual ~FftAnalysisService();
+
+	virtual void run();
+
+	static FftAnalysisService * s_instance;
+
+	QMutex m_clientsMutex;
+	QList<Client *> m_clients;
+
+	volatile bool m_quit;
+
+} ;
+
+
+#endif
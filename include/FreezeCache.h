@@ -0,0 +1,118 @@
+/*
+ * FreezeCache.h - post-effect render cache of a frozen instrument track
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#ifndef FREEZE_CACHE_H
+#define FREEZE_CACHE_H
+
+#include <QtCore/QString>
+#include <QtCore/QVector>
+
+#include "lmms_basics.h"
+#include "MemoryManager.h"
+
+
+/*! \brief Post-effect output of a frozen AudioPort, rendered offline and
+ *  streamed back during song playback.
+ *
+ *  While the song is rendered from tick 0 by FreezeRenderer, process()
+ *  records the output of the port and sync() notes the frame at which
+ *  every tick started. That tick map includes any tempo automation, so
+ *  jumps and loops during playback can be mapped back onto the recorded
+ *  audio as long as the tempo map stays the same.
+ *
+ *  sync() is called by the owning track for every tick it is asked to
+ *  play, process() once per period by the AudioPort. Both run on the audio
+ *  threads in consecutive mixer stages. startRecording() and load() have
+ *  to be called with the mixer locked.
+ */
+class FreezeCache
+{
+	MM_OPERATORS
+public:
+	FreezeCache();
+	~FreezeCache();
+
+	// drop everything and record the first lengthTicks ticks of the song
+	// during the next render
+	void startRecording( tick_t lengthTicks );
+	// stop recording - returns false if the render didn't get through
+	bool finishRecording();
+
+	void sync( tick_t tick, f_cnt_t offset );
+
+	// records or, once the cache is complete, adds the cached frames to
+	// buf; returns true if cached audio was added
+	bool process( sampleFrame * buf, fpp_t frames, bool hasAudio );
+
+	// called instead of process() for periods in which the port produced
+	// no output at all, e.g. because it is muted
+	void skip( fpp_t frames );
+
+	bool isRecording() const
+	{
+		return m_recording;
+	}
+
+	bool isComplete() const
+	{
+		return m_complete;
+	}
+
+	// true if the current period is served from the cache
+	bool isStreaming() const
+	{
+		return m_complete && m_positionValid;
+	}
+
+	// the cache is kept in files next to the project, in the directory
+	// returned by directoryFor()
+	bool save( const QString & file ) const;
+	bool load( const QString & file );
+
+	static QString directoryFor( const QString & projectFile );
+
+
+private:
+	bool songIsPlaying() const;
+
+	sampleFrame * m_data;
+	f_cnt_t m_frames;
+	sample_rate_t m_sampleRate;
+
+	// song frame at which each tick started, -1 if not rendered yet
+	QVector<f_cnt_t> m_tickFrames;
+	tick_t m_lengthTicks;
+	tick_t m_lastTick;
+
+	// song frame of the start of the current period
+	f_cnt_t m_position;
+	bool m_positionValid;
+
+	// everything before this frame has been recorded
+	f_cnt_t m_recordedUpTo;
+	bool m_recording;
+	bool m_complete;
+
+} ;
+
+
+#endif
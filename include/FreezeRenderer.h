@@ -0,0 +1,81 @@
+/*
+ * FreezeRenderer.h - renders the song into the freeze cache of a track
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#ifndef FREEZE_RENDERER_H
+#define FREEZE_RENDERER_H
+
+#include <QtCore/QThread>
+#include <QtCore/QVector>
+
+#include "lmms_basics.h"
+
+
+class AudioDevice;
+class InstrumentTrack;
+class Track;
+
+
+// Plays the song from the start as fast as possible, like ProjectRenderer
+// does when exporting, while the given track records its output into a new
+// freeze cache. All other tracks except automation tracks are muted and the
+// master output is thrown away.
+class FreezeRenderer : public QThread
+{
+	Q_OBJECT
+public:
+	FreezeRenderer( InstrumentTrack * track );
+	virtual ~FreezeRenderer();
+
+
+public slots:
+	void startProcessing();
+	void abortProcessing();
+
+
+signals:
+	void progressChanged( int );
+	// emitted in the GUI thread once the mixer has its audio device back
+	void finishedFreezing( bool successful );
+
+
+private slots:
+	void finishProcessing();
+
+
+private:
+	virtual void run();
+
+	InstrumentTrack * m_track;
+	AudioDevice * m_device;
+	const tick_t m_lengthTicks;
+
+	// tracks muted by us to be unmuted afterwards
+	QVector<Track *> m_mutedTracks;
+	bool m_trackWasMuted;
+
+	volatile int m_progress;
+	volatile bool m_abort;
+
+} ;
+
+
+#endif
@@ -29,11 +29,26 @@
 #include "EffectChain.h"
 #include "JournallingObject.h"
 #include "ThreadableJob.h"
+#include "TripleBuffer.h"
 
 
 class FxRoute;
 typedef QVector<FxRoute *> FxRouteVector;
 
+// peak levels of a channel as displayed by the FX mixer
+struct FxChannelMeter
+{
+	FxChannelMeter() :
+		peakLeft( 0.0f ),
+		peakRight( 0.0f )
+	{
+	}
+
+	float peakLeft;
+	float peakRight;
+} ;
+
+
 class FxChannel : public ThreadableJob
 {
 	public:
@@ -47,8 +62,6 @@ class FxChannel : public ThreadableJob
 		// set to true if any effect in the channel is enabled and running
 		bool m_stillRunning;
 
-		float m_peakLeft;
-		float m_peakRight;
 		sampleFrame * m_buffer;
 		bool m_muteBeforeSolo;
 		BoolModel m_muteModel;
@@ -73,9 +86,19 @@ class FxChannel : public ThreadableJob
 		QAtomicInt m_dependenciesMet;
 		void incrementDeps();
 		void processed();
+
+		// peaks since the GUI last polled them, returns false if nothing
+		// has been published since then - only to be called from the GUI
+		// thread
+		bool pollMeter( FxChannelMeter & meter );
 		
 	private:
 		virtual void doProcessing();
+		void publishMeter( float peakLeft, float peakRight );
+
+		// peaks accumulated by the audio threads until the GUI picks them up
+		FxChannelMeter m_peaks;
+		TripleBuffer<FxChannelMeter> m_meter;
 };
 
 
@@ -26,7 +26,10 @@
 #define INSTRUMENT_PLAY_HANDLE_H
 
 #include "PlayHandle.h"
+#include "Engine.h"
 #include "Instrument.h"
+#include "InstrumentTrack.h"
+#include "Mixer.h"
 #include "NotePlayHandle.h"
 #include "export.h"
 
@@ -42,16 +45,34 @@ public:
 
 	virtual void play( sampleFrame * _working_buffer )
 	{
-		// if the instrument is midi-based, we can safely render right away
-		if( m_instrument->flags() & Instrument::IsMidiBased )
+		// we need to ensure that all our nph's have been processed first -
+		// for midi-based instruments this makes sure they got all MIDI
+		// events of this period (e.g. note-offs) and can apply them at
+		// their offsets
+		ConstNotePlayHandleList nphv = NotePlayHandle::nphsOfInstrumentTrack( m_instrument->instrumentTrack(), true );
+
+		// frozen tracks don't create notes during song playback, so
+		// any notes we get are played live - keep the instrument
+		// running for them and for a while afterwards for their release
+		if( m_instrument->instrumentTrack()->isStreamingFrozen() )
 		{
-			m_instrument->play( _working_buffer );
-			return;
+			const fpp_t frames = Engine::mixer()->framesPerPeriod();
+			if( !nphv.isEmpty() )
+			{
+				m_liveFrames = Engine::mixer()->processingSampleRate() *
+								LiveReleaseSeconds;
+			}
+			else if( m_liveFrames > frames )
+			{
+				m_liveFrames -= frames;
+			}
+			else
+			{
+				m_liveFrames = 0;
+				return;
+			}
 		}
 		
-		// if not, we need to ensure that all our nph's have been processed first
-		ConstNotePlayHandleList nphv = NotePlayHandle::nphsOfInstrumentTrack( m_instrument->instrumentTrack(), true );
-		
 		bool nphsLeft;
 		do
 		{
@@ -83,7 +104,12 @@ public:
 
 
 private:
+	// how long to keep a frozen track's instrument running after the
+	// last live note ended
+	static const int LiveReleaseSeconds = 2;
+
 	Instrument* m_instrument;
+	f_cnt_t m_liveFrames;
 
 } ;
 
@@ -45,6 +45,7 @@ template<class T> class QQueue;
 class InstrumentFunctionArpeggioView;
 class InstrumentFunctionNoteStackingView;
 class EffectRackView;
+class FreezeCache;
 class InstrumentSoundShapingView;
 class FadeButton;
 class Instrument;
@@ -210,6 +211,27 @@ public:
 
 	void setPreviewMode( const bool );
 
+	BoolModel * frozenModel()
+	{
+		return &m_frozenModel;
+	}
+
+	// true while song playback is served from the freeze cache
+	bool isStreamingFrozen() const;
+
+	// ticks of the song a freeze has to render, i.e. all our TCOs
+	// plus room for release and effect tails
+	tick_t freezeLength() const;
+
+	// called by FreezeRenderer around rendering the song - the track is
+	// frozen afterwards if everything has been captured
+	void startFreezing();
+	bool finishFreezing();
+
+	// store the frozen render next to the given project file unless it
+	// has been stored there already
+	bool writeFreezeCache( const QString & projectFile ) const;
+
 
 signals:
 	void instrumentChanged();
@@ -231,6 +253,9 @@ protected slots:
 	void updatePitch();
 	void updatePitchRange();
 	void updateEffectChannel();
+	void updateFrozen();
+	void invalidateFreezeCache();
+	void connectFreezeSources();
 
 
 private:
@@ -270,6 +295,15 @@ private:
 
 	Piano m_piano;
 
+	bool loadFreezeCache();
+	void setFreezeCache( FreezeCache * cache );
+
+	BoolModel m_frozenModel;
+	FreezeCache * m_freezeCache;
+	// name of the file the frozen render is stored in, a new one for
+	// every freeze so saved projects keep the render they refer to
+	QString m_freezeFile;
+
 
 	friend class InstrumentTrackView;
 	friend class InstrumentTrackWindow;
@@ -333,6 +367,8 @@ private slots:
 	void assignFxLine( int channelIndex );
 	void createFxLine();
 
+	void toggleFrozen( bool frozen );
+
 
 private:
 	InstrumentTrackWindow * m_window;
@@ -35,8 +35,16 @@ public:
 	LocklessAllocator( size_t nmemb, size_t size );
 	virtual ~LocklessAllocator();
 	void * alloc();
+	//! like alloc(), but doesn't complain if there's no free space, for
+	//! callers that fall back to another allocator
+	void * tryAlloc();
 	void free( void * ptr );
 
+	bool contains( const void * ptr ) const
+	{
+		return ptr >= m_pool && ptr < m_pool + m_capacity * m_elementSize;
+	}
+
 
 private:
 	char * m_pool;
@@ -43,6 +43,10 @@ public:
 
 	static void * alloc( size_t size );
 	static void free( void * ptr );
+
+	// number of allocations made so far, used to check that the
+	// mixer doesn't allocate while rendering
+	static int allocationCount();
 };
 
 template<typename T>
@@ -25,6 +25,7 @@
 #ifndef MIXER_H
 #define MIXER_H
 
+#include <QtCore/QList>
 #include <QtCore/QMutex>
 #include <QtCore/QThread>
 #include <QtCore/QVector>
@@ -32,11 +33,13 @@
 #include <samplerate.h>
 
 
+#include "AtomicInt.h"
 #include "lmms_basics.h"
 #include "LocklessList.h"
 #include "Note.h"
 #include "fifo_buffer.h"
 #include "MixerProfiler.h"
+#include "TripleBuffer.h"
 
 
 class AudioDevice;
@@ -153,6 +156,44 @@ public:
 		}
 	} ;
 
+	// how the audio threads are set up, see setupThread()
+	struct threadSettings
+	{
+		// number of worker threads besides the thread that renders the
+		// buffers, -1 for one less than there are CPUs available
+		int workers;
+		// CPUs the mixer threads may run on, empty for all of them
+		QList<int> cpus;
+		// try to run the audio threads with SCHED_FIFO
+		bool realtime;
+		// SCHED_FIFO priority, 0 for the middle of the allowed range
+		int priority;
+
+		threadSettings() :
+			workers( -1 ),
+			cpus(),
+			realtime( true ),
+			priority( 0 )
+		{
+		}
+
+		// read from the "mixer" section of the configuration
+		void loadFromConfig();
+
+		// parses a list of CPUs like "0-3,6", returns false if it's
+		// malformed
+		static bool parseCpuList( const QString & list,
+							QList<int> & cpus );
+	} ;
+
+	// has to be called before the mixer is created
+	static void setThreadSettings( const threadSettings & settings );
+
+	// pins the calling thread to the configured CPUs unless pinToCpus is
+	// false and gives it realtime priority if enabled - failures are
+	// reported once and otherwise ignored, e.g. when lacking the privileges
+	static void setupThread( bool pinToCpus = true );
+
 	void initDevices();
 	void clear();
 	void clearNewPlayHandles();
@@ -273,7 +314,7 @@ public:
 	}
 
 
-	void getPeakValues( sampleFrame * _ab, const f_cnt_t _frames, float & peakLeft, float & peakRight ) const;
+	void getPeakValues( const sampleFrame * _ab, const f_cnt_t _frames, float & peakLeft, float & peakRight ) const;
 
 
 	bool criticalXRuns() const;
@@ -300,6 +341,14 @@ public:
 		return hasFifoWriter() ? m_fifo->read() : renderNextBuffer();
 	}
 
+	// copy of the most recent period of master output, stays valid until
+	// the next call - only to be polled from a single GUI widget
+	inline const surroundSampleFrame * outputSnapshot()
+	{
+		m_outputSnapshot.update();
+		return m_outputSnapshot.readBuffer();
+	}
+
 	void changeQuality( const struct qualitySettings & _qs );
 
 	inline bool isMetronomeActive() const { return m_metronomeActive; }
@@ -308,11 +357,20 @@ public:
 	void requestChangeInModel();
 	void doneChangeInModel();
 
+	// hand over data the audio thread might still be reading after a
+	// new version has been published - _free( _data ) is called on the
+	// GUI thread once the period being rendered right now is complete,
+	// so publishing never has to wait for the mixer
+	void retire( void * _data, void (* _free)( void * ) );
+
 
 signals:
 	void qualitySettingsChanged();
 	void sampleRateChanged();
-	void nextAudioBuffer( const surroundSampleFrame * buffer );
+
+
+private slots:
+	void freeRetired();
 
 
 private:
@@ -375,6 +433,9 @@ private:
 	int m_writeBuffer;
 	int m_poolDepth;
 
+	// master output handed over to the GUI for visualization
+	TripleBuffer<surroundSampleFrame *> m_outputSnapshot;
+
 	// worker thread stuff
 	QVector<MixerWorkerThread *> m_workers;
 	int m_numWorkers;
@@ -411,6 +472,18 @@ private:
 
 	bool m_clearSignal;
 
+	// data waiting for the mixer to finish the periods that might read
+	// it, tagged with m_periodsRendered at the time it was retired
+	struct RetiredData
+	{
+		void * data;
+		void (* free)( void * );
+		int period;
+	} ;
+	QList<RetiredData> m_retired;
+	QMutex m_retiredMutex;
+	AtomicInt m_periodsRendered;
+
 	bool m_changesSignal;
 	unsigned int m_changes;
 	QMutex m_changesMutex;
@@ -27,6 +27,7 @@
 
 #include <QFile>
 
+#include "MemoryManager.h"
 #include "MicroTimer.h"
 
 class MixerProfiler
@@ -38,6 +39,7 @@ public:
 	void startPeriod()
 	{
 		m_periodTimer.reset();
+		m_periodAllocations = MemoryManager::allocationCount();
 	}
 
 	void finishPeriod( sample_rate_t sampleRate, fpp_t framesPerPeriod );
@@ -47,12 +49,20 @@ public:
 		return m_cpuLoad;
 	}
 
+	// allocations through MemoryManager during the last period
+	int allocations() const
+	{
+		return m_allocations;
+	}
+
 	void setOutputFile( const QString& outputFile );
 
 
 private:
 	MicroTimer m_periodTimer;
 	int m_cpuLoad;
+	int m_periodAllocations;
+	int m_allocations;
 	QFile m_outputFile;
 
 };
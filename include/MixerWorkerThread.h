@@ -29,11 +29,13 @@
 #include <QtCore/QAtomicPointer>
 #include <QtCore/QThread>
 
+#include "export.h"
+
 class QWaitCondition;
 class Mixer;
 class ThreadableJob;
 
-class MixerWorkerThread : public QThread
+class EXPORT MixerWorkerThread : public QThread
 {
 public:
 	// internal representation of the job queue - all functions are thread-safe
@@ -57,6 +59,9 @@ public:
 		void reset( OperationMode _opMode );
 
 		void addJob( ThreadableJob * _job );
+		// queues all of the given jobs or, if there's not enough room
+		// left, none of them
+		bool addJobs( ThreadableJob * * _jobs, int _count );
 
 		void run();
 		void wait();
@@ -102,6 +107,11 @@ public:
 
 	static void startAndWaitForJobs();
 
+	// lets the worker threads help with processing the given jobs and
+	// returns once all of them are done - can be called from within a job
+	// that is being processed in order to split it up any further
+	static void processJobs( ThreadableJob * * _jobs, int _count );
+
 
 private:
 	virtual void run();
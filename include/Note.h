@@ -207,6 +207,8 @@ public:
 
 	static MidiTime quantized( const MidiTime & m, const int qGrid );
 
+	// NULL unless the note has been detuned or opened in the piano roll's
+	// detuning mode
 	DetuningHelper * detuning() const
 	{
 		return m_detuning;
@@ -214,6 +216,8 @@ public:
 	bool hasDetuningInfo() const;
 	bool withinRange(int tickStart, int tickEnd) const;
 
+	// creates detuning information on demand - almost no notes are
+	// detuned, so don't create it up front
 	void createDetuning();
 
 
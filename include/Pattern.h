@@ -67,12 +67,15 @@ public:
 
 	// note management
 	Note * addNote( const Note & _new_note, const bool _quant_pos = true );
+	// adds many notes at once, sorting them in and updating length and
+	// type only once - used by importers
+	void addNotes( const QVector<Note> & _new_notes,
+						const bool _quant_pos = true );
 
 	void removeNote( Note * _note_to_del );
 
 	Note * noteAtStep( int _step );
 
-	void rearrangeAllNotes();
 	void clearNotes();
 
 	inline const NoteVector & notes() const
@@ -80,6 +83,33 @@ public:
 		return m_notes;
 	}
 
+	// playback data of notes() packed into one array per property, in
+	// the same order - editing state like the selection stays with the
+	// Note objects, which are the handles the GUI edits notes through
+	struct NoteData
+	{
+		QVector<tick_t> positions;
+		QVector<tick_t> lengths;
+		QVector<int> keys;
+		QVector<volume_t> volumes;
+		QVector<panning_t> pannings;
+	} ;
+
+	inline const NoteData & noteData() const
+	{
+		return m_noteData;
+	}
+
+	// index of the first note starting at or after _pos, notes().size()
+	// if there's none - only touches noteData(), so skipping ahead in
+	// large patterns stays cheap
+	int firstNoteAt( const MidiTime & _pos ) const;
+
+	// range [_first, _last) of notes() containing all notes which overlap
+	// the ticks from _start to _end
+	void notesInRange( const MidiTime & _start, const MidiTime & _end,
+						int & _first, int & _last ) const;
+
 	Note * addStepNote( int step );
 	void setStep( int step, bool enabled );
 
@@ -116,6 +146,13 @@ public:
 	using Model::dataChanged;
 
 
+public slots:
+	// has to be called whenever notes have been edited in place - sorts
+	// them by position again and updates noteData(); done on
+	// dataChanged() as well
+	void rearrangeAllNotes();
+
+
 protected:
 	void updateBBTrack();
 
@@ -136,12 +173,18 @@ private:
 
 	void resizeToFirstTrack();
 
+	// has to be called with the instrument track locked whenever
+	// m_notes changed
+	void updateNoteData();
+
 	InstrumentTrack * m_instrumentTrack;
 
 	PatternTypes m_patternType;
 
 	// data-stuff
 	NoteVector m_notes;
+	NoteData m_noteData;
+	tick_t m_maxNoteLength;
 	int m_steps;
 
 	Pattern * adjacentPatternByOffset(int offset) const;
@@ -28,6 +28,7 @@
 #define PIANO_ROLL_H
 
 #include <QVector>
+#include <QPixmap>
 #include <QWidget>
 #include <QInputDialog>
 
@@ -365,10 +366,20 @@ private:
 
 	void copyToClipboard(const NoteVector & notes ) const;
 
+	void drawGrid( QPainter & _p );
 	void drawDetuningInfo( QPainter & _p, const Note * _n, int _x, int _y ) const;
 	bool mouseOverNote();
 	Note * noteUnderMouse();
 
+	// range [first, last) of the pattern's notes which may overlap the
+	// ticks from startTick to endTick
+	void notesInRange( int startTick, int endTick, int & first, int & last ) const;
+
+	// the grid only changes when scrolling, zooming or resizing, so it is
+	// rendered once and reused as long as m_gridCacheParams match
+	QPixmap m_gridCache;
+	QVector<int> m_gridCacheParams;
+
 	// turn a selection rectangle into selected notes
 	void computeSelectedNotes( bool shift );
 	void clearSelectedNotes();
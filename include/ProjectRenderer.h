@@ -70,6 +70,20 @@ public:
 
 	static QString getFileExtensionFromFormat( ExportFileFormats fmt );
 
+	// parsers for the values of the render options of the command line,
+	// shared with the job lists of --batch - they return false and leave
+	// the settings untouched if the value isn't valid
+	static bool parseFileFormat( const QString & value,
+						ExportFileFormats & format );
+	static bool parseSampleRate( const QString & value,
+					OutputSettings & outputSettings );
+	static bool parseBitRate( const QString & value,
+					OutputSettings & outputSettings );
+	static bool parseInterpolation( const QString & value,
+				Mixer::qualitySettings & qualitySettings );
+	static bool parseOversampling( const QString & value,
+				Mixer::qualitySettings & qualitySettings );
+
 	static const FileEncodeDevice fileEncodeDevices[];
 
 public slots:
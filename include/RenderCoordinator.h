@@ -0,0 +1,92 @@
+/*
+ * RenderCoordinator.h - distributes a command line render over several lmms
+ *                       processes
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#ifndef RENDER_COORDINATOR_H
+#define RENDER_COORDINATOR_H
+
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QProcess>
+#include <QtCore/QStringList>
+#include <QtCore/QVector>
+
+
+/*! \brief Runs a --rendertracks or --batch render in several processes.
+ *
+ *  Every worker is started as "lmms <arguments> --worker <i>/<n>" and
+ *  renders every n-th track or job starting at i, writing its files
+ *  directly to the output location. As each worker has its own engine,
+ *  tracks and projects are rendered in parallel even though the engine
+ *  itself is a singleton. The coordinator doesn't load anything itself.
+ */
+class RenderCoordinator : public QObject
+{
+	Q_OBJECT
+public:
+	RenderCoordinator( const QStringList & arguments, int workers );
+	virtual ~RenderCoordinator();
+
+	//! data written to the standard input of every worker, e.g. a job list
+	//! that was passed on our own standard input
+	void setInput( const QByteArray & input )
+	{
+		m_input = input;
+	}
+
+	//! lets every worker dump its profiling information to
+	//! "<file>.<i>" instead of all of them writing to the same file
+	void setProfilerOutputFile( const QString & file )
+	{
+		m_profilerOutputFile = file;
+	}
+
+	void start();
+
+	int failedWorkers() const
+	{
+		return m_failedWorkers;
+	}
+
+
+signals:
+	void finished();
+
+
+private slots:
+	void workerFinished( int exitCode, QProcess::ExitStatus exitStatus );
+
+
+private:
+	const QStringList m_arguments;
+	QByteArray m_input;
+	QString m_profilerOutputFile;
+
+	QVector<QProcess *> m_workers;
+	int m_runningWorkers;
+	int m_failedWorkers;
+
+	QElapsedTimer m_timer;
+
+} ;
+
+
+#endif
@@ -50,6 +50,10 @@ public:
 	/// Export all unmuted tracks into individual file
 	void renderTracks();
 
+	/// Only render every workers-th track starting at worker in
+	/// renderTracks(), used when rendering in several processes
+	void setWorker( int worker, int workers );
+
 	void abortProcessing();
 
 signals:
@@ -74,6 +78,10 @@ private:
 
 	QVector<Track*> m_tracksToRender;
 	QVector<Track*> m_unmuted;
+	int m_numTracksToRender;
+
+	int m_worker;
+	int m_workers;
 } ;
 
 #endif
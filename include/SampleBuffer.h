@@ -26,11 +26,14 @@
 #ifndef SAMPLE_BUFFER_H
 #define SAMPLE_BUFFER_H
 
+#include <QtCore/QAtomicPointer>
 #include <QtCore/QReadWriteLock>
 #include <QtCore/QObject>
+#include <QtCore/QVector>
 
 #include <samplerate.h>
 
+#include "AtomicInt.h"
 #include "export.h"
 #include "interpolation.h"
 #include "lmms_basics.h"
@@ -226,12 +229,14 @@ public:
 	void normalizeSampleRate( const sample_rate_t _src_sr,
 						bool _keep_settings = false );
 
-	// protect calls from the GUI to this function with dataReadLock() and
-	// dataUnlock(), out of loops for efficiency
+	// reads the data published for the audio thread, so it doesn't need
+	// locking there - protect calls from the GUI to this function with
+	// dataReadLock() and dataUnlock(), out of loops for efficiency
 	inline sample_t userWaveSample( const float _sample ) const
 	{
-		f_cnt_t frames = m_frames;
-		sampleFrame * data = m_data;
+		const PlayData * playData = m_playData.loadAcquire();
+		const f_cnt_t frames = playData->frames;
+		const sampleFrame * data = playData->data;
 		const float frame = _sample * frames;
 		f_cnt_t f1 = static_cast<f_cnt_t>( frame ) % frames;
 		if( f1 < 0 )
@@ -254,6 +259,11 @@ public:
 	static QString tryToMakeRelative( const QString & _file );
 	static QString tryToMakeAbsolute(const QString & file);
 
+	//! keep decoded audio files around after their buffers are gone so
+	//! that the next buffer loading the same file doesn't have to decode
+	//! it again - used when rendering many projects in one process
+	static void setDecodeCacheEnabled( bool enabled );
+
 
 public slots:
 	void setAudioFile( const QString & _audio_file );
@@ -266,6 +276,21 @@ public slots:
 
 private:
 	void update( bool _keep_settings = false );
+	//! decodes m_audioFile or copies m_origData into m_data - returns
+	//! false if the file exceeds our size limits
+	bool loadData( bool _keep_settings );
+
+	//! (re)builds min/max peak pyramid used by visualize() - in the
+	//! background for anything but short samples
+	void updatePeaks();
+	void stopPeakBuilder();
+
+	//! look up m_audioFile in the decode cache - on success m_data and
+	//! m_frames are set and _sample_rate is the rate of the cached data
+	bool loadFromDecodeCache( const QString & _file,
+						sample_rate_t & _sample_rate );
+	void addToDecodeCache( const QString & _file,
+						sample_rate_t _sample_rate );
 
 	void convertIntToFloat ( int_sample_t * & _ibuf, f_cnt_t _frames, int _channels);
 	void directFloatWrite ( sample_t * & _fbuf, f_cnt_t _frames, int _channels);
@@ -282,10 +307,23 @@ private:
 						ch_cnt_t & _channels,
 						sample_rate_t & _sample_rate );
 
+	// the decoded data as seen by the audio thread - update() publishes a
+	// new one instead of changing it and retires the old one through the
+	// mixer, so playing never has to wait for a sample being loaded
+	struct PlayData
+	{
+		sampleFrame * data;
+		f_cnt_t frames;
+	} ;
+
+	void publishPlayData();
+	static void freePlayData( void * _playData );
+
 	QString m_audioFile;
 	sampleFrame * m_origData;
 	f_cnt_t m_origFrames;
 	sampleFrame * m_data;
+	QAtomicPointer<PlayData> m_playData;
 	QReadWriteLock m_varLock;
 	f_cnt_t m_frames;
 	f_cnt_t m_startFrame;
@@ -297,7 +335,29 @@ private:
 	float m_frequency;
 	sample_rate_t m_sampleRate;
 
-	sampleFrame * getSampleFragment( f_cnt_t _index, f_cnt_t _frames,
+	// minimum and maximum sample values of a range of frames
+	struct Peak
+	{
+		sampleFrame min;
+		sampleFrame max;
+	} ;
+	typedef QVector<Peak> PeakLevel;
+
+	// level n holds one peak per PEAK_BASE_FRAMES * PEAK_LEVEL_FACTOR^n
+	// frames of m_data, so drawing cost depends on the width to draw
+	// rather than on the length of the sample - guarded by m_varLock
+	QVector<PeakLevel> m_peaks;
+
+	class PeakBuilder;
+	PeakBuilder * m_peakBuilder;
+
+	//! returns false if _abort was set before the peaks were complete
+	static bool buildPeaks( const sampleFrame * _data, f_cnt_t _frames,
+					QVector<PeakLevel> & _peaks,
+					const AtomicInt * _abort );
+
+	sampleFrame * getSampleFragment( sampleFrame * _data,
+						f_cnt_t _index, f_cnt_t _frames,
 						LoopMode _loopmode,
 						sampleFrame * * _tmp,
 						bool * _backwards, f_cnt_t _loopstart, f_cnt_t _loopend,
@@ -308,6 +368,8 @@ private:
 
 signals:
 	void sampleUpdated();
+	//! emitted from a background thread once new peaks are available
+	void peaksUpdated();
 
 } ;
 
@@ -0,0 +1,55 @@
+/*
+ * ScratchArena.h - per-thread memory for temporary buffers of the mixer
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#ifndef SCRATCH_ARENA_H
+#define SCRATCH_ARENA_H
+
+#include <cstddef>
+
+#include "export.h"
+
+
+/*! \brief Bump allocator for short-lived buffers, one arena per thread.
+ *
+ *  Memory from alloc() stays valid until the mixer finishes the stage it
+ *  was allocated in - the mixer's threads call reset() at the end of every
+ *  stage of Mixer::renderNextBuffer(). Freeing the most recent allocation
+ *  gives its memory back right away, so code that allocates and frees in
+ *  turn doesn't use up the arena. Memory has to be freed by the thread that
+ *  allocated it. When the arena of a thread is exhausted, alloc() falls back
+ *  to MemoryManager.
+ */
+class EXPORT ScratchArena
+{
+public:
+	static void * alloc( size_t size );
+	static void free( void * ptr );
+
+	// drop everything allocated by the calling thread
+	static void reset();
+} ;
+
+
+#define SCRATCH_ALLOC( type, count ) reinterpret_cast<type*>( ScratchArena::alloc( sizeof( type ) * count ) )
+#define SCRATCH_FREE( ptr ) ScratchArena::free( ptr )
+
+#endif
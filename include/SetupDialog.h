@@ -87,6 +87,9 @@ private slots:
 	void setAutoSaveInterval( int time );
 	void resetAutoSave();
 	void displaySaveIntervalHelp();
+	void setPolyphony( int _value );
+	void resetPolyphony();
+	void displayPolyphonyHelp();
 
 	// audio settings widget
 	void audioInterfaceChanged( const QString & _driver );
@@ -117,7 +120,6 @@ private slots:
 
 	void toggleSmoothScroll( bool _enabled );
 	void toggleAutoSave( bool _enabled );
-	void toggleRunningAutoSave( bool _enabled );
 	void toggleOneInstrumentTrackWindow( bool _enabled );
 	void toggleCompactTrackButtons( bool _enabled );
 	void toggleSyncVSTPlugins( bool _enabled );
@@ -177,12 +179,14 @@ private:
 
 	bool m_smoothScroll;
 	bool m_enableAutoSave;
-	bool m_enableRunningAutoSave;
 	int m_saveInterval;
 	QSlider * m_saveIntervalSlider;
 	QLabel * m_saveIntervalLbl;
 	LedCheckBox * m_autoSave;
-	LedCheckBox * m_runningAutoSave;
+
+	int m_polyphony;
+	QSlider * m_polyphonySlider;
+	QLabel * m_polyphonyLbl;
 
 	bool m_oneInstrumentTrackWindow;
 	bool m_compactTrackButtons;
@@ -218,7 +218,9 @@ public:
 	void loadProject( const QString & filename );
 	bool guiSaveProject();
 	bool guiSaveProjectAs( const QString & filename );
-	bool saveProjectFile( const QString & filename );
+	// in the background the file is written by another thread once the
+	// project has been serialized
+	bool saveProjectFile( const QString & filename, bool inBackground = false );
 
 	const QString & projectFileName() const
 	{
@@ -271,6 +273,11 @@ public:
 		return m_timeSigModel;
 	}
 
+	IntModel & getTempoModel()
+	{
+		return m_tempoModel;
+	}
+
 
 public slots:
 	void playSong();
@@ -235,6 +235,7 @@ public slots:
 	void cut();
 	void remove();
 	virtual void update();
+	void updateLength();
 
 protected:
 	virtual void constructContextMenu( QMenu * )
@@ -265,7 +266,6 @@ protected:
 
 
 protected slots:
-	void updateLength();
 	void updatePosition();
 
 
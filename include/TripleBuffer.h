@@ -0,0 +1,107 @@
+/*
+ * TripleBuffer.h - lock-free hand-over of data from the audio threads to
+ *                  the GUI
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#ifndef TRIPLE_BUFFER_H
+#define TRIPLE_BUFFER_H
+
+#include "AtomicInt.h"
+
+
+/*! \brief Three instances of T shared by exactly one writer and one reader.
+ *
+ *  The writer fills writeBuffer() and calls publish() to swap it with the
+ *  shared slot, the reader calls update() whenever it wants to look at the
+ *  latest data and then reads readBuffer(). Neither side ever waits for the
+ *  other: the writer can publish as often as it likes and the reader only
+ *  gets to see the most recent publication. Each buffer is owned by one side
+ *  at a time, so T is never accessed concurrently.
+ */
+template<typename T>
+class TripleBuffer
+{
+public:
+	TripleBuffer() :
+		m_write( 0 ),
+		m_shared( 1 ),
+		m_read( 2 )
+	{
+	}
+
+	// direct access for setting up or tearing down the buffers while
+	// neither the writer nor the reader is active
+	T & at( int i )
+	{
+		return m_buffers[i];
+	}
+
+	T & writeBuffer()
+	{
+		return m_buffers[m_write];
+	}
+
+	void publish()
+	{
+		m_write = m_shared.fetchAndStoreOrdered( m_write | Fresh ) &
+								IndexMask;
+	}
+
+	// true if the reader picked up what was published last
+	bool isConsumed() const
+	{
+		return ( m_shared.loadAcquire() & Fresh ) == 0;
+	}
+
+	// makes the latest publication available through readBuffer(),
+	// returns false if there's nothing new since the last call
+	bool update()
+	{
+		if( isConsumed() )
+		{
+			return false;
+		}
+		m_read = m_shared.fetchAndStoreOrdered( m_read ) & IndexMask;
+		return true;
+	}
+
+	const T & readBuffer() const
+	{
+		return m_buffers[m_read];
+	}
+
+
+private:
+	enum
+	{
+		IndexMask = 3,
+		Fresh = 4
+	} ;
+
+	T m_buffers[3];
+	int m_write;
+	AtomicInt m_shared;
+	int m_read;
+
+} ;
+
+
+#endif
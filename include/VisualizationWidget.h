@@ -53,15 +53,10 @@ protected:
 	virtual void mousePressEvent( QMouseEvent * _me );
 
 
-protected slots:
-	void updateAudioBuffer( const surroundSampleFrame * buffer );
-
-
 private:
 	QPixmap s_background;
 	QPointF * m_points;
 
-	sampleFrame * m_buffer;
 	bool m_active;
 
 } ;
@@ -0,0 +1,137 @@
+/*
+ * VoicePool.h - preallocated per-note engines for instrument plugins
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#ifndef VOICE_POOL_H
+#define VOICE_POOL_H
+
+#include "AtomicInt.h"
+#include "ConfigManager.h"
+
+
+//! Number of voices kept ready per instrument, set by the "polyphony" key
+//! in the "mixer" section of the configuration (see "Performance settings"
+//! in the setup dialog). Changes apply to instruments created afterwards.
+class VoicePoolBase
+{
+public:
+	enum
+	{
+		DefaultPolyphony = 8,
+		MaxPolyphony = 64
+	} ;
+
+	static int polyphony()
+	{
+		bool ok;
+		const int voices = ConfigManager::inst()->value( "mixer",
+						"polyphony" ).toInt( &ok );
+		return ok && voices > 0 ? qMin<int>( voices, MaxPolyphony ) :
+							DefaultPolyphony;
+	}
+
+} ;
+
+
+
+
+/*! \brief Fixed set of per-note engines that are recycled instead of being
+ *  allocated in Instrument::playNote() and freed in
+ *  Instrument::deleteNotePluginData().
+ *
+ *  All voices are default-constructed when the pool is created, i.e. on the
+ *  GUI thread along with the instrument, which should then prepare() them
+ *  so that nothing is allocated when a voice is used for the first time.
+ *  The pool holds polyphony() voices by default. acquire() and release()
+ *  neither allocate nor lock as long as no more than size() voices are in
+ *  use at a time, so they can be called from any of the mixer's threads. A voice
+ *  keeps whatever state it had when it was released - the instrument is
+ *  responsible for resetting it after acquiring it, ideally reusing buffers
+ *  it already owns. Once the pool is exhausted, acquire() falls back to
+ *  creating voices on the heap which release() then deletes again.
+ */
+template<typename T>
+class VoicePool : public VoicePoolBase
+{
+public:
+	VoicePool( int size = polyphony() ) :
+		m_size( size ),
+		m_voices( new T[size] ),
+		m_used( new AtomicInt[size] )
+	{
+	}
+
+	~VoicePool()
+	{
+		delete[] m_voices;
+		delete[] m_used;
+	}
+
+	T * acquire()
+	{
+		for( int i = 0; i < m_size; ++i )
+		{
+			if( m_used[i].loadAcquire() == 0 &&
+				m_used[i].testAndSetAcquire( 0, 1 ) )
+			{
+				return &m_voices[i];
+			}
+		}
+		return new T;
+	}
+
+	void release( T * voice )
+	{
+		if( voice >= m_voices && voice < m_voices + m_size )
+		{
+			m_used[voice - m_voices].storeRelease( 0 );
+		}
+		else
+		{
+			delete voice;
+		}
+	}
+
+	int size() const
+	{
+		return m_size;
+	}
+
+	//! calls setup( T & ) for every voice, e.g. for allocating buffers up
+	//! front - only call while no voice is in use
+	template<typename Setup>
+	void prepare( Setup setup )
+	{
+		for( int i = 0; i < m_size; ++i )
+		{
+			setup( m_voices[i] );
+		}
+	}
+
+private:
+	const int m_size;
+	T * m_voices;
+	AtomicInt * m_used;
+
+} ;
+
+
+#endif
@@ -81,4 +81,21 @@ int EXPORT calc13octaveband31( float * _absspec_buffer, float * _subbands,
  */
 float EXPORT signalpower(float *timesignal, int num_values);
 
+/* returns a process-wide real-to-complex plan for transforms of _size
+ * samples. Plans are created once (FFTW_MEASURE, speeded up by wisdom
+ * stored on disk) and shared by all callers, which have to execute them
+ * using fftwf_execute_dft_r2c() on buffers allocated with fftwf_malloc().
+ *
+ *    returns NULL on error
+ */
+fftwf_plan EXPORT sharedFftPlanR2C( int _size );
+
+/* same for complex-to-real (inverse) transforms of _size samples, to be
+ * executed using fftwf_execute_dft_c2r() - note that these overwrite their
+ * input buffer
+ *
+ *    returns NULL on error
+ */
+fftwf_plan EXPORT sharedFftPlanC2R( int _size );
+
 #endif
@@ -193,6 +193,23 @@ static inline double fastPow( double a, double b )
 	return u.d;
 }
 
+// 2^x, accurate to about 4e-6 relative error - the integer part goes straight
+// into the exponent bits, the fraction (within -0.5..0.5) is approximated by a
+// polynomial; x has to be within -126..127
+static inline float fastExp2f( float x )
+{
+	const float i = floorf( x + 0.5f );
+	const float f = x - i;
+	union
+	{
+		float f;
+		int32_t i;
+	} u;
+	u.i = ( static_cast<int32_t>( i ) + 127 ) << 23;
+	return u.f * ( 1.0f + f * ( 0.693147181f + f * ( 0.240226507f +
+			f * ( 0.0555041087f + f * ( 0.00961812911f + f * 0.00133335581f ) ) ) ) );
+}
+
 // sinc function
 static inline double sinc( double _x )
 {
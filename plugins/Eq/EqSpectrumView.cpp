@@ -29,14 +29,16 @@
 #include "Mixer.h"
 
 EqAnalyser::EqAnalyser() :
-	m_framesFilledUp ( 0 ),
+	FftAnalysisService::Client( FFT_BUFFER_SIZE ),
 	m_energy ( 0 ),
 	m_sampleRate ( 1 ),
 	m_active ( true )
 {
 	m_inProgress=false;
+	m_buffer = ( float * ) fftwf_malloc( FFT_BUFFER_SIZE * 2 * sizeof( float ) );
+	memset( m_buffer, 0, FFT_BUFFER_SIZE * 2 * sizeof( float ) );
 	m_specBuf = ( fftwf_complex * ) fftwf_malloc( ( FFT_BUFFER_SIZE + 1 ) * sizeof( fftwf_complex ) );
-	m_fftPlan = fftwf_plan_dft_r2c_1d( FFT_BUFFER_SIZE*2, m_buffer, m_specBuf, FFTW_MEASURE );
+	m_fftPlan = sharedFftPlanR2C( FFT_BUFFER_SIZE*2 );
 
 	//initialize Blackman-Harris window, constants taken from
 	//https://en.wikipedia.org/wiki/Window_function#A_list_of_window_functions
@@ -52,6 +54,8 @@ EqAnalyser::EqAnalyser() :
 									  - a3 * cos( 6 * F_PI * i / (float)FFT_BUFFER_SIZE - 1.0 ));
 	}
 	clear();
+
+	FftAnalysisService::addClient( this );
 }
 
 
@@ -59,8 +63,10 @@ EqAnalyser::EqAnalyser() :
 
 EqAnalyser::~EqAnalyser()
 {
-	fftwf_destroy_plan( m_fftPlan );
+	FftAnalysisService::removeClient( this );
+
 	fftwf_free( m_specBuf );
+	fftwf_free( m_buffer );
 }
 
 
@@ -68,54 +74,47 @@ EqAnalyser::~EqAnalyser()
 
 void EqAnalyser::analyze( sampleFrame *buf, const fpp_t frames )
 {
-	//only analyse if the view is visible
+	//only analyse if the view is visible - the FFT itself is done
+	//in analyzeWindow() on the analysis thread
 	if ( m_active )
 	{
-		m_inProgress=true;
-		const int FFT_BUFFER_SIZE = 2048;
-		fpp_t f = 0;
-		if( frames > FFT_BUFFER_SIZE )
-		{
-			m_framesFilledUp = 0;
-			f = frames - FFT_BUFFER_SIZE;
-		}
-		// meger channels
-		for( ; f < frames; ++f )
-		{
-			m_buffer[m_framesFilledUp] =
-					( buf[f][0] + buf[f][1] ) * 0.5;
-			++m_framesFilledUp;
-		}
+		pushFrames( buf, frames );
+	}
+}
 
-		if( m_framesFilledUp < FFT_BUFFER_SIZE )
-		{
-			m_inProgress = false;
-			return;
-		}
 
-		m_sampleRate = Engine::mixer()->processingSampleRate();
-		const int LOWEST_FREQ = 0;
-		const int HIGHEST_FREQ = m_sampleRate / 2;
 
-		//apply FFT window
-		for( int i = 0; i < FFT_BUFFER_SIZE; i++ )
-		{
-			m_buffer[i] = m_buffer[i] * m_fftWindow[i];
-		}
 
-		fftwf_execute( m_fftPlan );
-		absspec( m_specBuf, m_absSpecBuf, FFT_BUFFER_SIZE+1 );
+void EqAnalyser::analyzeWindow( const sampleFrame * window, int frames )
+{
+	if( m_fftPlan == NULL )
+	{
+		return;
+	}
 
-		compressbands( m_absSpecBuf, m_bands, FFT_BUFFER_SIZE+1,
-					   MAX_BANDS,
-					   ( int )( LOWEST_FREQ * ( FFT_BUFFER_SIZE + 1 ) / ( float )( m_sampleRate / 2 ) ),
-					   ( int )( HIGHEST_FREQ * ( FFT_BUFFER_SIZE +  1) / ( float )( m_sampleRate / 2 ) ) );
-		m_energy = maximum( m_bands, MAX_BANDS ) / maximum( m_buffer, FFT_BUFFER_SIZE );
+	m_inProgress=true;
 
-		m_framesFilledUp = 0;
-		m_inProgress = false;
-		m_active = false;
+	// merge channels and apply FFT window
+	for( int f = 0; f < frames; ++f )
+	{
+		m_buffer[f] = ( window[f][0] + window[f][1] ) * 0.5 * m_fftWindow[f];
 	}
+
+	m_sampleRate = Engine::mixer()->processingSampleRate();
+	const int LOWEST_FREQ = 0;
+	const int HIGHEST_FREQ = m_sampleRate / 2;
+
+	fftwf_execute_dft_r2c( m_fftPlan, m_buffer, m_specBuf );
+	absspec( m_specBuf, m_absSpecBuf, FFT_BUFFER_SIZE+1 );
+
+	compressbands( m_absSpecBuf, m_bands, FFT_BUFFER_SIZE+1,
+				   MAX_BANDS,
+				   ( int )( LOWEST_FREQ * ( FFT_BUFFER_SIZE + 1 ) / ( float )( m_sampleRate / 2 ) ),
+				   ( int )( HIGHEST_FREQ * ( FFT_BUFFER_SIZE +  1) / ( float )( m_sampleRate / 2 ) ) );
+	m_energy = maximum( m_bands, MAX_BANDS ) / maximum( m_buffer, FFT_BUFFER_SIZE );
+
+	m_inProgress = false;
+	m_active = false;
 }
 
 
@@ -163,9 +162,7 @@ bool EqAnalyser::getInProgress()
 
 void EqAnalyser::clear()
 {
-	m_framesFilledUp = 0;
 	m_energy = 0;
-	memset( m_buffer, 0, sizeof( m_buffer ) );
 	memset( m_bands, 0, sizeof( m_bands ) );
 }
 
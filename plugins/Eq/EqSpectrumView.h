@@ -26,13 +26,14 @@
 #include <QPainter>
 #include <QWidget>
 
+#include "FftAnalysisService.h"
 #include "fft_helpers.h"
 #include "lmms_basics.h"
 #include "lmms_math.h"
 
 
 const int MAX_BANDS = 2048;
-class EqAnalyser
+class EqAnalyser : public FftAnalysisService::Client
 {
 public:
 	EqAnalyser();
@@ -50,12 +51,14 @@ public:
 
 	void setActive(bool active);
 
+protected:
+	virtual void analyzeWindow( const sampleFrame * window, int frames );
+
 private:
 	fftwf_plan m_fftPlan;
 	fftwf_complex * m_specBuf;
 	float m_absSpecBuf[FFT_BUFFER_SIZE+1];
-	float m_buffer[FFT_BUFFER_SIZE*2];
-	int m_framesFilledUp;
+	float * m_buffer;
 	float m_energy;
 	int m_sampleRate;
 	bool m_active;
@@ -29,6 +29,7 @@
  */
 
 
+#include <algorithm>
 #include <cstring>
 #include <QDebug>
 #include <QLayout>
@@ -46,7 +47,6 @@
 #include "SampleBuffer.h"
 #include "Song.h"
 #include "ConfigManager.h"
-#include "endian_handling.h"
 
 #include "PatchesDialog.h"
 #include "ToolTip.h"
@@ -76,6 +76,141 @@ Plugin::Descriptor PLUGIN_EXPORT gigplayer_plugin_descriptor =
 
 
 
+// How much of every sample is kept in RAM
+const int PRELOAD_MS = 250;
+
+// How long the streamer sleeps when all streams are full
+const int STREAMER_INTERVAL = 5;
+
+
+
+
+// Taken from SampleBuffer.cpp
+static inline f_cnt_t loopedIndex( f_cnt_t index, f_cnt_t startf, f_cnt_t endf )
+{
+	if( index < endf )
+	{
+		return index;
+	}
+
+	return startf + ( index - startf )
+				% ( endf - startf );
+}
+
+
+
+
+// Map the play position pos to the frame in the sample that is played there
+// and return how many positions from there on continue in the same direction,
+// or 0 past the end of a sample that isn't looped. Ping-pong loops turn around
+// on their first and last frame without playing those twice.
+static f_cnt_t loopRun( f_cnt_t pos, f_cnt_t samplesTotal, bool loop,
+		gig::loop_type_t loopType, f_cnt_t loopStart, f_cnt_t loopEnd,
+		f_cnt_t & index, bool & backward )
+{
+	backward = false;
+
+	if( !loop )
+	{
+		index = pos;
+		return pos < samplesTotal ? samplesTotal - pos : 0;
+	}
+
+	// The first pass up to the end of the loop is always played forward
+	if( pos < loopEnd )
+	{
+		index = pos;
+		return loopEnd - pos;
+	}
+
+	const f_cnt_t looplen = loopEnd - loopStart;
+
+	if( loopType == gig::loop_type_backward )
+	{
+		index = loopEnd - 1 - ( pos - loopEnd + 1 ) % looplen;
+		backward = true;
+		return index - loopStart + 1;
+	}
+
+	if( loopType != gig::loop_type_bidirectional || looplen < 2 )
+	{
+		index = loopedIndex( pos, loopStart, loopEnd );
+		return loopEnd - index;
+	}
+
+	const f_cnt_t looppos = ( pos - ( loopEnd - 1 ) ) % ( ( looplen - 1 ) * 2 );
+
+	if( looppos < looplen - 1 )
+	{
+		index = loopEnd - 1 - looppos;
+		backward = true;
+		return index - loopStart;
+	}
+
+	index = loopStart + ( looppos - ( looplen - 1 ) );
+	return loopEnd - 1 - index;
+}
+
+
+
+
+// Copy count frames ending at frame last of the sample in reverse order
+static void copyBackward( int8_t * dst, const int8_t * src, f_cnt_t last,
+				f_cnt_t count, f_cnt_t frameSize )
+{
+	for( f_cnt_t i = 0; i < count; ++i )
+	{
+		std::memcpy( dst + i * frameSize, src + ( last - i ) * frameSize,
+								frameSize );
+	}
+}
+
+
+
+
+// Reverse the order of count frames in place
+static void reverseFrames( int8_t * data, f_cnt_t count, f_cnt_t frameSize )
+{
+	for( f_cnt_t i = 0, j = count - 1; i < j; ++i, --j )
+	{
+		std::swap_ranges( data + i * frameSize, data + ( i + 1 ) * frameSize,
+							data + j * frameSize );
+	}
+}
+
+
+
+
+// Convert interleaved 24 bit samples to float. Kept free of branches and
+// double precision math so that the compiler can vectorize it. libgig gives
+// us little endian data which is taken apart byte by byte, so this works on
+// big endian systems as well.
+static void convert24Bit( const uint8_t * in, float * out, int count, float gain )
+{
+	for( int i = 0; i < count; ++i )
+	{
+		const int32_t value = (int32_t) (
+				( (uint32_t) in[3 * i] << 8 ) |
+				( (uint32_t) in[3 * i + 1] << 16 ) |
+				( (uint32_t) in[3 * i + 2] << 24 ) );
+		out[i] = value * gain;
+	}
+}
+
+
+
+
+static void convert16Bit( const int16_t * in, float * out, int count, float gain )
+{
+	for( int i = 0; i < count; ++i )
+	{
+		out[i] = in[i] * gain;
+	}
+}
+
+
+
+
 GigInstrument::GigInstrument( InstrumentTrack * _instrument_track ) :
 	Instrument( _instrument_track, &gigplayer_plugin_descriptor ),
 	m_instance( NULL ),
@@ -85,6 +220,7 @@ GigInstrument::GigInstrument( InstrumentTrack * _instrument_track ) :
 	m_patchNum( 0, 0, 127, this, tr( "Patch" ) ),
 	m_gain( 1.0f, 0.0f, 5.0f, 0.01f, this, tr( "Gain" ) ),
 	m_interpolation( SRC_LINEAR ),
+	m_streamer( GigStreamer::acquire() ),
 	m_RandomSeed( 0 ),
 	m_currentKeyDimension( 0 )
 {
@@ -107,6 +243,7 @@ GigInstrument::~GigInstrument()
 				PlayHandle::TypeNotePlayHandle
 				| PlayHandle::TypeInstrumentPlayHandle );
 	freeInstance();
+	GigStreamer::release();
 }
 
 
@@ -185,14 +322,16 @@ void GigInstrument::freeInstance()
 
 	if( m_instance != NULL )
 	{
-		delete m_instance;
-		m_instance = NULL;
-
 		// If we're changing instruments, we got to make sure that we
 		// remove all pointers to the old samples and don't try accessing
-		// that instrument again
+		// that instrument again. This also stops the streams, but the
+		// streamer might be in the middle of reading one of them.
 		m_instrument = NULL;
 		m_notes.clear();
+
+		QMutexLocker ioLock( m_streamer->ioMutex() );
+		delete m_instance;
+		m_instance = NULL;
 	}
 }
 
@@ -488,7 +627,7 @@ void GigInstrument::play( sampleFrame * _working_buffer )
 			}
 
 			// Update note position with how many samples we actually used
-			sample->pos += used;
+			sample->advance( used );
 			sample->adsr.inc( used );
 		}
 	}
@@ -516,162 +655,103 @@ void GigInstrument::loadSample( GigSample& sample, sampleFrame* sampleData, f_cn
 		return;
 	}
 
-	// Determine if we need to loop part of this sample
-	bool loop = false;
-	gig::loop_type_t loopType = gig::loop_type_normal;
-	f_cnt_t loopStart = 0;
-	f_cnt_t loopLength = 0;
+	const f_cnt_t frameSize = sample.sample->FrameSize;
+	const gig::buffer_t cache = sample.sample->GetCache();
+	const f_cnt_t cached = cache.Size / frameSize;
 
-	if( sample.region->pSampleLoops != NULL )
+	int8_t buffer[samples * frameSize];
+
+	// Take the data from the preloaded part of the sample if possible and
+	// from what the streamer has read otherwise, wrapping around in loops.
+	// We never touch the disk here.
+	f_cnt_t done = 0;
+
+	while( done < samples )
 	{
-		for( uint32_t i = 0; i < sample.region->SampleLoops; ++i )
+		const f_cnt_t pos = sample.pos + done;
+		f_cnt_t index;
+		bool backward;
+		const f_cnt_t run = loopRun( pos, sample.sample->SamplesTotal,
+				sample.loop, sample.loopType, sample.loopStart,
+				sample.loopEnd, index, backward );
+
+		if( run == 0 )
 		{
-			loop = true;
-			loopType = static_cast<gig::loop_type_t>( sample.region->pSampleLoops[i].LoopType );
-			loopStart = sample.region->pSampleLoops[i].LoopStart;
-			loopLength = sample.region->pSampleLoops[i].LoopLength;
-
-			// Currently only support at max one loop
 			break;
 		}
-	}
 
-	unsigned long allocationsize = samples * sample.sample->FrameSize;
-	int8_t buffer[allocationsize];
+		int8_t * dst = &buffer[done * frameSize];
+		f_cnt_t count = qMin( samples - done, run );
 
-	// Load the sample in different ways depending on if we're looping or not
-	if( loop == true && ( sample.pos >= loopStart || sample.pos + samples > loopStart ) )
-	{
-		// Calculate the new position based on the type of loop
-		if( loopType == gig::loop_type_bidirectional )
+		if( sample.stream != NULL && pos >= sample.stream->start() )
 		{
-			sample.pos = getPingPongIndex( sample.pos, loopStart, loopStart + loopLength );
+			count = sample.stream->read( dst, pos, count );
 		}
-		else
+		else if( index < cached )
 		{
-			sample.pos = getLoopedIndex( sample.pos, loopStart, loopStart + loopLength );
-			// TODO: also implement loop_type_backward support
-		}
-
-		sample.sample->SetPos( sample.pos );
-
-		// Load the samples (based on gig::Sample::ReadAndLoop) even around the end
-		// of a loop boundary wrapping to the beginning of the loop region
-		long samplestoread = samples;
-		long samplestoloopend = 0;
-		long readsamples = 0;
-		long totalreadsamples = 0;
-		long loopEnd = loopStart + loopLength;
-
-		do
-		{
-			samplestoloopend = loopEnd - sample.sample->GetPos();
-			readsamples = sample.sample->Read( &buffer[totalreadsamples * sample.sample->FrameSize],
-					min( samplestoread, samplestoloopend ) );
-			samplestoread -= readsamples;
-			totalreadsamples += readsamples;
-
-			if( readsamples >= samplestoloopend )
+			if( !backward )
 			{
-				sample.sample->SetPos( loopStart );
+				count = qMin( count, cached - index );
 			}
-		}
-		while( samplestoread > 0 && readsamples > 0 );
-	}
-	else
-	{
-		sample.sample->SetPos( sample.pos );
 
-		unsigned long size = sample.sample->Read( &buffer, samples ) * sample.sample->FrameSize;
-		std::memset( (int8_t*) &buffer + size, 0, allocationsize - size );
-	}
-
-	// Convert from 16 or 24 bit into 32-bit float
-	if( sample.sample->BitDepth == 24 ) // 24 bit
-	{
-		uint8_t * pInt = reinterpret_cast<uint8_t*>( &buffer );
+			if( sample.stream != NULL )
+			{
+				count = qMin( count, sample.stream->start() - pos );
+			}
 
-		for( f_cnt_t i = 0; i < samples; ++i )
-		{
-			// libgig gives 24-bit data as little endian, so we must
-			// convert if on a big endian system
-			int32_t valueLeft = swap32IfBE(
-						( pInt[ 3 * sample.sample->Channels * i ] << 8 ) |
-						( pInt[ 3 * sample.sample->Channels * i + 1 ] << 16 ) |
-						( pInt[ 3 * sample.sample->Channels * i + 2 ] << 24 ) );
-
-			// Store the notes to this buffer before saving to output
-			// so we can fade them out as needed
-			sampleData[i][0] = 1.0 / 0x100000000 * sample.attenuation * valueLeft;
-
-			if( sample.sample->Channels == 1 )
+			if( backward )
 			{
-				sampleData[i][1] = sampleData[i][0];
+				copyBackward( dst, static_cast<int8_t*>( cache.pStart ),
+							index, count, frameSize );
 			}
 			else
 			{
-				int32_t valueRight = swap32IfBE(
-							( pInt[ 3 * sample.sample->Channels * i + 3 ] << 8 ) |
-							( pInt[ 3 * sample.sample->Channels * i + 4 ] << 16 ) |
-							( pInt[ 3 * sample.sample->Channels * i + 5 ] << 24 ) );
-
-				sampleData[i][1] = 1.0 / 0x100000000 * sample.attenuation * valueRight;
+				std::memcpy( dst, static_cast<int8_t*>( cache.pStart ) +
+					index * frameSize, count * frameSize );
 			}
 		}
-	}
-	else // 16 bit
-	{
-		int16_t * pInt = reinterpret_cast<int16_t*>( &buffer );
-
-		for( f_cnt_t i = 0; i < samples; ++i )
+		else
 		{
-			sampleData[i][0] = 1.0 / 0x10000 *
-				pInt[ sample.sample->Channels * i ] * sample.attenuation;
+			// Not preloaded and no stream available
+			count = 0;
+		}
 
-			if( sample.sample->Channels == 1 )
-			{
-				sampleData[i][1] = sampleData[i][0];
-			}
-			else
-			{
-				sampleData[i][1] = 1.0 / 0x10000 *
-					pInt[ sample.sample->Channels * i + 1 ] * sample.attenuation;
-			}
+		// If the streamer couldn't keep up, output silence for now
+		if( count == 0 )
+		{
+			break;
 		}
-	}
-}
 
+		done += count;
+	}
 
+	std::memset( &buffer[done * frameSize], 0, ( samples - done ) * frameSize );
 
+	// Convert from 16 or 24 bit into 32-bit float, stereo samples are
+	// interleaved just like our sample frames
+	float * out = &sampleData[0][0];
+	const int channels = sample.sample->Channels == 1 ? 1 : 2;
 
-// These two loop index functions taken from SampleBuffer.cpp
-f_cnt_t GigInstrument::getLoopedIndex( f_cnt_t index, f_cnt_t startf, f_cnt_t endf ) const
-{
-	if( index < endf )
+	if( sample.sample->BitDepth == 24 ) // 24 bit
 	{
-		return index;
+		convert24Bit( reinterpret_cast<uint8_t*>( buffer ), out,
+				samples * channels, sample.attenuation / 4294967296.0f );
 	}
-
-	return startf + ( index - startf )
-				% ( endf - startf );
-}
-
-
-
-
-f_cnt_t GigInstrument::getPingPongIndex( f_cnt_t index, f_cnt_t startf, f_cnt_t endf ) const
-{
-	if( index < endf )
+	else // 16 bit
 	{
-		return index;
+		convert16Bit( reinterpret_cast<int16_t*>( buffer ), out,
+				samples * channels, sample.attenuation / 65536.0f );
 	}
 
-	const f_cnt_t looplen = endf - startf;
-	const f_cnt_t looppos = ( index - endf ) % ( looplen * 2 );
-
-	return ( looppos < looplen )
-		? endf - looppos
-		: startf + ( looppos - looplen );
+	// Spread mono samples to both channels, backwards so that we don't
+	// overwrite what we haven't spread yet
+	if( channels == 1 )
+	{
+		for( f_cnt_t i = samples - 1; i >= 0; --i )
+		{
+			sampleData[i][1] = sampleData[i][0] = out[i];
+		}
+	}
 }
 
 
@@ -773,6 +853,7 @@ void GigInstrument::addSamples( GigNote & gignote, bool wantReleaseSample )
 
 				gignote.samples.push_back( GigSample( pSample, pDimRegion,
 							attenuation, m_interpolation, gignote.frequency ) );
+				gignote.samples.back().startStream( m_streamer );
 			}
 		}
 
@@ -889,6 +970,35 @@ void GigInstrument::getInstrument()
 			pInstrument = m_instance->gig.GetNextInstrument();
 		}
 
+		if( pInstrument == m_instrument )
+		{
+			return;
+		}
+
+		// Stop the notes of the old instrument, they might still be
+		// playing the samples we're about to release
+		gig::Instrument * pOldInstrument = m_instrument;
+		m_instrument = NULL;
+		m_notesMutex.lock();
+		m_notes.clear();
+		m_notesMutex.unlock();
+
+		// Don't block the audio thread while loading from disk, we just
+		// don't play anything in the meantime
+		locker.unlock();
+
+		if( pOldInstrument != NULL )
+		{
+			releaseSamples( pOldInstrument );
+		}
+
+		if( pInstrument != NULL )
+		{
+			preloadSamples( pInstrument );
+		}
+
+		locker.relock();
+
 		m_instrument = pInstrument;
 	}
 }
@@ -896,6 +1006,71 @@ void GigInstrument::getInstrument()
 
 
 
+void GigInstrument::preloadSamples( gig::Instrument * instrument )
+{
+	for( gig::Region * pRegion = instrument->GetFirstRegion();
+			pRegion != NULL; pRegion = instrument->GetNextRegion() )
+	{
+		for( uint32_t i = 0; i < pRegion->DimensionRegions; ++i )
+		{
+			gig::Sample * pSample = pRegion->pDimensionRegions[i]->pSample;
+
+			// Samples might be shared by several regions
+			if( pSample == NULL || pSample->GetCache().Size != 0 )
+			{
+				continue;
+			}
+
+			const unsigned long frames = pSample->SamplesPerSecond * PRELOAD_MS / 1000;
+
+			// Lock for every sample so the streamer doesn't have to wait
+			// for the whole instrument to be loaded
+			QMutexLocker ioLock( m_streamer->ioMutex() );
+
+			try
+			{
+				if( pSample->SamplesTotal <= frames )
+				{
+					pSample->LoadSampleData();
+				}
+				else
+				{
+					pSample->LoadSampleData( frames );
+				}
+			}
+			catch( ... )
+			{
+				// It'll be streamed from disk as a whole then
+			}
+		}
+	}
+}
+
+
+
+
+void GigInstrument::releaseSamples( gig::Instrument * instrument )
+{
+	QMutexLocker ioLock( m_streamer->ioMutex() );
+
+	for( gig::Region * pRegion = instrument->GetFirstRegion();
+			pRegion != NULL; pRegion = instrument->GetNextRegion() )
+	{
+		for( uint32_t i = 0; i < pRegion->DimensionRegions; ++i )
+		{
+			gig::Sample * pSample = pRegion->pDimensionRegions[i]->pSample;
+
+			if( pSample != NULL )
+			{
+				pSample->ReleaseSampleData();
+			}
+		}
+	}
+}
+
+
+
+
 // Since the sample rate changes when we start an export, clear all the
 // currently-playing notes when we get this signal. Then, the export won't
 // include leftover notes that were playing in the program.
@@ -1111,11 +1286,26 @@ void GigInstrumentView::showPatchDialog()
 GigSample::GigSample( gig::Sample * pSample, gig::DimensionRegion * pDimRegion,
 		float attenuation, int interpolation, float desiredFreq )
 	: sample( pSample ), region( pDimRegion ), attenuation( attenuation ),
-	  pos( 0 ), interpolation( interpolation ), srcState( NULL ),
+	  pos( 0 ), loop( false ), loopType( gig::loop_type_normal ),
+	  loopStart( 0 ), loopEnd( 0 ), stream( NULL ),
+	  interpolation( interpolation ), srcState( NULL ),
 	  sampleFreq( 0 ), freqFactor( 1 )
 {
 	if( sample != NULL && region != NULL )
 	{
+		// Currently only support at max one loop
+		if( region->pSampleLoops != NULL && region->SampleLoops > 0 &&
+				region->pSampleLoops[0].LoopLength > 0 &&
+				region->pSampleLoops[0].LoopStart +
+					region->pSampleLoops[0].LoopLength <= sample->SamplesTotal )
+		{
+			loop = true;
+			loopType = static_cast<gig::loop_type_t>(
+					region->pSampleLoops[0].LoopType );
+			loopStart = region->pSampleLoops[0].LoopStart;
+			loopEnd = loopStart + region->pSampleLoops[0].LoopLength;
+		}
+
 		// Note: we don't create the libsamplerate object here since we always
 		// also call the copy constructor when appending to the end of the
 		// QList. We'll create it only in the copy constructor so we only have
@@ -1148,6 +1338,11 @@ GigSample::~GigSample()
 	{
 		src_delete( srcState );
 	}
+
+	if( stream != NULL )
+	{
+		stream->stop();
+	}
 }
 
 
@@ -1155,7 +1350,8 @@ GigSample::~GigSample()
 
 GigSample::GigSample( const GigSample& g )
 	: sample( g.sample ), region( g.region ), attenuation( g.attenuation ),
-	  adsr( g.adsr ), pos( g.pos ), interpolation( g.interpolation ),
+	  adsr( g.adsr ), pos( g.pos ), loop( g.loop ), loopType( g.loopType ),
+	  loopStart( g.loopStart ), loopEnd( g.loopEnd ), stream( NULL ), interpolation( g.interpolation ),
 	  srcState( NULL ), sampleFreq( g.sampleFreq ), freqFactor( g.freqFactor )
 {
 	// On the copy, we want to create the object
@@ -1172,7 +1368,18 @@ GigSample& GigSample::operator=( const GigSample& g )
 	attenuation = g.attenuation;
 	adsr = g.adsr;
 	pos = g.pos;
+	loop = g.loop;
+	loopType = g.loopType;
+	loopStart = g.loopStart;
+	loopEnd = g.loopEnd;
 	interpolation = g.interpolation;
+
+	if( stream != NULL )
+	{
+		stream->stop();
+		stream = NULL;
+	}
+
 	srcState = NULL;
 	sampleFreq = g.sampleFreq;
 	freqFactor = g.freqFactor;
@@ -1254,6 +1461,310 @@ bool GigSample::convertSampleRate( sampleFrame & oldBuf, sampleFrame & newBuf,
 
 
 
+void GigSample::startStream( GigStreamer * streamer )
+{
+	if( sample == NULL || stream != NULL )
+	{
+		return;
+	}
+
+	const f_cnt_t cached = sample->GetCache().Size / sample->FrameSize;
+	const f_cnt_t end = loop ? loopEnd : (f_cnt_t) sample->SamplesTotal;
+
+	// Everything we'll ever play is preloaded
+	if( end <= cached )
+	{
+		return;
+	}
+
+	stream = streamer->start( sample, qMax( pos, cached ), loop, loopType,
+							loopStart, loopEnd );
+}
+
+
+
+
+void GigSample::advance( f_cnt_t frames )
+{
+	pos += frames;
+
+	if( stream != NULL )
+	{
+		stream->setPosition( pos );
+	}
+}
+
+
+
+
+GigStream::GigStream() :
+	m_state( Free ),
+	m_sample( NULL ),
+	m_start( 0 ),
+	m_frameSize( 0 ),
+	m_loop( false ),
+	m_loopType( gig::loop_type_normal ),
+	m_loopStart( 0 ),
+	m_loopEnd( 0 ),
+	m_data( new int8_t[GigStreamer::RingFrames * GigStreamer::MaxFrameSize] ),
+	m_written( 0 ),
+	m_consumed( 0 )
+{
+}
+
+
+
+
+GigStream::~GigStream()
+{
+	delete[] m_data;
+}
+
+
+
+
+f_cnt_t GigStream::read( int8_t * buffer, f_cnt_t pos, f_cnt_t frames ) const
+{
+	const f_cnt_t offset = pos - m_start;
+	frames = qBound( 0, m_written.loadAcquire() - offset, frames );
+
+	const f_cnt_t ringPos = offset % GigStreamer::RingFrames;
+	const f_cnt_t first = qMin( frames, GigStreamer::RingFrames - ringPos );
+
+	std::memcpy( buffer, m_data + ringPos * m_frameSize, first * m_frameSize );
+	std::memcpy( buffer + first * m_frameSize, m_data, ( frames - first ) * m_frameSize );
+
+	return frames;
+}
+
+
+
+
+void GigStream::setPosition( f_cnt_t pos )
+{
+	m_consumed.storeRelease( qMax( 0, pos - m_start ) );
+}
+
+
+
+
+void GigStream::stop()
+{
+	m_state.storeRelease( Stopped );
+}
+
+
+
+
+GigStreamer * GigStreamer::s_instance = NULL;
+int GigStreamer::s_refCount = 0;
+
+
+
+GigStreamer::GigStreamer() :
+	QThread(),
+	m_quit( false )
+{
+}
+
+
+
+
+GigStreamer::~GigStreamer()
+{
+	m_quit = true;
+	wait();
+}
+
+
+
+
+GigStreamer * GigStreamer::acquire()
+{
+	if( s_instance == NULL )
+	{
+		s_instance = new GigStreamer;
+		s_instance->start( QThread::HighPriority );
+	}
+
+	++s_refCount;
+
+	return s_instance;
+}
+
+
+
+
+void GigStreamer::release()
+{
+	if( --s_refCount == 0 )
+	{
+		delete s_instance;
+		s_instance = NULL;
+	}
+}
+
+
+
+
+GigStream * GigStreamer::start( gig::Sample * sample, f_cnt_t pos, bool loop,
+				gig::loop_type_t loopType, f_cnt_t loopStart,
+				f_cnt_t loopEnd )
+{
+	if( sample->FrameSize > MaxFrameSize )
+	{
+		return NULL;
+	}
+
+	for( int i = 0; i < MaxStreams; ++i )
+	{
+		GigStream & s = m_streams[i];
+
+		if( s.m_state.loadAcquire() == GigStream::Free &&
+			s.m_state.testAndSetAcquire( GigStream::Free, GigStream::Claimed ) )
+		{
+			s.m_sample = sample;
+			s.m_start = pos;
+			s.m_frameSize = sample->FrameSize;
+			s.m_loop = loop;
+			s.m_loopType = loopType;
+			s.m_loopStart = loopStart;
+			s.m_loopEnd = loopEnd;
+			s.m_written.storeRelease( 0 );
+			s.m_consumed.storeRelease( 0 );
+			s.m_state.storeRelease( GigStream::Streaming );
+
+			return &s;
+		}
+	}
+
+	return NULL;
+}
+
+
+
+
+void GigStreamer::run()
+{
+	while( !m_quit )
+	{
+		bool busy = false;
+
+		for( int i = 0; i < MaxStreams; ++i )
+		{
+			GigStream & s = m_streams[i];
+			const int state = s.m_state.loadAcquire();
+
+			if( state == GigStream::Stopped )
+			{
+				s.m_state.storeRelease( GigStream::Free );
+			}
+			else if( state == GigStream::Streaming )
+			{
+				QMutexLocker ioLock( &m_ioMutex );
+
+				// Check again, the sample might have been stopped and
+				// deleted while we were waiting for the lock
+				if( s.m_state.loadAcquire() == GigStream::Streaming &&
+						fill( s ) )
+				{
+					busy = true;
+				}
+			}
+		}
+
+		// Keep reading as long as there's something to do, one chunk
+		// per stream at a time so no stream has to wait for the others
+		if( !busy )
+		{
+			msleep( STREAMER_INTERVAL );
+		}
+	}
+}
+
+
+
+
+bool GigStreamer::fill( GigStream & s )
+{
+	const f_cnt_t consumed = s.m_consumed.loadAcquire();
+	f_cnt_t written = s.m_written.loadAcquire();
+
+	// After an underrun the audio thread has moved on without us, so
+	// continue at its position rather than reading what it already
+	// skipped. The read position below follows from written.
+	if( consumed > written )
+	{
+		written = consumed;
+	}
+
+	const f_cnt_t space = RingFrames - ( written - consumed );
+
+	const f_cnt_t pos = s.m_start + written;
+	f_cnt_t index;
+	bool backward;
+	const f_cnt_t run = loopRun( pos, s.m_sample->SamplesTotal, s.m_loop,
+				s.m_loopType, s.m_loopStart, s.m_loopEnd,
+				index, backward );
+
+	if( space <= 0 || run == 0 )
+	{
+		return false;
+	}
+
+	const f_cnt_t ringPos = written % RingFrames;
+	f_cnt_t count = qMin( qMin<f_cnt_t>( space, ChunkFrames ),
+				qMin( run, RingFrames - ringPos ) );
+	int8_t * dst = s.m_data + ringPos * s.m_frameSize;
+
+	// After looping we might be back in the preloaded part
+	const gig::buffer_t cache = s.m_sample->GetCache();
+	const f_cnt_t cached = cache.Size / s.m_frameSize;
+
+	if( backward && index < cached )
+	{
+		copyBackward( dst, static_cast<int8_t*>( cache.pStart ), index,
+							count, s.m_frameSize );
+	}
+	else if( index < cached )
+	{
+		count = qMin( count, cached - index );
+		std::memcpy( dst, static_cast<int8_t*>( cache.pStart ) + index * s.m_frameSize,
+				count * s.m_frameSize );
+	}
+	else
+	{
+		// Backwards we read the frames leading up to index from the file
+		// and turn them around afterwards
+		const f_cnt_t first = backward ? index - count + 1 : index;
+		f_cnt_t read = 0;
+
+		try
+		{
+			s.m_sample->SetPos( first );
+			read = s.m_sample->Read( dst, count );
+		}
+		catch( ... )
+		{
+		}
+
+		// Play silence if the file is broken rather than getting stuck
+		std::memset( dst + read * s.m_frameSize, 0, ( count - read ) * s.m_frameSize );
+
+		if( backward )
+		{
+			reverseFrames( dst, count, s.m_frameSize );
+		}
+	}
+
+	s.m_written.storeRelease( written + count );
+
+	return true;
+}
+
+
+
+
 ADSR::ADSR()
 	: preattack( 0 ), attack( 0 ), decay1( 0 ), decay2( 0 ), infiniteSustain( false ),
 	  sustain( 0 ), release( 0 ),
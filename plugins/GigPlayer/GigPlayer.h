@@ -30,6 +30,7 @@
 #include <QList>
 #include <QMutex>
 #include <QMutexLocker>
+#include <QThread>
 #include <samplerate.h>
 
 #include "Instrument.h"
@@ -39,6 +40,7 @@
 #include "LcdSpinBox.h"
 #include "LedCheckbox.h"
 #include "MemoryManager.h"
+#include "AtomicInt.h"
 #include "gig.h"
 
 class GigInstrumentView;
@@ -133,6 +135,119 @@ public:
 
 
 
+// Ring buffer of raw sample data that a playing sample reads from once it is
+// past the part of the sample preloaded into RAM. It is filled ahead of the
+// play position by the GigStreamer thread, so the audio thread never has to
+// wait for the disk.
+class GigStream
+{
+public:
+	GigStream();
+	~GigStream();
+
+	// Copy up to frames frames starting at position pos of the sample (i.e.
+	// counted from where it started playing, not wrapped into the loop)
+	// into buffer and return how many of them have been read from disk yet
+	f_cnt_t read( int8_t * buffer, f_cnt_t pos, f_cnt_t frames ) const;
+
+	// Let the streamer know we won't need anything before pos anymore
+	void setPosition( f_cnt_t pos );
+
+	// Position of the first frame in the stream
+	f_cnt_t start() const
+	{
+		return m_start;
+	}
+
+	// Done playing, the streamer may reuse this stream now
+	void stop();
+
+private:
+	enum States
+	{
+		Free,
+		Claimed,
+		Streaming,
+		Stopped
+	} ;
+
+	AtomicInt m_state;
+
+	gig::Sample * m_sample;
+	f_cnt_t m_start;
+	f_cnt_t m_frameSize;
+	bool m_loop;
+	gig::loop_type_t m_loopType;
+	f_cnt_t m_loopStart;
+	f_cnt_t m_loopEnd;
+
+	int8_t * m_data;
+
+	// Frames written by the streamer and consumed by the audio thread
+	// since the stream started
+	AtomicInt m_written;
+	AtomicInt m_consumed;
+
+	friend class GigStreamer;
+} ;
+
+
+
+
+// Background thread streaming the samples from disk that don't fit into the
+// preloaded part, shared by all GIG instruments
+class GigStreamer : public QThread
+{
+public:
+	enum
+	{
+		MaxStreams = 128,
+		RingFrames = 16384,
+		// 24 bit stereo
+		MaxFrameSize = 6,
+		// How much to read per stream before moving on to the next one
+		ChunkFrames = 4096
+	} ;
+
+	// Get the streamer, starting it if this is the first instrument
+	static GigStreamer * acquire();
+	static void release();
+
+	// Start streaming sample from position pos, returns NULL if all streams
+	// are busy. Called from the audio thread.
+	GigStream * start( gig::Sample * sample, f_cnt_t pos, bool loop,
+				gig::loop_type_t loopType, f_cnt_t loopStart,
+				f_cnt_t loopEnd );
+
+	// libgig keeps one file position per sample, so everything reading
+	// from GIG files has to hold this lock. Also hold it when deleting
+	// samples the streamer might be reading.
+	QMutex * ioMutex()
+	{
+		return &m_ioMutex;
+	}
+
+private:
+	GigStreamer();
+	virtual ~GigStreamer();
+
+	virtual void run();
+
+	// Returns false if the stream is full already
+	bool fill( GigStream & stream );
+
+	static GigStreamer * s_instance;
+	static int s_refCount;
+
+	GigStream m_streams[MaxStreams];
+	QMutex m_ioMutex;
+
+	volatile bool m_quit;
+} ;
+
+
+
+
 // The sample from the GIG file with our current position in both the sample
 // and the envelope
 class GigSample
@@ -151,14 +266,33 @@ public:
 	bool convertSampleRate( sampleFrame & oldBuf, sampleFrame & newBuf,
 		f_cnt_t oldSize, f_cnt_t newSize, float freq_factor, f_cnt_t& used );
 
+	// Stream whatever isn't preloaded from disk. Like the libsamplerate
+	// object, the stream isn't copied, so call this on the sample in the
+	// QList.
+	void startStream( GigStreamer * streamer );
+
+	// Move forward in the sample after playing frames
+	void advance( f_cnt_t frames );
+
 	gig::Sample * sample;
 	gig::DimensionRegion * region;
 	float attenuation;
 	ADSR adsr;
 
-	// The position in sample
+	// The position in sample, counted from the start without wrapping
+	// around in loops
 	f_cnt_t pos;
 
+	// The (first) loop of the sample, played forward, backward or back and
+	// forth after the first pass up to its end
+	bool loop;
+	gig::loop_type_t loopType;
+	f_cnt_t loopStart;
+	f_cnt_t loopEnd;
+
+	// NULL if the sample is completely preloaded
+	GigStream * stream;
+
 	// Whether to change the pitch of the samples, e.g. if there's only one
 	// sample per octave and you want that sample pitch shifted for the rest of
 	// the notes in the octave, this will be true
@@ -295,6 +429,9 @@ private:
 	// Used for resampling
 	int m_interpolation;
 
+	// Reads the parts of the samples that aren't preloaded
+	GigStreamer * m_streamer;
+
 	// List of all the currently playing notes
 	QList<GigNote> m_notes;
 
@@ -309,14 +446,17 @@ private:
 	// Open the instrument in the currently-open GIG file
 	void getInstrument();
 
+	// Keep the beginning of all the samples of an instrument in RAM so
+	// notes can start playing before the streamer has read anything
+	void preloadSamples( gig::Instrument * instrument );
+	void releaseSamples( gig::Instrument * instrument );
+
 	// Create "dimension" to select desired samples from GIG file based on
 	// parameters such as velocity
 	Dimension getDimensions( gig::Region * pRegion, int velocity, bool release );
 
 	// Load sample data from the Gig file, looping the sample where needed
 	void loadSample( GigSample& sample, sampleFrame* sampleData, f_cnt_t samples );
-	f_cnt_t getLoopedIndex( f_cnt_t index, f_cnt_t startf, f_cnt_t endf ) const;
-	f_cnt_t getPingPongIndex( f_cnt_t index, f_cnt_t startf, f_cnt_t endf ) const;
 
 	// Add the desired samples to the note, either normal samples or release
 	// samples
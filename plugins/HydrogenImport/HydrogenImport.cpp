@@ -258,6 +258,8 @@ bool HydrogenImport::readSong()
 		pattern_length[sName] = nSize;
 		QDomNode pNoteListNode = patternNode.firstChildElement( "noteList" );
 		if ( ! pNoteListNode.isNull() ) {
+			// collect notes per pattern and add them all at once
+			QMap<Pattern *, QVector<Note> > notes;
 			QDomNode noteNode = pNoteListNode.firstChildElement( "note" );
 			while ( ! noteNode.isNull()  ) {
 				int nPosition = LocalFileMng::readXmlInt( noteNode, "position", 0 );
@@ -284,10 +286,15 @@ bool HydrogenImport::readSong()
 				n.setVolume( fVelocity * 100 );
 				n.setPanning( ( fPan_R - fPan_L ) * 100 );
 				n.setKey( NoteKey::stringToNoteKey( sKey ) );
-				p->addNote( n,false );
+				notes[p].push_back( n );
 				pn = pn + 1;
 				noteNode = ( QDomNode ) noteNode.nextSiblingElement( "note" );
 			}        
+			for( QMap<Pattern *, QVector<Note> >::ConstIterator it = notes.begin();
+							it != notes.end(); ++it )
+			{
+				it.key()->addNotes( it.value(), false );
+			}
 		}
 		patternNode = ( QDomNode ) patternNode.nextSiblingElement( "pattern" );
 	}
@@ -175,6 +175,7 @@ public:
 
 	void clear()
 	{
+		flush();
 		at = NULL;
 		ap = NULL;
 		lastPos = 0;
@@ -185,6 +186,7 @@ public:
 	{
 		if( !ap || time > lastPos + DefaultTicksPerTact )
 		{
+			flush();
 			MidiTime pPos = MidiTime( time.getTact(), 0 );
 			ap = dynamic_cast<AutomationPattern*>(
 				at->createTCO(0) );
@@ -194,11 +196,27 @@ public:
 
 		lastPos = time;
 		time = time - ap->startPosition();
-		ap->putValue( time, value, false );
-		ap->changeLength( MidiTime( time.getTact() + 1, 0 ) ); 
+		pendingValues[time] = value;
 
 		return *this;
 	}
+
+
+	// adds all values collected for the current pattern at once
+	void flush()
+	{
+		if( ap && !pendingValues.isEmpty() )
+		{
+			ap->putValues( pendingValues, false );
+			ap->changeLength( MidiTime(
+				MidiTime( pendingValues.lastKey() ).getTact() + 1, 0 ) );
+		}
+		pendingValues.clear();
+	}
+
+private:
+	AutomationPattern::timeMap pendingValues;
+
 };
 
 
@@ -264,6 +282,7 @@ public:
 	{
 		if( !p || n.pos() > lastEnd + DefaultTicksPerTact )
 		{
+			flush();
 			MidiTime pPos = MidiTime( n.pos().getTact(), 0 );
 			p = dynamic_cast<Pattern*>( it->createTCO( 0 ) );
 			p->movePosition( pPos );
@@ -271,9 +290,23 @@ public:
 		hasNotes = true;
 		lastEnd = n.pos() + n.length();
 		n.setPos( n.pos( p->startPosition() ) );
-		p->addNote( n, false );
+		pendingNotes.push_back( n );
+	}
+
+
+	// adds all notes collected for the current pattern at once
+	void flush()
+	{
+		if( p )
+		{
+			p->addNotes( pendingNotes, false );
+		}
+		pendingNotes.clear();
 	}
 
+private:
+	QVector<Note> pendingNotes;
+
 };
 
 
@@ -339,18 +372,20 @@ bool MidiImport::readSMF( TrackContainer* tc )
 		tap->clear();
 		Alg_time_map * timeMap = seq->get_time_map();
 		Alg_beats & beats = timeMap->beats;
+		AutomationPattern::timeMap tempos;
 		for( int i = 0; i < beats.len - 1; i++ )
 		{
 			Alg_beat_ptr b = &(beats[i]);
 			double tempo = ( beats[i + 1].beat - b->beat ) /
 						   ( beats[i + 1].time - beats[i].time );
-			tap->putValue( b->beat * ticksPerBeat, tempo * 60.0 );
+			tempos[MidiTime( b->beat * ticksPerBeat )] = tempo * 60.0;
 		}
 		if( timeMap->last_tempo_flag )
 		{
 			Alg_beat_ptr b = &( beats[beats.len - 1] );
-			tap->putValue( b->beat * ticksPerBeat, timeMap->last_tempo * 60.0 );
+			tempos[MidiTime( b->beat * ticksPerBeat )] = timeMap->last_tempo * 60.0;
 		}
+		tap->putValues( tempos );
 	}
 
 	// Update the tempo to avoid crash when playing a project imported
@@ -526,9 +561,15 @@ bool MidiImport::readSMF( TrackContainer* tc )
 
 	delete seq;
 	
+	for( int c = 0; c < 129; ++c )
+	{
+		ccs[c].flush();
+	}
 	
 	for( int c=0; c < 256; ++c )
 	{
+		chs[c].flush();
+
 		if( !chs[c].hasNotes && chs[c].it )
 		{
 			printf(" Should remove empty track\n");
@@ -50,14 +50,17 @@ Plugin::Descriptor PLUGIN_EXPORT spectrumanalyzer_plugin_descriptor =
 SpectrumAnalyzer::SpectrumAnalyzer( Model * _parent,
 			const Descriptor::SubPluginFeatures::Key * _key ) :
 	Effect( &spectrumanalyzer_plugin_descriptor, _parent, _key ),
+	FftAnalysisService::Client( FFT_BUFFER_SIZE ),
 	m_saControls( this ),
-	m_framesFilledUp( 0 ),
 	m_energy( 0 )
 {
-	memset( m_buffer, 0, sizeof( m_buffer ) );
+	m_buffer = (float *) fftwf_malloc( FFT_BUFFER_SIZE * 2 * sizeof( float ) );
+	memset( m_buffer, 0, FFT_BUFFER_SIZE * 2 * sizeof( float ) );
 
 	m_specBuf = (fftwf_complex *) fftwf_malloc( ( FFT_BUFFER_SIZE + 1 ) * sizeof( fftwf_complex ) );
-	m_fftPlan = fftwf_plan_dft_r2c_1d( FFT_BUFFER_SIZE*2, m_buffer, m_specBuf, FFTW_MEASURE );
+	m_fftPlan = sharedFftPlanR2C( FFT_BUFFER_SIZE*2 );
+
+	FftAnalysisService::addClient( this );
 }
 
 
@@ -65,8 +68,10 @@ SpectrumAnalyzer::SpectrumAnalyzer( Model * _parent,
 
 SpectrumAnalyzer::~SpectrumAnalyzer()
 {
-	fftwf_destroy_plan( m_fftPlan );
+	FftAnalysisService::removeClient( this );
+
 	fftwf_free( m_specBuf );
+	fftwf_free( m_buffer );
 }
 
 
@@ -84,54 +89,55 @@ bool SpectrumAnalyzer::processAudioBuffer( sampleFrame* _buf, const fpp_t _frame
 		return true;
 	}
 
-	fpp_t f = 0;
-	if( _frames > FFT_BUFFER_SIZE )
-	{
-		m_framesFilledUp = 0;
-		f = _frames - FFT_BUFFER_SIZE;
-	}
+	// the actual analysis is done in analyzeWindow() on the analysis thread
+	pushFrames( _buf, _frames );
+
+	checkGate( 1 );
+
+	return isRunning();
+}
+
 
+
+
+void SpectrumAnalyzer::analyzeWindow( const sampleFrame * window, int frames )
+{
 	const int cm = m_saControls.m_channelMode.value();
 
 	switch( cm )
 	{
 		case MergeChannels:
-			for( ; f < _frames; ++f )
+			for( int f = 0; f < frames; ++f )
 			{
-				m_buffer[m_framesFilledUp] =
-					( _buf[f][0] + _buf[f][1] ) * 0.5;
-				++m_framesFilledUp;
+				m_buffer[f] = ( window[f][0] + window[f][1] ) * 0.5;
 			}
 			break;
 		case LeftChannel:
-			for( ; f < _frames; ++f )
+			for( int f = 0; f < frames; ++f )
 			{
-				m_buffer[m_framesFilledUp] = _buf[f][0];
-				++m_framesFilledUp;
+				m_buffer[f] = window[f][0];
 			}
 			break;
 		case RightChannel:
-			for( ; f < _frames; ++f )
+			for( int f = 0; f < frames; ++f )
 			{
-				m_buffer[m_framesFilledUp] = _buf[f][1];
-				++m_framesFilledUp;
+				m_buffer[f] = window[f][1];
 			}
 			break;
 	}
 
-	if( m_framesFilledUp < FFT_BUFFER_SIZE )
+	if( m_fftPlan == NULL )
 	{
-		return isRunning();
+		return;
 	}
 
-
 //	hanming( m_buffer, FFT_BUFFER_SIZE, HAMMING );
 
 	const sample_rate_t sr = Engine::mixer()->processingSampleRate();
 	const int LOWEST_FREQ = 0;
 	const int HIGHEST_FREQ = sr / 2;
 
-	fftwf_execute( m_fftPlan );
+	fftwf_execute_dft_r2c( m_fftPlan, m_buffer, m_specBuf );
 	absspec( m_specBuf, m_absSpecBuf, FFT_BUFFER_SIZE+1 );
 	if( m_saControls.m_linearSpec.value() )
 	{
@@ -146,13 +152,6 @@ bool SpectrumAnalyzer::processAudioBuffer( sampleFrame* _buf, const fpp_t _frame
 		calc13octaveband31( m_absSpecBuf, m_bands, FFT_BUFFER_SIZE+1, sr/2.0 );
 		m_energy = signalpower( m_buffer, FFT_BUFFER_SIZE ) / maximum( m_buffer, FFT_BUFFER_SIZE );
 	}
-
-
-	m_framesFilledUp = 0;
-
-	checkGate( 1 );
-
-	return isRunning();
 }
 
 
@@ -27,6 +27,7 @@
 #define _SPECTRUM_ANALYZER_H
 
 #include "Effect.h"
+#include "FftAnalysisService.h"
 #include "fft_helpers.h"
 #include "SpectrumAnalyzerControls.h"
 
@@ -34,7 +35,7 @@
 const int MAX_BANDS = 249;
 
 
-class SpectrumAnalyzer : public Effect
+class SpectrumAnalyzer : public Effect, public FftAnalysisService::Client
 {
 public:
 	enum ChannelModes
@@ -56,6 +57,10 @@ public:
 	}
 
 
+protected:
+	virtual void analyzeWindow( const sampleFrame * window, int frames );
+
+
 private:
 	SpectrumAnalyzerControls m_saControls;
 
@@ -63,8 +68,7 @@ private:
 
 	fftwf_complex * m_specBuf;
 	float m_absSpecBuf[FFT_BUFFER_SIZE+1];
-	float m_buffer[FFT_BUFFER_SIZE*2];
-	int m_framesFilledUp;
+	float * m_buffer;
 
 	float m_bands[MAX_BANDS];
 	float m_energy;
@@ -747,6 +747,8 @@ void AudioFileProcessorView::modelChanged( void )
 	audioFileProcessor * a = castModel<audioFileProcessor>();
 	connect( &a->m_sampleBuffer, SIGNAL( sampleUpdated() ),
 					this, SLOT( sampleUpdated() ) );
+	connect( &a->m_sampleBuffer, SIGNAL( peaksUpdated() ),
+					m_waveView, SLOT( update() ) );
 	m_ampKnob->setModel( &a->m_ampModel );
 	m_startKnob->setModel( &a->m_startPointModel );
 	m_endKnob->setModel( &a->m_endPointModel );
@@ -24,6 +24,7 @@
 
 
 #include <QDomElement>
+#include <cstring>
 
 #include "Monstro.h"
 #include "Engine.h"
@@ -60,10 +61,23 @@ Plugin::Descriptor PLUGIN_EXPORT monstro_plugin_descriptor =
 
 
 
-MonstroSynth::MonstroSynth( MonstroInstrument * _i, NotePlayHandle * _nph ) :
-					m_parent( _i ),
-					m_nph( _nph )
+MonstroSynth::MonstroSynth() :
+					m_parent( NULL ),
+					m_nph( NULL )
 {
+}
+
+
+MonstroSynth::~MonstroSynth()
+{
+}
+
+
+void MonstroSynth::reset( MonstroInstrument * _i, NotePlayHandle * _nph )
+{
+	m_parent = _i;
+	m_nph = _nph;
+
 	m_osc1l_phase = 0.0f;
 	m_osc1r_phase = 0.0f;
 	m_osc2l_phase = 0.0f;
@@ -102,46 +116,75 @@ MonstroSynth::MonstroSynth( MonstroInstrument * _i, NotePlayHandle * _nph ) :
 }
 
 
-MonstroSynth::~MonstroSynth()
+// the following helpers evaluate one modulation route for a whole period
+
+// sum of all active modulators times their amounts
+static inline void sumModulators( float * _out, const float * _env1, const float * _env2,
+		const float * _lfo1, const float * _lfo2,
+		const float _e1, const float _e2, const float _l1, const float _l2, const fpp_t _frames )
 {
+	memset( _out, 0, sizeof( float ) * _frames );
+	if( _e1 != 0.0f ) for( fpp_t f = 0; f < _frames; ++f ) _out[f] += _env1[f] * _e1;
+	if( _e2 != 0.0f ) for( fpp_t f = 0; f < _frames; ++f ) _out[f] += _env2[f] * _e2;
+	if( _l1 != 0.0f ) for( fpp_t f = 0; f < _frames; ++f ) _out[f] += _lfo1[f] * _l1;
+	if( _l2 != 0.0f ) for( fpp_t f = 0; f < _frames; ++f ) _out[f] += _lfo2[f] * _l2;
 }
 
+// gain factor of all active modulators - positive envelope amounts fade from
+// silence, negative ones towards silence
+static inline void volumeModulators( float * _out, const float * _env1, const float * _env2,
+		const float * _lfo1, const float * _lfo2,
+		const float _e1, const float _e2, const float _l1, const float _l2, const fpp_t _frames )
+{
+	for( fpp_t f = 0; f < _frames; ++f ) _out[f] = 1.0f;
+	if( _e1 > 0.0f ) for( fpp_t f = 0; f < _frames; ++f ) _out[f] *= 1.0f - _e1 + _e1 * _env1[f];
+	if( _e1 < 0.0f ) for( fpp_t f = 0; f < _frames; ++f ) _out[f] *= 1.0f + _e1 * _env1[f];
+	if( _e2 > 0.0f ) for( fpp_t f = 0; f < _frames; ++f ) _out[f] *= 1.0f - _e2 + _e2 * _env2[f];
+	if( _e2 < 0.0f ) for( fpp_t f = 0; f < _frames; ++f ) _out[f] *= 1.0f + _e2 * _env2[f];
+	if( _l1 != 0.0f ) for( fpp_t f = 0; f < _frames; ++f ) _out[f] *= 1.0f + _l1 * _lfo1[f];
+	if( _l2 != 0.0f ) for( fpp_t f = 0; f < _frames; ++f ) _out[f] *= 1.0f + _l2 * _lfo2[f];
+}
 
-void MonstroSynth::renderOutput( fpp_t _frames, sampleFrame * _buf  )
+// turns octaves into frequency factors
+static inline void exp2Vector( float * _buf, const fpp_t _frames )
 {
-	float modtmp; // temp variable for freq modulation
-// macros for modulating with env/lfos
-#define modulatefreq( car, mod ) \
-		modtmp = 0.0f; \
-		if( mod##_e1 != 0.0f ) modtmp += env[0][f] * mod##_e1; \
-		if( mod##_e2 != 0.0f ) modtmp += env[1][f] * mod##_e2; \
-		if( mod##_l1 != 0.0f ) modtmp += lfo[0][f] * mod##_l1; \
-		if( mod##_l2 != 0.0f ) modtmp += lfo[1][f] * mod##_l2; \
-		car = qBound( MIN_FREQ, car * powf( 2.0f, modtmp ), MAX_FREQ );
-
-#define modulateabs( car, mod ) \
-		if( mod##_e1 != 0.0f ) car += env[0][f] * mod##_e1; \
-		if( mod##_e2 != 0.0f ) car += env[1][f] * mod##_e2; \
-		if( mod##_l1 != 0.0f ) car += lfo[0][f] * mod##_l1; \
-		if( mod##_l2 != 0.0f ) car += lfo[1][f] * mod##_l2;
-
-#define modulatephs( car, mod ) \
-		if( mod##_e1 != 0.0f ) car += env[0][f] * mod##_e1; \
-		if( mod##_e2 != 0.0f ) car += env[1][f] * mod##_e2; \
-		if( mod##_l1 != 0.0f ) car += lfo[0][f] * mod##_l1; \
-		if( mod##_l2 != 0.0f ) car += lfo[1][f] * mod##_l2;
-
-#define modulatevol( car, mod ) \
-		if( mod##_e1 > 0.0f ) car *= ( 1.0f - mod##_e1 + mod##_e1 * env[0][f] ); \
-		if( mod##_e1 < 0.0f ) car *= ( 1.0f + mod##_e1 * env[0][f] );	\
-		if( mod##_e2 > 0.0f ) car *= ( 1.0f - mod##_e2 + mod##_e2 * env[1][f] );	\
-		if( mod##_e2 < 0.0f ) car *= ( 1.0f + mod##_e2 * env[1][f] );	\
-		if( mod##_l1 != 0.0f ) car *= ( 1.0f + mod##_l1 * lfo[0][f] ); \
-		if( mod##_l2 != 0.0f ) car *= ( 1.0f + mod##_l2 * lfo[1][f] ); \
-		car = qBound( -MODCLIP, car, MODCLIP );
+	for( fpp_t f = 0; f < _frames; ++f ) _buf[f] = fastExp2f( _buf[f] );
+}
 
+static inline void boundedOffsetVector( float * _buf, const float _offset,
+		const float _min, const float _max, const fpp_t _frames )
+{
+	for( fpp_t f = 0; f < _frames; ++f ) _buf[f] = qBound( _min, _buf[f] + _offset, _max );
+}
 
 
+void MonstroSynth::oscillateBlock( int _wave, const float * _ph, const float * _len,
+					sample_t * _out, fpp_t _frames )
+{
+	switch( _wave )
+	{
+		case WAVE_SINE: oscillateWave<WAVE_SINE>( _ph, _len, _out, _frames ); break;
+		case WAVE_TRI: oscillateWave<WAVE_TRI>( _ph, _len, _out, _frames ); break;
+		case WAVE_SAW: oscillateWave<WAVE_SAW>( _ph, _len, _out, _frames ); break;
+		case WAVE_RAMP: oscillateWave<WAVE_RAMP>( _ph, _len, _out, _frames ); break;
+		case WAVE_SQR: oscillateWave<WAVE_SQR>( _ph, _len, _out, _frames ); break;
+		case WAVE_MOOG: oscillateWave<WAVE_MOOG>( _ph, _len, _out, _frames ); break;
+		case WAVE_SQRSOFT: oscillateWave<WAVE_SQRSOFT>( _ph, _len, _out, _frames ); break;
+		case WAVE_SINABS: oscillateWave<WAVE_SINABS>( _ph, _len, _out, _frames ); break;
+		case WAVE_EXP: oscillateWave<WAVE_EXP>( _ph, _len, _out, _frames ); break;
+		case WAVE_NOISE: oscillateWave<WAVE_NOISE>( _ph, _len, _out, _frames ); break;
+		case WAVE_TRI_D: oscillateWave<WAVE_TRI_D>( _ph, _len, _out, _frames ); break;
+		case WAVE_SAW_D: oscillateWave<WAVE_SAW_D>( _ph, _len, _out, _frames ); break;
+		case WAVE_RAMP_D: oscillateWave<WAVE_RAMP_D>( _ph, _len, _out, _frames ); break;
+		case WAVE_SQR_D: oscillateWave<WAVE_SQR_D>( _ph, _len, _out, _frames ); break;
+		case WAVE_MOOG_D: oscillateWave<WAVE_MOOG_D>( _ph, _len, _out, _frames ); break;
+		default: memset( _out, 0, sizeof( sample_t ) * _frames ); break;
+	}
+}
+
+
+void MonstroSynth::renderOutput( fpp_t _frames, sampleFrame * _buf  )
+{
 	////////////////////
 	//                //
 	//   MODULATORS   //
@@ -305,184 +348,178 @@ void MonstroSynth::renderOutput( fpp_t _frames, sampleFrame * _buf  )
 
 	///////////////////////////
 	//                       //
-	// 	 start buffer loop   //
+	//  modulation vectors   //
 	//                       //
 	///////////////////////////
 
-	// declare working variables for for loop
+	// modulators
+	float lfo[2][ m_parent->m_fpp ];
+	float env[2][ m_parent->m_fpp ];
+	
+	// render modulators: envelopes, lfos
+	updateModulators( &env[0][0], &env[1][0], &lfo[0][0], &lfo[1][0], _frames );
+
+	// every modulation route is evaluated for the whole period at once and
+	// only if it has any modulation amount set - left and right channel
+	// share the same modulation, so each route is computed only once
+	float o1f_m[ m_parent->m_fpp ];
+	float o1pw_m[ m_parent->m_fpp ];
+	float o1p_m[ m_parent->m_fpp ];
+	float o1v_m[ m_parent->m_fpp ];
+	float o2f_m[ m_parent->m_fpp ];
+	float o2p_m[ m_parent->m_fpp ];
+	float o2v_m[ m_parent->m_fpp ];
+	float o3f_m[ m_parent->m_fpp ];
+	float o3p_m[ m_parent->m_fpp ];
+	float o3v_m[ m_parent->m_fpp ];
+	float o3s_m[ m_parent->m_fpp ];
+
+#define sumroute( buf, mod ) \
+		sumModulators( buf, env[0], env[1], lfo[0], lfo[1], mod##_e1, mod##_e2, mod##_l1, mod##_l2, _frames );
+#define volroute( buf, mod ) \
+		volumeModulators( buf, env[0], env[1], lfo[0], lfo[1], mod##_e1, mod##_e2, mod##_l1, mod##_l2, _frames );
+
+	if( o1f_mod ) { sumroute( o1f_m, o1f ) exp2Vector( o1f_m, _frames ); }
+	if( o1pw_mod ) { sumroute( o1pw_m, o1pw ) boundedOffsetVector( o1pw_m, pw, PW_MIN, PW_MAX, _frames ); }
+	if( o1p_mod ) { sumroute( o1p_m, o1p ) }
+	if( o1v_mod ) { volroute( o1v_m, o1v ) }
+	if( o2f_mod ) { sumroute( o2f_m, o2f ) exp2Vector( o2f_m, _frames ); }
+	if( o2p_mod ) { sumroute( o2p_m, o2p ) }
+	if( o2v_mod ) { volroute( o2v_m, o2v ) }
+	if( o3f_mod ) { sumroute( o3f_m, o3f ) exp2Vector( o3f_m, _frames ); }
+	if( o3p_mod ) { sumroute( o3p_m, o3p ) }
+	if( o3v_mod ) { volroute( o3v_m, o3v ) }
+	if( o3s_mod ) { sumroute( o3s_m, o3s ) boundedOffsetVector( o3s_m, o3sub, 0.0f, 1.0f, _frames ); }
+
+#undef sumroute
+#undef volroute
+
+	const float isr = 1.0f / static_cast<float>( m_parent->m_samplerate );
 
 	// phase manipulation vars - these can be reused by all oscs
 	float leftph;
 	float rightph;
 	float pd_l;
 	float pd_r;
-	float len_l;
-	float len_r;
-
-	// osc1 vars
-	float o1l_f;
-	float o1r_f;
-	float o1l_p = m_osc1l_phase + o1lpo; // we add phase offset here so we don't have to do it every frame
-	float o1r_p = m_osc1r_phase + o1rpo; // then substract it again after loop...
-	float o1_pw;
-
-	// osc2 vars
-	float o2l_f;
-	float o2r_f;
+
+	// osc outputs
+	sample_t O1L[ m_parent->m_fpp ];
+	sample_t O1R[ m_parent->m_fpp ];
+	sample_t O2L[ m_parent->m_fpp ];
+	sample_t O2R[ m_parent->m_fpp ];
+	sample_t O3L[ m_parent->m_fpp ];
+	sample_t O3R[ m_parent->m_fpp ];
+	sample_t O3BL[ m_parent->m_fpp ];
+	sample_t O3BR[ m_parent->m_fpp ];
+
+	// phases and wavelengths of osc2 and osc3, reused for both
+	float ph_l[ m_parent->m_fpp ];
+	float ph_r[ m_parent->m_fpp ];
+	float len_l[ m_parent->m_fpp ];
+	float len_r[ m_parent->m_fpp ];
+
+	// osc1 edges that trigger syncing osc2 and osc3
+	unsigned char sync[ m_parent->m_fpp ];
+	const unsigned char SYNC_L = 1;
+	const unsigned char SYNC_R = 2;
+
+	// osc phases - we add phase offset here so we don't have to do it
+	// every frame, then substract it again after rendering...
+	float o1l_p = m_osc1l_phase + o1lpo;
+	float o1r_p = m_osc1r_phase + o1rpo;
 	float o2l_p = m_osc2l_phase + o2lpo;
 	float o2r_p = m_osc2r_phase + o2rpo;
-
-	// osc3 vars
-	float o3l_f;
-	float o3r_f;
 	float o3l_p = m_osc3l_phase + o3lpo;
 	float o3r_p = m_osc3r_phase + o3rpo;
-	float sub;
 
-	// modulators
-	float lfo[2][ m_parent->m_fpp ];
-	float env[2][ m_parent->m_fpp ];
-	
-	// render modulators: envelopes, lfos
-	updateModulators( &env[0][0], &env[1][0], &lfo[0][0], &lfo[1][0], _frames );
+	/////////////////////////////
+	//				           //
+	//          OSC 1          //
+	//				           //
+	/////////////////////////////
 
-	// begin for loop
 	for( f_cnt_t f = 0; f < _frames; ++f )
 	{
-/*	// debug code
-		if( f % 10 == 0 ) {
-			qDebug( "env1 %f -- env1 phase %f", m_env1_buf[f], m_env1_phase );
-			qDebug( "env1 pre %f att %f dec %f rel %f ", m_parent->m_env1_pre, m_parent->m_env1_att,
-				m_parent->m_env1_dec, m_parent->m_env1_rel );
-		}*/
-
-
-		/////////////////////////////
-		//				           //
-		//          OSC 1          //
-		//				           //
-		/////////////////////////////
-
-		// calc and mod frequencies
-		o1l_f = o1lfb;
-		o1r_f = o1rfb;
-		if( o1f_mod )
-		{
-			modulatefreq( o1l_f, o1f )
-			modulatefreq( o1r_f, o1f )
-		}
-		// calc and modulate pulse
-		o1_pw = pw;
-		if( o1pw_mod )
-		{
-			modulateabs( o1_pw, o1pw )
-			o1_pw = qBound( PW_MIN, o1_pw, PW_MAX );
-		}
-
-		// calc and modulate phase
+		// calc and modulate phase and pulse
 		leftph = o1l_p;
 		rightph = o1r_p;
 		if( o1p_mod )
 		{
-			modulatephs( leftph, o1p )
-			modulatephs( rightph, o1p )
+			leftph += o1p_m[f];
+			rightph += o1p_m[f];
 		}
+		const float o1_pw = o1pw_mod ? o1pw_m[f] : pw;
 
 		// pulse wave osc
-		sample_t O1L = ( absFraction( leftph ) < o1_pw ) ? 1.0f : -1.0f;
-		sample_t O1R = ( absFraction( rightph ) < o1_pw ) ? 1.0f : -1.0f;
+		sample_t l = ( absFraction( leftph ) < o1_pw ) ? 1.0f : -1.0f;
+		sample_t r = ( absFraction( rightph ) < o1_pw ) ? 1.0f : -1.0f;
 
-		// check for rise/fall, and sync if appropriate
-		// sync on rise
-		if( o1ssr )
-		{
-			// hard sync
-			if( o2sync )
-			{
-				if( O1L > m_osc1l_last ) { o2l_p = o2lpo; m_counter2l = m_parent->m_counterMax; }
-				if( O1R > m_osc1r_last ) { o2r_p = o2rpo; m_counter2r = m_parent->m_counterMax; }
-			}
-			if( o3sync )
-			{
-				if( O1L > m_osc1l_last ) { o3l_p = o3lpo; m_counter3l = m_parent->m_counterMax; }
-				if( O1R > m_osc1r_last ) { o3r_p = o3rpo; m_counter3r = m_parent->m_counterMax; }
-			}
-			// reverse sync
-			if( o2syncr )
-			{
-				if( O1L > m_osc1l_last ) { m_invert2l = !m_invert2l; m_counter2l = m_parent->m_counterMax; }
-				if( O1R > m_osc1r_last ) { m_invert2r = !m_invert2r; m_counter2r = m_parent->m_counterMax; }
-			}
-			if( o3syncr )
-			{
-				if( O1L > m_osc1l_last ) { m_invert3l = !m_invert3l; m_counter3l = m_parent->m_counterMax; }
-				if( O1R > m_osc1r_last ) { m_invert3r = !m_invert3r; m_counter3r = m_parent->m_counterMax; }
-			}
-		}
-		// sync on fall
-		if( o1ssf )
-		{
-			// hard sync
-			if( o2sync )
-			{
-				if( O1L < m_osc1l_last ) { o2l_p = o2lpo; m_counter2l = m_parent->m_counterMax; }
-				if( O1R < m_osc1r_last ) { o2r_p = o2rpo; m_counter2r = m_parent->m_counterMax; }
-			}
-			if( o3sync )
-			{
-				if( O1L < m_osc1l_last ) { o3l_p = o3lpo; m_counter3l = m_parent->m_counterMax; }
-				if( O1R < m_osc1r_last ) { o3r_p = o3rpo; m_counter3r = m_parent->m_counterMax; }
-			}
-			// reverse sync
-			if( o2syncr )
-			{
-				if( O1L < m_osc1l_last ) { m_invert2l = !m_invert2l; m_counter2l = m_parent->m_counterMax; }
-				if( O1R < m_osc1r_last ) { m_invert2r = !m_invert2r; m_counter2r = m_parent->m_counterMax; }
-			}
-			if( o3syncr )
-			{
-				if( O1L < m_osc1l_last ) { m_invert3l = !m_invert3l; m_counter3l = m_parent->m_counterMax; }
-				if( O1R < m_osc1r_last ) { m_invert3r = !m_invert3r; m_counter3r = m_parent->m_counterMax; }
-			}
-		}
+		// check for rise/fall, remember edge for syncing
+		sync[f] = 0;
+		if( ( o1ssr && l > m_osc1l_last ) || ( o1ssf && l < m_osc1l_last ) ) sync[f] |= SYNC_L;
+		if( ( o1ssr && r > m_osc1r_last ) || ( o1ssf && r < m_osc1r_last ) ) sync[f] |= SYNC_R;
 
 		// update last before signal is touched
 		// also do a very simple amp delta cap
 		const sample_t tmpl = m_osc1l_last;
 		const sample_t tmpr = m_osc1r_last;
 
-		m_osc1l_last = O1L;
-		m_osc1r_last = O1R;
+		m_osc1l_last = l;
+		m_osc1r_last = r;
 
-		if( tmpl != O1L ) O1L = 0.0f;
-		if( tmpr != O1R ) O1R = 0.0f;
+		if( tmpl != l ) l = 0.0f;
+		if( tmpr != r ) r = 0.0f;
 
 		// modulate volume
-		O1L *= o1lv;
-		O1R *= o1rv;
+		l *= o1lv;
+		r *= o1rv;
 		if( o1v_mod )
 		{
-			modulatevol( O1L, o1v )
-			modulatevol( O1R, o1v )
+			l = qBound( -MODCLIP, l * o1v_m[f], MODCLIP );
+			r = qBound( -MODCLIP, r * o1v_m[f], MODCLIP );
 		}
+		O1L[f] = l;
+		O1R[f] = r;
 
-		// update osc1 phase working variable
-		o1l_p += 1.0f / ( static_cast<float>( m_parent->m_samplerate ) / o1l_f );
-		o1r_p += 1.0f / ( static_cast<float>( m_parent->m_samplerate ) / o1r_f );
+		// calc and mod frequencies, update osc1 phase working variable
+		if( o1f_mod )
+		{
+			o1l_p += qBound( MIN_FREQ, o1lfb * o1f_m[f], MAX_FREQ ) * isr;
+			o1r_p += qBound( MIN_FREQ, o1rfb * o1f_m[f], MAX_FREQ ) * isr;
+		}
+		else
+		{
+			o1l_p += o1lfb * isr;
+			o1r_p += o1rfb * isr;
+		}
+	}
 
-		/////////////////////////////
-		//				           //
-		//          OSC 2          //
-		//				           //
-		/////////////////////////////
+	/////////////////////////////
+	//				           //
+	//          OSC 2          //
+	//				           //
+	/////////////////////////////
 
-		// calc and mod frequencies
-		o2l_f = o2lfb;
-		o2r_f = o2rfb;
-		if( o2f_mod )
+	const bool o2synced = o2sync || o2syncr;
+	float o2_sign_l[ m_parent->m_fpp ];
+	float o2_sign_r[ m_parent->m_fpp ];
+	for( f_cnt_t f = 0; f < _frames; ++f )
+	{
+		// hard and reverse sync to osc1
+		if( o2synced && sync[f] )
 		{
-			modulatefreq( o2l_f, o2f )
-			modulatefreq( o2r_f, o2f )
+			if( sync[f] & SYNC_L )
+			{
+				if( o2sync ) o2l_p = o2lpo;
+				if( o2syncr ) m_invert2l = !m_invert2l;
+				m_counter2l = m_parent->m_counterMax;
+			}
+			if( sync[f] & SYNC_R )
+			{
+				if( o2sync ) o2r_p = o2rpo;
+				if( o2syncr ) m_invert2r = !m_invert2r;
+				m_counter2r = m_parent->m_counterMax;
+			}
 		}
 
 		// calc and modulate phase
@@ -490,8 +527,8 @@ void MonstroSynth::renderOutput( fpp_t _frames, sampleFrame * _buf  )
 		rightph = o2r_p;
 		if( o2p_mod )
 		{
-			modulatephs( leftph, o2p )
-			modulatephs( rightph, o2p )
+			leftph += o2p_m[f];
+			rightph += o2p_m[f];
 		}
 		leftph = absFraction( leftph );
 		rightph = absFraction( rightph );
@@ -503,60 +540,93 @@ void MonstroSynth::renderOutput( fpp_t _frames, sampleFrame * _buf  )
 		if( pd_r > 0.5 ) pd_r = 1.0 - pd_r;
 
 		// multi-wave DC Oscillator
-		len_l = BandLimitedWave::pdToLen( pd_l );
-		len_r = BandLimitedWave::pdToLen( pd_r );
-		if( m_counter2l > 0 ) { len_l /= m_counter2l; m_counter2l--; }
-		if( m_counter2r > 0 ) { len_r /= m_counter2r; m_counter2r--; }
-		sample_t O2L = oscillate( o2w, leftph, len_l );
-		sample_t O2R = oscillate( o2w, rightph, len_r );
-
-		// modulate volume
-		O2L *= o2lv;
-		O2R *= o2rv;
-		if( o2v_mod )
-		{
-			modulatevol( O2L, o2v )
-			modulatevol( O2R, o2v )
-		}
+		ph_l[f] = leftph;
+		ph_r[f] = rightph;
+		len_l[f] = BandLimitedWave::pdToLen( pd_l );
+		len_r[f] = BandLimitedWave::pdToLen( pd_r );
+		if( m_counter2l > 0 ) { len_l[f] /= m_counter2l; m_counter2l--; }
+		if( m_counter2r > 0 ) { len_r[f] /= m_counter2r; m_counter2r--; }
 
 		// reverse sync - invert waveforms when needed
-		if( m_invert2l ) O2L *= -1.0;
-		if( m_invert2r ) O2R *= -1.0;
+		o2_sign_l[f] = m_invert2l ? -1.0f : 1.0f;
+		o2_sign_r[f] = m_invert2r ? -1.0f : 1.0f;
 
 		// update osc2 phases
 		m_ph2l_last = leftph;
 		m_ph2r_last = rightph;
-		o2l_p += 1.0f / ( static_cast<float>( m_parent->m_samplerate ) / o2l_f );
-		o2r_p += 1.0f / ( static_cast<float>( m_parent->m_samplerate ) / o2r_f );
-
-		/////////////////////////////
-		//				           //
-		//          OSC 3          //
-		//				           //
-		/////////////////////////////
-
-		// calc and mod frequencies
-		o3l_f = o3fb;
-		o3r_f = o3fb;
-		if( o3f_mod )
+		if( o2f_mod )
 		{
-			modulatefreq( o3l_f, o3f )
-			modulatefreq( o3r_f, o3f )
+			o2l_p += qBound( MIN_FREQ, o2lfb * o2f_m[f], MAX_FREQ ) * isr;
+			o2r_p += qBound( MIN_FREQ, o2rfb * o2f_m[f], MAX_FREQ ) * isr;
 		}
+		else
+		{
+			o2l_p += o2lfb * isr;
+			o2r_p += o2rfb * isr;
+		}
+	}
+
+	oscillateBlock( o2w, ph_l, len_l, O2L, _frames );
+	oscillateBlock( o2w, ph_r, len_r, O2R, _frames );
+
+	// modulate volume, invert - the clipping range is symmetric, so
+	// inverting before clipping doesn't change anything
+	for( f_cnt_t f = 0; f < _frames; ++f )
+	{
+		O2L[f] *= o2lv * o2_sign_l[f];
+		O2R[f] *= o2rv * o2_sign_r[f];
+	}
+	if( o2v_mod )
+	{
+		for( f_cnt_t f = 0; f < _frames; ++f )
+		{
+			O2L[f] = qBound( -MODCLIP, O2L[f] * o2v_m[f], MODCLIP );
+			O2R[f] = qBound( -MODCLIP, O2R[f] * o2v_m[f], MODCLIP );
+		}
+	}
+
+	/////////////////////////////
+	//				           //
+	//          OSC 3          //
+	//				           //
+	/////////////////////////////
+
+	const bool o3synced = o3sync || o3syncr;
+	float o3_sign_l[ m_parent->m_fpp ];
+	float o3_sign_r[ m_parent->m_fpp ];
+	for( f_cnt_t f = 0; f < _frames; ++f )
+	{
+		// hard and reverse sync to osc1
+		if( o3synced && sync[f] )
+		{
+			if( sync[f] & SYNC_L )
+			{
+				if( o3sync ) o3l_p = o3lpo;
+				if( o3syncr ) m_invert3l = !m_invert3l;
+				m_counter3l = m_parent->m_counterMax;
+			}
+			if( sync[f] & SYNC_R )
+			{
+				if( o3sync ) o3r_p = o3rpo;
+				if( o3syncr ) m_invert3r = !m_invert3r;
+				m_counter3r = m_parent->m_counterMax;
+			}
+		}
+
 		// calc and modulate phase
 		leftph = o3l_p;
 		rightph = o3r_p;
 		if( o3p_mod )
 		{
-			modulatephs( leftph, o3p )
-			modulatephs( rightph, o3p )
+			leftph += o3p_m[f];
+			rightph += o3p_m[f];
 		}
 
 		// o2 modulation?
 		if( omod == MOD_PM )
 		{
-			leftph += O2L * 0.5f;
-			rightph += O2R * 0.5f;
+			leftph += O2L[f] * 0.5f;
+			rightph += O2R[f] * 0.5f;
 		}
 		leftph = absFraction( leftph );
 		rightph = absFraction( rightph );
@@ -568,65 +638,102 @@ void MonstroSynth::renderOutput( fpp_t _frames, sampleFrame * _buf  )
 		if( pd_r > 0.5 ) pd_r = 1.0 - pd_r;
 
 		// multi-wave DC Oscillator
-		len_l = BandLimitedWave::pdToLen( pd_l );
-		len_r = BandLimitedWave::pdToLen( pd_r );
-		if( m_counter3l > 0 ) { len_l /= m_counter3l; m_counter3l--; }
-		if( m_counter3r > 0 ) { len_r /= m_counter3r; m_counter3r--; }
-		//  sub-osc 1
-		sample_t O3AL = oscillate( o3w1, leftph, len_l );
-		sample_t O3AR = oscillate( o3w1, rightph, len_r );
-
-		// multi-wave DC Oscillator, sub-osc 2
-		sample_t O3BL = oscillate( o3w2, leftph, len_l );
-		sample_t O3BR = oscillate( o3w2, rightph, len_r );
+		ph_l[f] = leftph;
+		ph_r[f] = rightph;
+		len_l[f] = BandLimitedWave::pdToLen( pd_l );
+		len_r[f] = BandLimitedWave::pdToLen( pd_r );
+		if( m_counter3l > 0 ) { len_l[f] /= m_counter3l; m_counter3l--; }
+		if( m_counter3r > 0 ) { len_r[f] /= m_counter3r; m_counter3r--; }
 
-		// calc and modulate sub
-		sub = o3sub;
-		if( o3s_mod )
+		// reverse sync - invert waveforms when needed
+		o3_sign_l[f] = m_invert3l ? -1.0f : 1.0f;
+		o3_sign_r[f] = m_invert3r ? -1.0f : 1.0f;
+
+		// update osc3 phases
+		m_ph3l_last = leftph;
+		m_ph3r_last = rightph;
+		float inc_l;
+		float inc_r;
+		if( o3f_mod )
+		{
+			inc_l = qBound( MIN_FREQ, o3fb * o3f_m[f], MAX_FREQ ) * isr;
+			inc_r = inc_l;
+		}
+		else
 		{
-			modulateabs( sub, o3s )
-			sub = qBound( 0.0f, sub, 1.0f );
+			inc_l = inc_r = o3fb * isr;
 		}
+		// handle FM as PM
+		if( omod == MOD_FM )
+		{
+			inc_l += O2L[f] * m_parent->m_fmCorrection;
+			inc_r += O2R[f] * m_parent->m_fmCorrection;
+		}
+		o3l_p += inc_l;
+		o3r_p += inc_r;
+	}
+
+	// sub-osc 1 and 2 - skip a sub-osc that isn't audible at all and
+	// render identical ones only once
+	const bool o3a = o3s_mod || o3sub < 1.0f;
+	const bool o3b = o3s_mod || o3sub > 0.0f;
+	if( o3a )
+	{
+		oscillateBlock( o3w1, ph_l, len_l, O3L, _frames );
+		oscillateBlock( o3w1, ph_r, len_r, O3R, _frames );
+	}
+	if( o3b && !( o3a && o3w2 == o3w1 ) )
+	{
+		oscillateBlock( o3w2, ph_l, len_l, O3BL, _frames );
+		oscillateBlock( o3w2, ph_r, len_r, O3BR, _frames );
+	}
+	else
+	{
+		memcpy( O3BL, O3L, sizeof( sample_t ) * _frames );
+		memcpy( O3BR, O3R, sizeof( sample_t ) * _frames );
+	}
+	if( !o3a )
+	{
+		memcpy( O3L, O3BL, sizeof( sample_t ) * _frames );
+		memcpy( O3R, O3BR, sizeof( sample_t ) * _frames );
+	}
+
+	/////////////////////////////
+	//				           //
+	//           MIX           //
+	//				           //
+	/////////////////////////////
+
+	for( f_cnt_t f = 0; f < _frames; ++f )
+	{
+		// calc and modulate sub
+		const float sub = o3s_mod ? o3s_m[f] : o3sub;
 
-		sample_t O3L = linearInterpolate( O3AL, O3BL, sub );
-		sample_t O3R = linearInterpolate( O3AR, O3BR, sub );
+		sample_t o3l = linearInterpolate( O3L[f], O3BL[f], sub );
+		sample_t o3r = linearInterpolate( O3R[f], O3BR[f], sub );
 
 		// modulate volume
-		O3L *= o3lv;
-		O3R *= o3rv;
+		o3l *= o3lv;
+		o3r *= o3rv;
 		if( o3v_mod )
 		{
-			modulatevol( O3L, o3v )
-			modulatevol( O3R, o3v )
+			o3l = qBound( -MODCLIP, o3l * o3v_m[f], MODCLIP );
+			o3r = qBound( -MODCLIP, o3r * o3v_m[f], MODCLIP );
 		}
 		// o2 modulation?
 		if( omod == MOD_AM )
 		{
-			O3L = qBound( -MODCLIP, O3L * qMax( 0.0f, 1.0f + O2L ), MODCLIP );
-			O3R = qBound( -MODCLIP, O3R * qMax( 0.0f, 1.0f + O2R ), MODCLIP );
+			o3l = qBound( -MODCLIP, o3l * qMax( 0.0f, 1.0f + O2L[f] ), MODCLIP );
+			o3r = qBound( -MODCLIP, o3r * qMax( 0.0f, 1.0f + O2R[f] ), MODCLIP );
 		}
 
 		// reverse sync - invert waveforms when needed
-		if( m_invert3l ) O3L *= -1.0;
-		if( m_invert3r ) O3R *= -1.0;
-
-		// update osc3 phases
-		m_ph3l_last = leftph;
-		m_ph3r_last = rightph;
-		len_l = 1.0f / ( static_cast<float>( m_parent->m_samplerate ) / o3l_f );
-		len_r = 1.0f / ( static_cast<float>( m_parent->m_samplerate ) / o3r_f );
-		// handle FM as PM
-		if( omod == MOD_FM )
-		{
-			len_l += O2L * m_parent->m_fmCorrection;
-			len_r += O2R * m_parent->m_fmCorrection;
-		}
-		o3l_p += len_l;
-		o3r_p += len_r;
+		o3l *= o3_sign_l[f];
+		o3r *= o3_sign_r[f];
 
 		// integrator - very simple filter
-		sample_t L = O1L + O3L + ( omod == MOD_MIX ? O2L : 0.0f );
-		sample_t R = O1R + O3R + ( omod == MOD_MIX ? O2R : 0.0f );
+		sample_t L = O1L[f] + o3l + ( omod == MOD_MIX ? O2L[f] : 0.0f );
+		sample_t R = O1R[f] + o3r + ( omod == MOD_MIX ? O2R[f] : 0.0f );
 
 		_buf[f][0] = linearInterpolate( L, m_l_last, m_parent->m_integrator );
 		_buf[f][1] = linearInterpolate( R, m_r_last, m_parent->m_integrator );
@@ -1037,7 +1144,9 @@ void MonstroInstrument::playNote( NotePlayHandle * _n,
 
 	if ( _n->totalFramesPlayed() == 0 || _n->m_pluginData == NULL )
 	{
-		_n->m_pluginData = new MonstroSynth( this, _n );
+		MonstroSynth * ms = m_synths.acquire();
+		ms->reset( this, _n );
+		_n->m_pluginData = ms;
 	}
 
 	MonstroSynth * ms = static_cast<MonstroSynth *>( _n->m_pluginData );
@@ -1051,7 +1160,7 @@ void MonstroInstrument::playNote( NotePlayHandle * _n,
 
 void MonstroInstrument::deleteNotePluginData( NotePlayHandle * _n )
 {
-	delete static_cast<MonstroSynth *>( _n->m_pluginData );
+	m_synths.release( static_cast<MonstroSynth *>( _n->m_pluginData ) );
 }
 
 
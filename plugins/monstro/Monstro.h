@@ -38,6 +38,7 @@
 #include "Oscillator.h"
 #include "lmms_math.h"
 #include "BandLimitedWave.h"
+#include "VoicePool.h"
 
 //
 //	UI Macros
@@ -160,9 +161,12 @@ class MonstroSynth
 {
 	MM_OPERATORS
 public:
-	MonstroSynth( MonstroInstrument * _i, NotePlayHandle * _nph );
+	MonstroSynth();
 	virtual ~MonstroSynth();
 
+	// prepares a new or recycled synth for playing the given note
+	void reset( MonstroInstrument * _i, NotePlayHandle * _nph );
+
 	void renderOutput( fpp_t _frames, sampleFrame * _buf );
 
 private:
@@ -253,6 +257,19 @@ private:
 		return 0.0;
 	}
 
+	// with the waveform known at compile time the switch in oscillate()
+	// is resolved once per block instead of once per sample
+	template<int WAVE>
+	inline void oscillateWave( const float * _ph, const float * _len, sample_t * _out, fpp_t _frames )
+	{
+		for( fpp_t f = 0; f < _frames; ++f )
+		{
+			_out[f] = oscillate( WAVE, _ph[f], _len[f] );
+		}
+	}
+
+	void oscillateBlock( int _wave, const float * _ph, const float * _len, sample_t * _out, fpp_t _frames );
+
 
 	float m_osc1l_phase;
 	float m_osc1r_phase;
@@ -559,6 +576,8 @@ private:
 	FloatModel	m_sub3lfo1;
 	FloatModel	m_sub3lfo2;
 
+	VoicePool<MonstroSynth> m_synths;
+
 	friend class MonstroSynth;
 	friend class MonstroView;
 
@@ -82,8 +82,6 @@ typedef struct fm_opl_channel {
 	OPL_SLOT SLOT[2];
 	UINT8 CON;			/* connection type                     */
 	UINT8 FB;			/* feed back       :(shift down bit)   */
-	INT32 *connect1;	/* slot1 output pointer                */
-	INT32 *connect2;	/* slot2 output pointer                */
 	INT32 op1_out[2];	/* slot1 output for selfeedback        */
 	/* phase generator state */
 	UINT32  block_fnum;	/* block+fnum      :                   */
@@ -136,6 +134,10 @@ typedef struct fm_opl_f {
 	INT32 amsIncr;
 	INT32 vibCnt;
 	INT32 vibIncr;
+	/* working state while updating */
+	INT32 ams;			/* current AM depth            */
+	INT32 vib;			/* current vibrato depth       */
+	INT32 outd[1];		/* output of the current sample */
 	/* wave selector enable flag */
 	UINT8 wavesel;
 	/* external event callback handler */
@@ -84,10 +84,6 @@ Plugin * PLUGIN_EXPORT lmms_plugin_main( Model *, void * _data )
 
 }
 
-// I'd much rather do without a mutex, but it looks like
-// the emulator code isn't really ready for threads
-QMutex opl2instrument::emulatorMutex;
-
 // Weird ordering of voice parameters
 const unsigned int adlib_opadd[OPL2_VOICES] = {0x00, 0x01, 0x02, 0x08, 0x09, 0x0A, 0x10, 0x11, 0x12};
 
@@ -136,12 +132,10 @@ opl2instrument::opl2instrument( InstrumentTrack * _instrument_track ) :
 {
 
 	// Create an emulator - samplerate, 16 bit, mono
-	emulatorMutex.lock();
 	theEmulator = new CTemuopl(Engine::mixer()->processingSampleRate(), true, false);
 	theEmulator->init();
 	// Enable waveform selection
 	theEmulator->write(0x01,0x20);
-	emulatorMutex.unlock();
 
 	//Initialize voice values
 	// voiceNote[0] = 0;
@@ -217,17 +211,17 @@ opl2instrument::opl2instrument( InstrumentTrack * _instrument_track ) :
 }
 
 opl2instrument::~opl2instrument() {
-	delete theEmulator;
 	Engine::mixer()->removePlayHandlesOfTypes( instrumentTrack(),
 				PlayHandle::TypeNotePlayHandle
 				| PlayHandle::TypeInstrumentPlayHandle );
+	delete theEmulator;
 	delete [] renderbuffer;
 }
 
 // Samplerate changes when choosing oversampling, so this is more or less mandatory
 void opl2instrument::reloadEmulator() {
-	delete theEmulator;
 	emulatorMutex.lock();
+	delete theEmulator;
 	theEmulator = new CTemuopl(Engine::mixer()->processingSampleRate(), true, false);
 	theEmulator->init();
 	theEmulator->write(0x01,0x20);
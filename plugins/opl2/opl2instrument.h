@@ -133,7 +133,10 @@ private:
 	int pushVoice(int v);
 
 	int Hz2fnum(float Hz);
-	static QMutex emulatorMutex;
+	// serializes MIDI events, patch changes and rendering of this instance -
+	// the emulator keeps all of its state in its own FM_OPL, so instances
+	// don't share anything while rendering
+	QMutex emulatorMutex;
 	void setVoiceVelocity(int voice, int vel);
 
 	// Pitch bend range comes through RPNs.
@@ -63,7 +63,9 @@ long Basic_Gb_Apu::read_samples( sample_t* out, long count )
 
 void Basic_Gb_Apu::reset()
 {
+	time = 0;
 	apu.reset();
+	buf.clear();
 }
 
 void Basic_Gb_Apu::treble_eq( const blip_eq_t& eq )
@@ -18,6 +18,7 @@ public:
 
 	// Set output sample rate
 	blargg_err_t set_sample_rate( long rate );
+	long sample_rate() const { return buf.sample_rate(); }
 
 	// Pass reads and writes in the range 0xff10-0xff3f
 	void write_register( blip_time_t, int data );
@@ -37,6 +38,7 @@ public:
 	long read_samples( sample_t* out, long count );
 
 	//added by 589 --->
+	// Reset the APU and drop any samples still waiting in the buffer
 	void reset();
 	void treble_eq( const blip_eq_t& eq );
 	void bass_freq( int bf );
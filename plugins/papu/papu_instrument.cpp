@@ -114,6 +114,12 @@ papuInstrument::papuInstrument( InstrumentTrack * _instrument_track ) :
 
 	m_graphModel( 0, 15, 32, this, false, 1 )
 {
+	// allocate the blip buffers now rather than with the first notes
+	const long samplerate = Engine::mixer()->processingSampleRate();
+	m_apus.prepare( [samplerate]( Basic_Gb_Apu & _apu )
+	{
+		_apu.set_sample_rate( samplerate );
+	} );
 }
 
 
@@ -248,8 +254,14 @@ void papuInstrument::playNote( NotePlayHandle * _n,
 
 	if ( tfp == 0 )
 	{
-		Basic_Gb_Apu *papu = new Basic_Gb_Apu();
-		papu->set_sample_rate( samplerate );
+		// recycled APUs keep their buffers unless the sample rate
+		// has changed
+		Basic_Gb_Apu *papu = m_apus.acquire();
+		if( papu->sample_rate() != samplerate )
+		{
+			papu->set_sample_rate( samplerate );
+		}
+		papu->reset();
 
 		// Master sound circuitry power control
 		papu->write_register( 0xff26, 0x80 );
@@ -416,7 +428,7 @@ void papuInstrument::playNote( NotePlayHandle * _n,
 
 void papuInstrument::deleteNotePluginData( NotePlayHandle * _n )
 {
-	delete static_cast<Basic_Gb_Apu *>( _n->m_pluginData );
+	m_apus.release( static_cast<Basic_Gb_Apu *>( _n->m_pluginData ) );
 }
 
 
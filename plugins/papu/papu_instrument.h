@@ -31,8 +31,10 @@
 #include "InstrumentView.h"
 #include "Knob.h"
 #include "Graph.h"
+#include "VoicePool.h"
 
 class papuInstrumentView;
+class Basic_Gb_Apu;
 class NotePlayHandle;
 class PixmapButton;
 
@@ -102,6 +104,8 @@ private:
 
 	graphModel  m_graphModel;
 
+	VoicePool<Basic_Gb_Apu> m_apus;
+
 	friend class papuInstrumentView;
 } ;
 
@@ -33,6 +33,7 @@
 #include "Engine.h"
 #include "gui_templates.h"
 #include "InstrumentTrack.h"
+#include "Mixer.h"
 #include "NotePlayHandle.h"
 #include "PixmapButton.h"
 #include "Song.h"
@@ -78,6 +79,7 @@ Plugin * PLUGIN_EXPORT lmms_plugin_main( Model *, void * _data )
 patmanInstrument::patmanInstrument( InstrumentTrack * _instrument_track ) :
 	Instrument( _instrument_track, &patman_plugin_descriptor ),
 	m_patchFile( QString::null ),
+	m_patchSamples( new QVector<SampleBuffer *> ),
 	m_loopedModel( true, this ),
 	m_tunedModel( true, this )
 {
@@ -88,7 +90,7 @@ patmanInstrument::patmanInstrument( InstrumentTrack * _instrument_track ) :
 
 patmanInstrument::~patmanInstrument()
 {
-	unloadCurrentPatch();
+	freePatch( m_patchSamples.loadAcquire() );
 }
 
 
@@ -199,12 +201,18 @@ void patmanInstrument::setFile( const QString & _patch_file, bool _rename )
 	// named it self
 
 	m_patchFile = SampleBuffer::tryToMakeRelative( _patch_file );
-	LoadErrors error = loadPatch( SampleBuffer::tryToMakeAbsolute( _patch_file ) );
+	QVector<SampleBuffer *> * samples = new QVector<SampleBuffer *>;
+	LoadErrors error = loadPatch( SampleBuffer::tryToMakeAbsolute( _patch_file ), *samples );
 	if( error )
 	{
 		printf("Load error\n");
 	}
 
+	// notes started from now on pick the new samples, the old ones are
+	// released once the mixer is done with the current period
+	Engine::mixer()->retire( m_patchSamples.fetchAndStoreOrdered( samples ),
+								&freePatch );
+
 	emit fileChanged();
 }
 
@@ -212,10 +220,9 @@ void patmanInstrument::setFile( const QString & _patch_file, bool _rename )
 
 
 patmanInstrument::LoadErrors patmanInstrument::loadPatch(
-						const QString & _filename )
+						const QString & _filename,
+					QVector<SampleBuffer *> & _samples )
 {
-	unloadCurrentPatch();
-
 	FILE * fd = fopen( _filename.toUtf8().constData() , "rb" );
 	if( !fd )
 	{
@@ -366,7 +373,7 @@ patmanInstrument::LoadErrors patmanInstrument::loadPatch(
 			psample->setLoopEndFrame( loop_end );
 		}
 
-		m_patchSamples.push_back( psample );
+		_samples.push_back( psample );
 
 		delete[] wave_samples;
 		delete[] data;
@@ -378,18 +385,29 @@ patmanInstrument::LoadErrors patmanInstrument::loadPatch(
 
 
 
-void patmanInstrument::unloadCurrentPatch( void )
+void patmanInstrument::unloadPatch( QVector<SampleBuffer *> & _samples )
 {
-	while( !m_patchSamples.empty() )
+	while( !_samples.empty() )
 	{
-		sharedObject::unref( m_patchSamples.back() );
-		m_patchSamples.pop_back();
+		sharedObject::unref( _samples.back() );
+		_samples.pop_back();
 	}
 }
 
 
 
 
+void patmanInstrument::freePatch( void * _samples )
+{
+	QVector<SampleBuffer *> * samples =
+			static_cast<QVector<SampleBuffer *> *>( _samples );
+	unloadPatch( *samples );
+	delete samples;
+}
+
+
+
+
 void patmanInstrument::selectSample( NotePlayHandle * _n )
 {
 	const float freq = _n->frequency();
@@ -397,7 +415,8 @@ void patmanInstrument::selectSample( NotePlayHandle * _n )
 	float min_dist = HUGE_VALF;
 	SampleBuffer* sample = NULL;
 
-	for( QVector<SampleBuffer *>::iterator it = m_patchSamples.begin(); it != m_patchSamples.end(); ++it )
+	const QVector<SampleBuffer *> * samples = m_patchSamples.loadAcquire();
+	for( QVector<SampleBuffer *>::const_iterator it = samples->begin(); it != samples->end(); ++it )
 	{
 		float patch_freq = ( *it )->frequency();
 		float dist = freq >= patch_freq ? freq / patch_freq :
@@ -86,7 +86,10 @@ private:
 	} handle_data;
 
 	QString m_patchFile;
-	QVector<SampleBuffer *> m_patchSamples;
+	// the samples of the current patch - setFile() publishes a new list
+	// instead of changing this one and retires the old list through the
+	// mixer, so playNote() can use it without locking
+	QAtomicPointer<QVector<SampleBuffer *> > m_patchSamples;
 	BoolModel m_loopedModel;
 	BoolModel m_tunedModel;
 
@@ -101,8 +104,12 @@ private:
 		LoadIO
 	} ;
 
-	LoadErrors loadPatch( const QString & _filename );
-	void unloadCurrentPatch( void );
+	// loads the samples of a patch into _samples, which may hold the ones
+	// read so far when an error is returned
+	LoadErrors loadPatch( const QString & _filename,
+					QVector<SampleBuffer *> & _samples );
+	static void unloadPatch( QVector<SampleBuffer *> & _samples );
+	static void freePatch( void * _samples );
 
 	void selectSample( NotePlayHandle * _n );
 
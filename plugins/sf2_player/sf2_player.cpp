@@ -28,6 +28,7 @@
 #include <QLabel>
 #include <QDomDocument>
 
+#include "BatchRenderer.h"
 #include "ConfigManager.h"
 #include "FileDialog.h"
 #include "sf2_player.h"
@@ -300,6 +301,25 @@ void sf2Instrument::freeFont()
 
 
 
+void sf2Instrument::releaseFont( void * font )
+{
+	sf2Font * f = static_cast<sf2Font *>( font );
+
+	s_fontsMutex.lock();
+	--(f->refCount);
+
+	// no synth has the font anymore, so it has to be freed here
+	if( f->refCount <= 0 )
+	{
+		s_fonts.remove( s_fonts.key( f ) );
+		f->fluidFont->free( f->fluidFont );
+		delete f;
+	}
+	s_fontsMutex.unlock();
+}
+
+
+
 void sf2Instrument::openFile( const QString & _sf2File, bool updateTrackName )
 {
 	emit fileLoading();
@@ -336,6 +356,14 @@ void sf2Instrument::openFile( const QString & _sf2File, bool updateTrackName )
 			// Grab this sf from the top of the stack and add to list
 			m_font = new sf2Font( fluid_synth_get_sfont( m_synth, 0 ) );
 			s_fonts.insert( relativePath, m_font );
+
+			// keep the font loaded for the following jobs of a
+			// batch, most of which use the same few fonts
+			if( BatchRenderer::isRunning() )
+			{
+				m_font->refCount++;
+				BatchRenderer::keepLoaded( m_font, &releaseFont );
+			}
 		}
 		else
 		{
@@ -111,6 +111,9 @@ private:
 	static QMap<QString, sf2Font*> s_fonts;
 	static int (* s_origFree)( fluid_sfont_t * );
 
+	// drops the reference a batch render keeps to a font
+	static void releaseFont( void * font );
+
 	SRC_STATE * m_srcState;
 
 	fluid_settings_t* m_settings;
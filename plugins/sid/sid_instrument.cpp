@@ -29,6 +29,7 @@
 
 #include <cmath>
 #include <cstdio>
+#include <cstring>
 
 #include "sid.h"
 
@@ -68,6 +69,22 @@ static const int relTime[16] = { 6, 24, 48, 72, 114, 168, 204, 240, 300, 750,
 								1500, 2400, 3000, 9000, 15000, 24000 };
 
 
+// an emulated chip along with the register values last written to it
+class sidChip
+{
+	MM_OPERATORS
+public:
+	sidChip() :
+		sampleRate( 0 )
+	{
+	}
+
+	cSID sid;
+	unsigned char regs[NUMSIDREGS];
+	int sampleRate;
+} ;
+
+
 extern "C"
 {
 Plugin::Descriptor PLUGIN_EXPORT sid_plugin_descriptor =
@@ -134,6 +151,15 @@ sidInstrument::sidInstrument( InstrumentTrack * _instrument_track ) :
 	{
 		m_voice[i] = new voiceObject( this, i );
 	}
+
+	// set up the chips' resampling now rather than with the first notes
+	const int samplerate = Engine::mixer()->processingSampleRate();
+	m_chips.prepare( [samplerate]( sidChip & _chip )
+	{
+		_chip.sid.set_sampling_parameters( C64_PAL_CYCLES_PER_SEC,
+						SAMPLE_FAST, samplerate );
+		_chip.sampleRate = samplerate;
+	} );
 }
 
 
@@ -246,7 +272,9 @@ f_cnt_t sidInstrument::desiredReleaseFrames() const
 
 
 
-static int sid_fillbuffer(unsigned char* sidreg, cSID *sid, int tdelta, short *ptr, int samples)
+// registers that still hold the value to be written are skipped along with
+// their write delay, so a period without changes is clocked in one go
+static int sid_fillbuffer(unsigned char* sidreg, unsigned char* oldreg, cSID *sid, int tdelta, short *ptr, int samples)
 {
   int tdelta2;
   int result;
@@ -261,6 +289,12 @@ static int sid_fillbuffer(unsigned char* sidreg, cSID *sid, int tdelta, short *p
   {
     unsigned char o = sidorder[c];
 
+    if (sidreg[o] == oldreg[o])
+    {
+      continue;
+    }
+    oldreg[o] = sidreg[o];
+
   	// Extra delay for loading the waveform (and mt_chngate,x)
   	if ((o == 4) || (o == 11) || (o == 18))
   	{
@@ -311,17 +345,24 @@ void sidInstrument::playNote( NotePlayHandle * _n,
 
 	if ( tfp == 0 )
 	{
-		cSID *sid = new cSID();
-		sid->set_sampling_parameters( clockrate, SAMPLE_FAST, samplerate );
-		sid->set_chip_model( MOS8580 );
-		sid->enable_filter( true );
-		sid->reset();
-		_n->m_pluginData = sid;
+		sidChip * chip = m_chips.acquire();
+		if( chip->sampleRate != samplerate )
+		{
+			chip->sid.set_sampling_parameters( clockrate, SAMPLE_FAST, samplerate );
+			chip->sampleRate = samplerate;
+		}
+		chip->sid.set_chip_model( MOS8580 );
+		chip->sid.enable_filter( true );
+		chip->sid.reset();
+		// all registers are cleared by reset()
+		memset( chip->regs, 0, sizeof( chip->regs ) );
+		_n->m_pluginData = chip;
 	}
 	const fpp_t frames = _n->framesLeftForCurrentPeriod();
 	const f_cnt_t offset = _n->noteOffset();
 
-	cSID *sid = static_cast<cSID *>( _n->m_pluginData );
+	sidChip * chip = static_cast<sidChip *>( _n->m_pluginData );
+	cSID *sid = &chip->sid;
 	int delta_t = clockrate * frames / samplerate + 4;
 	short buf[frames];
 	unsigned char sidreg[NUMSIDREGS];
@@ -424,7 +465,7 @@ void sidInstrument::playNote( NotePlayHandle * _n,
 
 	sidreg[24] = data8&0x00FF;
 		
-	int num = sid_fillbuffer(sidreg, sid,delta_t,buf, frames);
+	int num = sid_fillbuffer(sidreg, chip->regs, sid,delta_t,buf, frames);
 	if(num!=frames)
 		printf("!!!Not enough samples\n");
 
@@ -445,7 +486,7 @@ void sidInstrument::playNote( NotePlayHandle * _n,
 
 void sidInstrument::deleteNotePluginData( NotePlayHandle * _n )
 {
-	delete static_cast<cSID *>( _n->m_pluginData );
+	m_chips.release( static_cast<sidChip *>( _n->m_pluginData ) );
 }
 
 
@@ -31,9 +31,11 @@
 #include "Instrument.h"
 #include "InstrumentView.h"
 #include "Knob.h"
+#include "VoicePool.h"
 
 
 class sidInstrumentView;
+class sidChip;
 class NotePlayHandle;
 class automatableButtonGroup;
 class PixmapButton;
@@ -126,6 +128,10 @@ private:
 
 	IntModel m_chipModel;
 
+	// notes get their emulated chip from a pool so that playing a note
+	// doesn't have to allocate one every time
+	VoicePool<sidChip> m_chips;
+
 	friend class sidInstrumentView;
 
 } ;
@@ -28,6 +28,7 @@
 
 #include <QDir>
 #include <QMessageBox>
+#include <QMutex>
 
 #include "BandedWG.h"
 #include "ModalBar.h"
@@ -120,6 +121,12 @@ malletsInstrument::malletsInstrument( InstrumentTrack * _instrument_track ):
 	m_scalers.append( 16.0 );
 	m_presetsModel.addItem( tr( "Tibetan Bowl" ) );
 	m_scalers.append( 7.0 );
+
+	// create the STK voices now rather than with the first notes
+	updateSampleRate();
+
+	connect( Engine::mixer(), SIGNAL( sampleRateChanged() ),
+					this, SLOT( updateSampleRate() ) );
 }
 
 
@@ -295,12 +302,10 @@ void malletsInstrument::playNote( NotePlayHandle * _n,
 			m_isOldVersionModel.value() ? 100.0 : 200.0;
 		const float vel = _n->getVolume() / velocityAdjust;
 
-		// critical section as STK is not thread-safe
-		static QMutex m;
-		m.lock();
+		malletsSynth * ps = m_synths.acquire();
 		if( p < 9 )
 		{
-			_n->m_pluginData = new malletsSynth( freq,
+			ps->resetModalBar( freq,
 						vel,
 						m_stickModel.value(),
 						m_hardnessModel.value(),
@@ -313,7 +318,7 @@ void malletsInstrument::playNote( NotePlayHandle * _n,
 		}
 		else if( p == 9 )
 		{
-			_n->m_pluginData = new malletsSynth( freq,
+			ps->resetTubeBell( freq,
 						vel,
 						p,
 						m_lfoDepthModel.value(),
@@ -326,7 +331,7 @@ void malletsInstrument::playNote( NotePlayHandle * _n,
 		}
 		else
 		{
-			_n->m_pluginData = new malletsSynth( freq,
+			ps->resetBandedWG( freq,
 						vel,
 						m_pressureModel.value(),
 						m_motionModel.value(),
@@ -337,7 +342,7 @@ void malletsInstrument::playNote( NotePlayHandle * _n,
 						(uint8_t) m_spreadModel.value(),
 				Engine::mixer()->processingSampleRate() );
 		}
-		m.unlock();
+		_n->m_pluginData = ps;
 	}
 
 	const fpp_t frames = _n->framesLeftForCurrentPeriod();
@@ -368,7 +373,7 @@ void malletsInstrument::playNote( NotePlayHandle * _n,
 
 void malletsInstrument::deleteNotePluginData( NotePlayHandle * _n )
 {
-	delete static_cast<malletsSynth *>( _n->m_pluginData );
+	m_synths.release( static_cast<malletsSynth *>( _n->m_pluginData ) );
 }
 
 
@@ -382,6 +387,26 @@ PluginView * malletsInstrument::instantiateView( QWidget * _parent )
 
 
 
+// the mixer doesn't process while emitting sampleRateChanged(), so no synth
+// is being played here
+void malletsInstrument::updateSampleRate()
+{
+	if( m_filesMissing )
+	{
+		return;
+	}
+
+	const sample_rate_t samplerate =
+				Engine::mixer()->processingSampleRate();
+	m_synths.prepare( [samplerate]( malletsSynth & _synth )
+	{
+		_synth.prepare( samplerate );
+	} );
+}
+
+
+
+
 malletsInstrumentView::malletsInstrumentView( malletsInstrument * _instrument,
 							QWidget * _parent ) :
 	InstrumentView( _instrument, _parent )
@@ -604,8 +629,101 @@ void malletsInstrumentView::changePreset()
 
 
 
+// critical section as STK is not thread-safe - only needed while creating
+// voices, recycled ones are set up without locking
+static QMutex s_stkMutex;
+
+
+malletsSynth::malletsSynth() :
+	m_voice( NULL ),
+	m_sampleRate( 0 ),
+	m_delayRead( 0 ),
+	m_delayWrite( 0 )
+{
+	for( int i = 0; i < NumVoiceTypes; ++i )
+	{
+		m_voices[i] = NULL;
+	}
+	m_delay = new StkFloat[256];
+}
+
+
+
+
+// has to be called with s_stkMutex held
+static void setupStk( const sample_rate_t _sample_rate )
+{
+	Stk::setSampleRate( _sample_rate );
+	Stk::setRawwavePath( QDir( ConfigManager::inst()->stkDir() ).absolutePath()
+					.toLatin1().constData() );
+#ifndef LMMS_DEBUG
+	Stk::showWarnings( false );
+#endif
+}
+
+
+
+
+void malletsSynth::prepare( const sample_rate_t _sample_rate )
+{
+	m_voice = NULL;
+	for( int i = 0; i < NumVoiceTypes; ++i )
+	{
+		delete m_voices[i];
+		m_voices[i] = NULL;
+	}
+	m_sampleRate = _sample_rate;
+
+	QMutexLocker locker( &s_stkMutex );
+	setupStk( _sample_rate );
+	try
+	{
+		m_voices[ModalBarVoice] = new ModalBar();
+		m_voices[TubeBellVoice] = new TubeBell();
+		m_voices[BandedWGVoice] = new BandedWG();
+	}
+	catch( ... )
+	{
+		// voices that couldn't be created stay NULL and their notes
+		// silent
+	}
+}
+
+
+
+
+Instrmnt * malletsSynth::selectVoice( VoiceTypes _type,
+					const sample_rate_t _sample_rate )
+{
+	if( m_sampleRate != _sample_rate )
+	{
+		// only synths created after the voice pool ran out end up
+		// here, the pooled ones have been prepared already
+		prepare( _sample_rate );
+	}
+
+	m_voice = m_voices[_type];
+	return m_voice;
+}
+
+
+
+
+void malletsSynth::resetDelay( const uint8_t _delay )
+{
+	m_delayRead = 0;
+	m_delayWrite = _delay;
+	for( int i = 0; i < 256; i++ )
+	{
+		m_delay[i] = 0.0;
+	}
+}
+
+
+
+
 // ModalBar
-malletsSynth::malletsSynth( const StkFloat _pitch,
+void malletsSynth::resetModalBar( const StkFloat _pitch,
 				const StkFloat _velocity,
 				const StkFloat _control1,
 				const StkFloat _control2,
@@ -618,14 +736,12 @@ malletsSynth::malletsSynth( const StkFloat _pitch,
 {
 	try
 	{
-		Stk::setSampleRate( _sample_rate );
-		Stk::setRawwavePath( QDir( ConfigManager::inst()->stkDir() ).absolutePath()
-						.toLatin1().constData() );
-#ifndef LMMS_DEBUG
-		Stk::showWarnings( false );
-#endif
-
-		m_voice = new ModalBar();
+		if( selectVoice( ModalBarVoice, _sample_rate ) == NULL )
+		{
+			resetDelay( _delay );
+			return;
+		}
+		static_cast<ModalBar *>( m_voice )->clear();
 	
 		m_voice->controlChange( 16, _control16 );
 		m_voice->controlChange( 1, _control1 );
@@ -642,20 +758,14 @@ malletsSynth::malletsSynth( const StkFloat _pitch,
 		m_voice = NULL;
 	}
 	
-	m_delay = new StkFloat[256];
-	m_delayRead = 0;
-	m_delayWrite = _delay;
-	for( int i = 0; i < 256; i++ )
-	{
-		m_delay[i] = 0.0;
-	}
+	resetDelay( _delay );
 }
 
 
 
 
 // TubeBell
-malletsSynth::malletsSynth( const StkFloat _pitch,
+void malletsSynth::resetTubeBell( const StkFloat _pitch,
 				const StkFloat _velocity,
 				const int _preset,
 				const StkFloat _control1,
@@ -668,14 +778,13 @@ malletsSynth::malletsSynth( const StkFloat _pitch,
 {
 	try
 	{
-		Stk::setSampleRate( _sample_rate );
-		Stk::setRawwavePath( QDir( ConfigManager::inst()->stkDir() ).absolutePath()
-						.toLatin1().constData() );
-#ifndef LMMS_DEBUG
-		Stk::showWarnings( false );
-#endif
-
-		m_voice = new TubeBell();
+		// FM voices have no internal state that would need to be
+		// cleared, noteOn() restarts their envelopes
+		if( selectVoice( TubeBellVoice, _sample_rate ) == NULL )
+		{
+			resetDelay( _delay );
+			return;
+		}
 	
 		m_voice->controlChange( 1, _control1 );
 		m_voice->controlChange( 2, _control2 );
@@ -690,20 +799,14 @@ malletsSynth::malletsSynth( const StkFloat _pitch,
 		m_voice = NULL;
 	}
 	
-	m_delay = new StkFloat[256];
-	m_delayRead = 0;
-	m_delayWrite = _delay;
-	for( int i = 0; i < 256; i++ )
-	{
-		m_delay[i] = 0.0;
-	}
+	resetDelay( _delay );
 }
 
 
 
 
 // BandedWG
-malletsSynth::malletsSynth( const StkFloat _pitch,
+void malletsSynth::resetBandedWG( const StkFloat _pitch,
 				const StkFloat _velocity,
 				const StkFloat _control2,
 				const StkFloat _control4,
@@ -716,14 +819,12 @@ malletsSynth::malletsSynth( const StkFloat _pitch,
 {
 	try
 	{
-		Stk::setSampleRate( _sample_rate );
-		Stk::setRawwavePath( QDir( ConfigManager::inst()->stkDir() ).absolutePath()
-						.toLatin1().constData() );
-#ifndef LMMS_DEBUG
-		Stk::showWarnings( false );
-#endif
-
-		m_voice = new BandedWG();
+		if( selectVoice( BandedWGVoice, _sample_rate ) == NULL )
+		{
+			resetDelay( _delay );
+			return;
+		}
+		static_cast<BandedWG *>( m_voice )->clear();
 	
 		m_voice->controlChange( 1, 128.0 );
 		m_voice->controlChange( 2, _control2 );
@@ -740,13 +841,7 @@ malletsSynth::malletsSynth( const StkFloat _pitch,
 		m_voice = NULL;
 	}
 	
-	m_delay = new StkFloat[256];
-	m_delayRead = 0;
-	m_delayWrite = _delay;
-	for( int i = 0; i < 256; i++ )
-	{
-		m_delay[i] = 0.0;
-	}
+	resetDelay( _delay );
 }
 
 
@@ -35,6 +35,7 @@
 #include "Knob.h"
 #include "NotePlayHandle.h"
 #include "LedCheckbox.h"
+#include "VoicePool.h"
 
 // As of Stk 4.4 all classes and types have been moved to the namespace "stk".
 // However in older versions this namespace does not exist, therefore declare it
@@ -47,8 +48,32 @@ static const int MALLETS_PRESET_VERSION = 1;
 class malletsSynth
 {
 public:
+	malletsSynth();
+
+	inline ~malletsSynth()
+	{
+		if( m_voice )
+		{
+			m_voice->noteOff( 0.0 );
+		}
+		delete[] m_delay;
+		for( int i = 0; i < NumVoiceTypes; ++i )
+		{
+			delete m_voices[i];
+		}
+	}
+
+	// creates one STK voice of each kind for the given sample rate so
+	// that starting a note doesn't allocate anything - must not be called
+	// while the synth is being played
+	void prepare( const sample_rate_t _sample_rate );
+
+	// the following functions start a new note by clearing and reusing
+	// the prepared voice of the respective kind - synths that haven't
+	// been prepared for the given sample rate get prepared first
+
 	// ModalBar
-	malletsSynth( const StkFloat _pitch,
+	void resetModalBar( const StkFloat _pitch,
 			const StkFloat _velocity,
 			const StkFloat _control1,
 			const StkFloat _control2,
@@ -60,7 +85,7 @@ public:
 			const sample_rate_t _sample_rate );
 
 	// TubeBell
-	malletsSynth( const StkFloat _pitch,
+	void resetTubeBell( const StkFloat _pitch,
 			const StkFloat _velocity,
 			const int _preset,
 			const StkFloat _control1,
@@ -72,7 +97,7 @@ public:
 			const sample_rate_t _sample_rate );
 
 	// BandedWG
-	malletsSynth( const StkFloat _pitch,
+	void resetBandedWG( const StkFloat _pitch,
 			const StkFloat _velocity,
 			const StkFloat _control2,
 			const StkFloat _control4,
@@ -83,13 +108,6 @@ public:
 			const uint8_t _delay,
 			const sample_rate_t _sample_rate );
 
-	inline ~malletsSynth()
-	{
-		m_voice->noteOff( 0.0 );
-		delete[] m_delay;
-		delete m_voice;
-	}
-
 	inline sample_t nextSampleLeft()
 	{
 		if( m_voice == NULL )
@@ -122,7 +140,23 @@ public:
 
 
 protected:
+	enum VoiceTypes
+	{
+		ModalBarVoice,
+		TubeBellVoice,
+		BandedWGVoice,
+		NumVoiceTypes
+	} ;
+
+	// makes the prepared voice of the given type the current one and
+	// returns it, NULL if it couldn't be created
+	Instrmnt * selectVoice( VoiceTypes _type,
+					const sample_rate_t _sample_rate );
+	void resetDelay( const uint8_t _delay );
+
+	Instrmnt * m_voices[NumVoiceTypes];
 	Instrmnt * m_voice;
+	sample_rate_t m_sampleRate;
 
 	StkFloat * m_delay;
 	uint8_t m_delayRead;
@@ -152,6 +186,10 @@ public:
 	virtual PluginView * instantiateView( QWidget * _parent );
 
 
+private slots:
+	void updateSampleRate();
+
+
 private:
 	FloatModel m_hardnessModel;
 	FloatModel m_positionModel;
@@ -181,6 +219,7 @@ private:
 
 	bool m_filesMissing;
 
+	VoicePool<malletsSynth> m_synths;
 
 	friend class malletsInstrumentView;
 
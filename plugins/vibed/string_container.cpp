@@ -25,16 +25,18 @@
 #include "string_container.h"
 
 
-stringContainer::stringContainer(const float _pitch, 
-				const sample_rate_t _sample_rate,
-				const int _buffer_length,
-				const int _strings ) :
-	m_pitch( _pitch ),
-	m_sampleRate( _sample_rate ),
-	m_bufferLength( _buffer_length )
+stringContainer::stringContainer( const int _strings ) :
+	m_stringsUsed( 0 ),
+	m_pitch( 0 ),
+	m_sampleRate( 0 ),
+	m_bufferLength( 0 )
 {
+	// create all strings up front, containers of the instrument's
+	// voice pool are constructed on the GUI thread
+	m_strings.reserve( _strings );
 	for( int i = 0; i < _strings; i++ )
 	{
+		m_strings.append( new vibratingString );
 		m_exists.append( false );
 	}
 }
@@ -42,6 +44,23 @@ stringContainer::stringContainer(const float _pitch,
 
 
 
+void stringContainer::reset( const float _pitch,
+				const sample_rate_t _sample_rate,
+				const int _buffer_length )
+{
+	m_pitch = _pitch;
+	m_sampleRate = _sample_rate;
+	m_bufferLength = _buffer_length;
+	m_stringsUsed = 0;
+	for( int i = 0; i < m_exists.count(); i++ )
+	{
+		m_exists[i] = false;
+	}
+}
+
+
+
+
 void stringContainer::addString(int _harm,
 				const float _pick,
 				const float _pickup,
@@ -87,7 +106,11 @@ void stringContainer::addString(int _harm,
 			harm = 1.0f;
 	}
 
-	m_strings.append( new vibratingString(	m_pitch * harm,
+	if( m_stringsUsed == m_strings.count() )
+	{
+		m_strings.append( new vibratingString );
+	}
+	m_strings[m_stringsUsed++]->reset( m_pitch * harm,
 						_pick, 
 						_pickup,
 						const_cast<float*>(_impulse),
@@ -97,6 +120,6 @@ void stringContainer::addString(int _harm,
 						_randomize,
 						_string_loss,
 						_detune,
-						_state ) );
+						_state );
 	m_exists[_id] = true;
 }
@@ -34,10 +34,13 @@ class stringContainer
 {
 	MM_OPERATORS
 public:
-	stringContainer(const float _pitch, 
+	stringContainer( const int _strings = 9 );
+
+	// removes all strings from a new or recycled container, the string
+	// objects themselves are kept for being reused by addString()
+	void reset( const float _pitch,
 			const sample_rate_t _sample_rate,
-			const int _buffer_length,
-			const int _strings = 9 );
+			const int _buffer_length );
 	
 	void addString(	int _harm,
 			const float _pick,
@@ -71,9 +74,10 @@ public:
 	
 private:
 	QVector<vibratingString *> m_strings;
-	const float m_pitch;
-	const sample_rate_t m_sampleRate;
-	const int m_bufferLength;
+	int m_stringsUsed;
+	float m_pitch;
+	sample_rate_t m_sampleRate;
+	int m_bufferLength;
 	QVector<bool> m_exists;
 } ;
 
@@ -277,9 +277,11 @@ void vibed::playNote( NotePlayHandle * _n, sampleFrame * _working_buffer )
 {
 	if ( _n->totalFramesPlayed() == 0 || _n->m_pluginData == NULL )
 	{
-		_n->m_pluginData = new stringContainer( _n->frequency(),
+		stringContainer * ps = m_stringContainers.acquire();
+		ps->reset( _n->frequency(),
 				Engine::mixer()->processingSampleRate(),
 						__sampleLength );
+		_n->m_pluginData = ps;
 		
 		for( int i = 0; i < 9; ++i )
 		{
@@ -334,7 +336,8 @@ void vibed::playNote( NotePlayHandle * _n, sampleFrame * _working_buffer )
 
 void vibed::deleteNotePluginData( NotePlayHandle * _n )
 {
-	delete static_cast<stringContainer *>( _n->m_pluginData );
+	m_stringContainers.release(
+			static_cast<stringContainer *>( _n->m_pluginData ) );
 }
 
 
@@ -31,9 +31,11 @@
 #include "PixmapButton.h"
 #include "LedCheckbox.h"
 #include "nine_button_selector.h"
+#include "VoicePool.h"
 
 class vibedView;
 class NotePlayHandle;
+class stringContainer;
 
 class vibed : public Instrument
 {
@@ -77,6 +79,8 @@ private:
 
 	static const int __sampleLength = 128;
 
+	VoicePool<stringContainer> m_stringContainers;
+
 	friend class vibedView;
 } ;
 
@@ -30,24 +30,43 @@
 #include "Engine.h"
 
 
-vibratingString::vibratingString(	float _pitch, 
-					float _pick,
-					float _pickup,
-					float * _impulse, 
-					int _len,
-					sample_rate_t _sample_rate,
-					int _oversample,
-					float _randomize,
-					float _string_loss,
-					float _detune,
-					bool _state ) :
-	m_oversample( 2 * _oversample / (int)( _sample_rate /
-				Engine::mixer()->baseSampleRate() ) ),
-	m_randomize( _randomize ),
-	m_stringLoss( 1.0f - _string_loss ),
-	m_state( 0.1f )
+vibratingString::vibratingString() :
+	m_fromBridge( vibratingString::allocDelayLine() ),
+	m_toBridge( vibratingString::allocDelayLine() ),
+	m_impulse( NULL ),
+	m_impulseSize( 0 ),
+	m_outsamp( NULL ),
+	m_outsampSize( 0 )
 {
-	m_outsamp = new sample_t[m_oversample];
+}
+
+
+
+
+void vibratingString::reset(	float _pitch, 
+				float _pick,
+				float _pickup,
+				float * _impulse, 
+				int _len,
+				sample_rate_t _sample_rate,
+				int _oversample,
+				float _randomize,
+				float _string_loss,
+				float _detune,
+				bool _state )
+{
+	m_oversample = 2 * _oversample / (int)( _sample_rate /
+				Engine::mixer()->baseSampleRate() );
+	m_randomize = _randomize;
+	m_stringLoss = 1.0f - _string_loss;
+	m_state = 0.1f;
+
+	if( m_oversample > m_outsampSize )
+	{
+		delete[] m_outsamp;
+		m_outsamp = new sample_t[m_oversample];
+		m_outsampSize = m_oversample;
+	}
 	int string_length;
 	
 	string_length = static_cast<int>( m_oversample * _sample_rate /
@@ -56,22 +75,28 @@ vibratingString::vibratingString(	float _pitch,
 
 	int pick = static_cast<int>( ceil( string_length * _pick ) );
 	
+	const int impulse_length = _state ? _len : string_length;
+	if( impulse_length > m_impulseSize )
+	{
+		delete[] m_impulse;
+		m_impulse = new float[impulse_length];
+		m_impulseSize = impulse_length;
+	}
+
 	if( not _state )
 	{
-		m_impulse = new float[string_length];
 		resample( _impulse, _len, string_length );
 	}
 	else
  	{
-		m_impulse = new float[_len];
 		for( int i = 0; i < _len; i++ )
 		{
 			m_impulse[i] = _impulse[i];
 		}
 	}
 	
-	m_toBridge = vibratingString::initDelayLine( string_length, pick );
-	m_fromBridge = vibratingString::initDelayLine( string_length, pick );
+	vibratingString::initDelayLine( m_toBridge, string_length );
+	vibratingString::initDelayLine( m_fromBridge, string_length );
 
 	
 	vibratingString::setDelayLine( m_toBridge, pick, 
@@ -90,34 +115,46 @@ vibratingString::vibratingString(	float _pitch,
 
 
 
-vibratingString::delayLine * vibratingString::initDelayLine( int _len,
-								int _pick )
+vibratingString::delayLine * vibratingString::allocDelayLine()
+{
+	delayLine * dl = new vibratingString::delayLine;
+	dl->data = NULL;
+	dl->length = 0;
+	dl->size = 0;
+	dl->pointer = NULL;
+	dl->end = NULL;
+
+	return( dl );
+}
+
+
+
+
+void vibratingString::initDelayLine( delayLine * _dl, int _len )
 {
-	delayLine * dl = new vibratingString::delayLine[_len];
-	dl->length = _len;
+	if( _len > _dl->size )
+	{
+		delete[] _dl->data;
+		_dl->data = new sample_t[_len];
+		_dl->size = _len;
+	}
+	_dl->length = _len;
 	if( _len > 0 )
 	{
-		dl->data = new sample_t[_len];
 		float r;
 		float offset = 0.0f;
-		for( int i = 0; i < dl->length; i++ )
+		for( int i = 0; i < _dl->length; i++ )
 		{
 			r = static_cast<float>( rand() ) /
 					RAND_MAX;
 			offset =  ( m_randomize / 2.0f -
 					m_randomize ) * r;
-			dl->data[i] = offset;
+			_dl->data[i] = offset;
 		}
 	}
-	else
-	{
-		dl->data = NULL;
-	}
-
-	dl->pointer = dl->data;
-	dl->end = dl->data + _len - 1;
 
-	return( dl );
+	_dl->pointer = _dl->data;
+	_dl->end = _dl->data + _len - 1;
 }
 
 
@@ -128,7 +165,7 @@ void vibratingString::freeDelayLine( delayLine * _dl )
 	if( _dl )
 	{
 		delete[] _dl->data;
-		delete[] _dl;
+		delete _dl;
 	}
 }
 
@@ -33,7 +33,19 @@ class vibratingString
 {
 
 public:
-	vibratingString(	float _pitch, 
+	vibratingString();
+
+	inline ~vibratingString()
+	{
+		delete[] m_outsamp;
+		delete[] m_impulse;
+		vibratingString::freeDelayLine( m_fromBridge );
+		vibratingString::freeDelayLine( m_toBridge );
+	}
+
+	// (re)initializes the string - buffers are kept and only grown if
+	// the new string needs more space than any string before
+	void reset(	float _pitch, 
 				float _pick, 
 				float _pickup,
 				float * impluse,
@@ -44,14 +56,6 @@ public:
 				float _string_loss,
 				float _detune,
 				bool _state );
-	
-	inline ~vibratingString()
-	{
-		delete[] m_outsamp;
-		delete[] m_impulse;
-		vibratingString::freeDelayLine( m_fromBridge );
-		vibratingString::freeDelayLine( m_toBridge );
-	}
 
 	inline sample_t nextSample()
 	{	
@@ -87,6 +91,7 @@ private:
 	{
 		sample_t * data;
 		int length;
+		int size;
 		sample_t * pointer;
 		sample_t * end;
 	} ;
@@ -99,12 +104,15 @@ private:
 	float m_stringLoss;
 	
 	float * m_impulse;
+	int m_impulseSize;
 	int m_choice;
 	float m_state;
 	
 	sample_t * m_outsamp;
+	int m_outsampSize;
 
-	delayLine * initDelayLine( int _len, int _pick );
+	static delayLine * allocDelayLine();
+	void initDelayLine( delayLine * _dl, int _len );
 	static void freeDelayLine( delayLine * _dl );
 	void resample( float *_src, f_cnt_t _src_frames, f_cnt_t _dst_frames );
 	
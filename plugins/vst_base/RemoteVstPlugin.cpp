@@ -63,6 +63,7 @@
 #define USE_WS_PREFIX
 #include <windows.h>
 
+#include <algorithm>
 #include <vector>
 #include <queue>
 #include <string>
@@ -825,6 +826,14 @@ bool RemoteVstPlugin::load( const std::string & _plugin_file )
 
 
 
+static bool earlierMidiEvent( const VstMidiEvent & a, const VstMidiEvent & b )
+{
+	return a.deltaFrames < b.deltaFrames;
+}
+
+
+
+
 void RemoteVstPlugin::process( const sampleFrame * _in, sampleFrame * _out )
 {
 	// first we gonna post all MIDI-events we enqueued so far
@@ -838,6 +847,16 @@ void RemoteVstPlugin::process( const sampleFrame * _in, sampleFrame * _out )
 		static char eventsBuffer[sizeof( VstEvents ) + sizeof( VstMidiEvent * ) * MIDI_EVENT_BUFFER_COUNT];
 		static VstMidiEvent vme[MIDI_EVENT_BUFFER_COUNT];
 
+		// plugins expect the events to be ordered by their offsets
+		// while they come in the order the note play handles have
+		// been processed
+		std::stable_sort( m_midiEvents.begin(), m_midiEvents.end(),
+							earlierMidiEvent );
+		if( m_midiEvents.size() > MIDI_EVENT_BUFFER_COUNT )
+		{
+			m_midiEvents.resize( MIDI_EVENT_BUFFER_COUNT );
+		}
+
 		VstEvents* events = (VstEvents *) eventsBuffer;
 		events->reserved = 0;
 		events->numEvents = m_midiEvents.size();
@@ -906,7 +925,8 @@ void RemoteVstPlugin::processMidiEvent( const MidiEvent& event, const f_cnt_t of
 
 	vme.type = kVstMidiType;
 	vme.byteSize = 24;
-	vme.deltaFrames = offset;
+	// offsets relate to the current period
+	vme.deltaFrames = std::max<int>( 0, std::min<int>( offset, bufferSize() - 1 ) );
 	vme.flags = 0;
 	vme.detune = 0;
 	vme.noteLength = 0;
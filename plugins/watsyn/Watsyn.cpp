@@ -23,6 +23,7 @@
  */
 
 #include <QDomElement>
+#include <QThread>
 
 #include "Watsyn.h"
 #include "base64.h"
@@ -34,6 +35,7 @@
 #include "lmms_math.h"
 #include "Mixer.h"
 #include "interpolation.h"
+#include "fft_helpers.h"
 
 #include "embed.cpp"
 
@@ -59,19 +61,126 @@ Plugin::Descriptor PLUGIN_EXPORT watsyn_plugin_descriptor =
 
 
 
-WatsynObject::WatsynObject( float * _A1wave, float * _A2wave,
-					float * _B1wave, float * _B2wave,
+WatsynWave::WatsynWave( const float * _graph ) :
+	m_refs( 1 ),
+	m_next( NULL )
+{
+	fftwf_plan analysis = sharedFftPlanR2C( GRAPHLEN );
+	fftwf_plan synthesis = sharedFftPlanC2R( WAVELEN );
+
+	if( analysis == NULL || synthesis == NULL )
+	{
+		for( int l = 0; l < Levels; l++ )
+		{
+			for( int i = 0; i < WAVELEN; i++ )
+			{
+				m_tables[l][i] = _graph[ i / WAVERATIO ];
+			}
+		}
+		return;
+	}
+
+	const int bins = GRAPHLEN / 2 + 1;
+	float * graph = (float *) fftwf_malloc( GRAPHLEN * sizeof( float ) );
+	fftwf_complex * spectrum = (fftwf_complex *)
+		fftwf_malloc( bins * sizeof( fftwf_complex ) );
+	fftwf_complex * bands = (fftwf_complex *)
+		fftwf_malloc( ( WAVELEN / 2 + 1 ) * sizeof( fftwf_complex ) );
+	float * wave = (float *) fftwf_malloc( WAVELEN * sizeof( float ) );
+
+	memcpy( graph, _graph, sizeof( float ) * GRAPHLEN );
+	fftwf_execute_dft_r2c( analysis, graph, spectrum );
+
+	// the nyquist bin of the graph isn't mirrored in the longer table
+	spectrum[bins - 1][0] *= 0.5f;
+	spectrum[bins - 1][1] = 0.0f;
+
+	// oversample by zero-padding the spectrum, dropping the upper half
+	// of the remaining harmonics for every level
+	for( int l = 0; l < Levels; l++ )
+	{
+		const int harmonics = ( bins - 1 ) >> l;
+		memset( bands, 0, ( WAVELEN / 2 + 1 ) * sizeof( fftwf_complex ) );
+		for( int i = 0; i <= harmonics; i++ )
+		{
+			bands[i][0] = spectrum[i][0] / GRAPHLEN;
+			bands[i][1] = spectrum[i][1] / GRAPHLEN;
+		}
+		fftwf_execute_dft_c2r( synthesis, bands, wave );
+		memcpy( m_tables[l], wave, sizeof( float ) * WAVELEN );
+	}
+
+	fftwf_free( graph );
+	fftwf_free( spectrum );
+	fftwf_free( bands );
+	fftwf_free( wave );
+}
+
+
+const float * WatsynWave::table( float _step ) const
+{
+	const float maxHarmonic = WAVELEN / ( 2.0f * _step );
+	int l = 0;
+	while( l < Levels - 1 && ( ( GRAPHLEN / 2 ) >> l ) > maxHarmonic )
+	{
+		l++;
+	}
+	return m_tables[l];
+}
+
+
+
+
+WatsynObject::WatsynObject() :
+				m_amod( 0 ),
+				m_bmod( 0 ),
+				m_samplerate( 0 ),
+				m_nph( NULL ),
+				m_fpp( 0 ),
+				m_parent( NULL ),
+				m_abuf( NULL ),
+				m_bbuf( NULL )
+{
+	for( int i = 0; i < NUM_OSCS; i++ )
+	{
+		m_waves[i] = NULL;
+	}
+}
+
+
+
+WatsynObject::~WatsynObject()
+{
+	releaseWaves();
+	delete[] m_abuf;
+	delete[] m_bbuf;
+}
+
+
+void WatsynObject::setPeriodSize( fpp_t _frames )
+{
+	if( m_fpp != _frames )
+	{
+		delete[] m_abuf;
+		delete[] m_bbuf;
+		m_abuf = new sampleFrame[_frames];
+		m_bbuf = new sampleFrame[_frames];
+		m_fpp = _frames;
+	}
+}
+
+
+void WatsynObject::reset( WatsynWave ** _waves,
 					int _amod, int _bmod, const sample_rate_t _samplerate, NotePlayHandle * _nph, fpp_t _frames,
-					WatsynInstrument * _w ) :
-				m_amod( _amod ),
-				m_bmod( _bmod ),
-				m_samplerate( _samplerate ),
-				m_nph( _nph ),
-				m_fpp( _frames ),
-				m_parent( _w )
+					WatsynInstrument * _w )
 {
-	m_abuf = new sampleFrame[_frames];
-	m_bbuf = new sampleFrame[_frames];
+	m_amod = _amod;
+	m_bmod = _bmod;
+	m_samplerate = _samplerate;
+	m_nph = _nph;
+	m_parent = _w;
+
+	setPeriodSize( _frames );
 
 	m_lphase[A1_OSC] = 0.0f;
 	m_lphase[A2_OSC] = 0.0f;
@@ -83,20 +192,28 @@ WatsynObject::WatsynObject( float * _A1wave, float * _A2wave,
 	m_rphase[B1_OSC] = 0.0f;
 	m_rphase[B2_OSC] = 0.0f;
 
-	// copy wavegraphs to the synth object to prevent race conditions
-
-	memcpy( &m_A1wave, _A1wave, sizeof( m_A1wave ) );
-	memcpy( &m_A2wave, _A2wave, sizeof( m_A2wave ) );
-	memcpy( &m_B1wave, _B1wave, sizeof( m_B1wave ) );
-	memcpy( &m_B2wave, _B2wave, sizeof( m_B2wave ) );
+	// the wavetables stay untouched while we hold them, so editing the
+	// graphs doesn't affect notes that are already playing
+	for( int i = 0; i < NUM_OSCS; i++ )
+	{
+		m_waves[i] = _waves[i];
+	}
 }
 
 
-
-WatsynObject::~WatsynObject()
+void WatsynObject::releaseWaves()
 {
-	delete[] m_abuf;
-	delete[] m_bbuf;
+	for( int i = 0; i < NUM_OSCS; i++ )
+	{
+		if( m_waves[i] )
+		{
+			if( m_waves[i]->unref() )
+			{
+				m_parent->retireWave( m_waves[i] );
+			}
+			m_waves[i] = NULL;
+		}
+	}
 }
 
 
@@ -107,6 +224,19 @@ void WatsynObject::renderOutput( fpp_t _frames )
 	if( m_bbuf == NULL )
 		m_bbuf = new sampleFrame[m_fpp];
 
+	// pick the mip levels for the current pitch once per period
+	const float * waves [NUM_OSCS];
+	for( int i = 0; i < NUM_OSCS; i++ )
+	{
+		const float freq = m_nph->frequency() *
+			qMax( m_parent->m_lfreq[i], m_parent->m_rfreq[i] );
+		waves[i] = m_waves[i]->table( WAVELEN * freq / m_samplerate );
+	}
+	const float * A1wave = waves[A1_OSC];
+	const float * A2wave = waves[A2_OSC];
+	const float * B1wave = waves[B1_OSC];
+	const float * B2wave = waves[B2_OSC];
+
 	for( fpp_t frame = 0; frame < _frames; frame++ )
 	{
 		// put phases of 1-series oscs into variables because phase modulation might happen
@@ -118,11 +248,11 @@ void WatsynObject::renderOutput( fpp_t _frames )
 		/////////////   A-series   /////////////////
 
 		// A2
-		sample_t A2_L = linearInterpolate( m_A2wave[ static_cast<int>( m_lphase[A2_OSC] ) ],
-							m_A2wave[ static_cast<int>( m_lphase[A2_OSC] + 1 ) % WAVELEN ],
+		sample_t A2_L = linearInterpolate( A2wave[ static_cast<int>( m_lphase[A2_OSC] ) ],
+							A2wave[ static_cast<int>( m_lphase[A2_OSC] + 1 ) % WAVELEN ],
 							fraction( m_lphase[A2_OSC] ) ) * m_parent->m_lvol[A2_OSC];
-		sample_t A2_R = linearInterpolate( m_A2wave[ static_cast<int>( m_rphase[A2_OSC] ) ],
-							m_A2wave[ static_cast<int>( m_rphase[A2_OSC] + 1 ) % WAVELEN ],
+		sample_t A2_R = linearInterpolate( A2wave[ static_cast<int>( m_rphase[A2_OSC] ) ],
+							A2wave[ static_cast<int>( m_rphase[A2_OSC] + 1 ) % WAVELEN ],
 							fraction( m_rphase[A2_OSC] ) ) * m_parent->m_rvol[A2_OSC];
 
 		// if phase mod, add to phases
@@ -134,21 +264,21 @@ void WatsynObject::renderOutput( fpp_t _frames )
 			if( A1_rphase < 0 ) A1_rphase += WAVELEN;
 		}
 		// A1
-		sample_t A1_L = linearInterpolate( m_A1wave[ static_cast<int>( A1_lphase ) ],
-							m_A1wave[ static_cast<int>( A1_lphase + 1 ) % WAVELEN ],
+		sample_t A1_L = linearInterpolate( A1wave[ static_cast<int>( A1_lphase ) ],
+							A1wave[ static_cast<int>( A1_lphase + 1 ) % WAVELEN ],
 							fraction( A1_lphase ) ) * m_parent->m_lvol[A1_OSC];
-		sample_t A1_R = linearInterpolate( m_A1wave[ static_cast<int>( A1_rphase ) ],
-							m_A1wave[ static_cast<int>( A1_rphase + 1 ) % WAVELEN ],
+		sample_t A1_R = linearInterpolate( A1wave[ static_cast<int>( A1_rphase ) ],
+							A1wave[ static_cast<int>( A1_rphase + 1 ) % WAVELEN ],
 							fraction( A1_rphase ) ) * m_parent->m_rvol[A1_OSC];
 
 		/////////////   B-series   /////////////////
 
 		// B2
-		sample_t B2_L = linearInterpolate( m_B2wave[ static_cast<int>( m_lphase[B2_OSC] ) ],
-							m_B2wave[ static_cast<int>( m_lphase[B2_OSC] + 1 ) % WAVELEN ],
+		sample_t B2_L = linearInterpolate( B2wave[ static_cast<int>( m_lphase[B2_OSC] ) ],
+							B2wave[ static_cast<int>( m_lphase[B2_OSC] + 1 ) % WAVELEN ],
 							fraction( m_lphase[B2_OSC] ) ) * m_parent->m_lvol[B2_OSC];
-		sample_t B2_R = linearInterpolate( m_B2wave[ static_cast<int>( m_rphase[B2_OSC] ) ],
-							m_B2wave[ static_cast<int>( m_rphase[B2_OSC] + 1 ) % WAVELEN ],
+		sample_t B2_R = linearInterpolate( B2wave[ static_cast<int>( m_rphase[B2_OSC] ) ],
+							B2wave[ static_cast<int>( m_rphase[B2_OSC] + 1 ) % WAVELEN ],
 							fraction( m_rphase[B2_OSC] ) ) * m_parent->m_rvol[B2_OSC];
 
 		// if crosstalk active, add a1
@@ -168,11 +298,11 @@ void WatsynObject::renderOutput( fpp_t _frames )
 			if( B1_rphase < 0 ) B1_rphase += WAVELEN;
 		}
 		// B1
-		sample_t B1_L = linearInterpolate( m_B1wave[ static_cast<int>( B1_lphase ) % WAVELEN ],
-							m_B1wave[ static_cast<int>( B1_lphase + 1 ) % WAVELEN ],
+		sample_t B1_L = linearInterpolate( B1wave[ static_cast<int>( B1_lphase ) % WAVELEN ],
+							B1wave[ static_cast<int>( B1_lphase + 1 ) % WAVELEN ],
 							fraction( B1_lphase ) ) * m_parent->m_lvol[B1_OSC];
-		sample_t B1_R = linearInterpolate( m_B1wave[ static_cast<int>( B1_rphase ) % WAVELEN ],
-							m_B1wave[ static_cast<int>( B1_rphase + 1 ) % WAVELEN ],
+		sample_t B1_R = linearInterpolate( B1wave[ static_cast<int>( B1_rphase ) % WAVELEN ],
+							B1wave[ static_cast<int>( B1_rphase + 1 ) % WAVELEN ],
 							fraction( B1_rphase ) ) * m_parent->m_rvol[B1_OSC];
 
 
@@ -319,11 +449,26 @@ WatsynInstrument::WatsynInstrument( InstrumentTrack * _instrument_track ) :
 	updateWaveA2();
 	updateWaveB1();
 	updateWaveB2();
+
+	const fpp_t frames = Engine::mixer()->framesPerPeriod();
+	m_objects.prepare( [frames]( WatsynObject & _o )
+	{
+		_o.setPeriodSize( frames );
+	} );
 }
 
 
 WatsynInstrument::~WatsynInstrument()
 {
+	for( int i = 0; i < NUM_OSCS; i++ )
+	{
+		WatsynWave * wave = m_waves[i].fetchAndStoreOrdered( NULL );
+		if( wave && wave->unref() )
+		{
+			delete wave;
+		}
+	}
+	deleteRetiredWaves();
 }
 
 
@@ -332,11 +477,12 @@ void WatsynInstrument::playNote( NotePlayHandle * _n,
 {
 	if ( _n->totalFramesPlayed() == 0 || _n->m_pluginData == NULL )
 	{
-		WatsynObject * w = new WatsynObject(
-				&A1_wave[0],
-				&A2_wave[0],
-				&B1_wave[0],
-				&B2_wave[0],
+		WatsynWave * waves [NUM_OSCS];
+		acquireWaves( waves );
+
+		WatsynObject * w = m_objects.acquire();
+		w->reset(
+				waves,
 				m_amod.value(), m_bmod.value(),
 				Engine::mixer()->processingSampleRate(), _n,
 				Engine::mixer()->framesPerPeriod(), this );
@@ -459,7 +605,9 @@ void WatsynInstrument::playNote( NotePlayHandle * _n,
 
 void WatsynInstrument::deleteNotePluginData( NotePlayHandle * _n )
 {
-	delete static_cast<WatsynObject *>( _n->m_pluginData );
+	WatsynObject * w = static_cast<WatsynObject *>( _n->m_pluginData );
+	w->releaseWaves();
+	m_objects.release( w );
 }
 
 
@@ -636,29 +784,83 @@ void WatsynInstrument::updateFreqB2()
 
 void WatsynInstrument::updateWaveA1()
 {
-	// do sinc+oversampling on the wavetables to improve quality
-	srccpy( &A1_wave[0], const_cast<float*>( a1_graph.samples() ) );
+	setWave( A1_OSC, a1_graph.samples() );
 }
 
 
 void WatsynInstrument::updateWaveA2()
 {
-	// do sinc+oversampling on the wavetables to improve quality
-	srccpy( &A2_wave[0], const_cast<float*>( a2_graph.samples() ) );
+	setWave( A2_OSC, a2_graph.samples() );
 }
 
 
 void WatsynInstrument::updateWaveB1()
 {
-	// do sinc+oversampling on the wavetables to improve quality
-	srccpy( &B1_wave[0], const_cast<float*>( b1_graph.samples() ) );
+	setWave( B1_OSC, b1_graph.samples() );
 }
 
 
 void WatsynInstrument::updateWaveB2()
 {
-	// do sinc+oversampling on the wavetables to improve quality
-	srccpy( &B2_wave[0], const_cast<float*>( b2_graph.samples() ) );
+	setWave( B2_OSC, b2_graph.samples() );
+}
+
+
+void WatsynInstrument::setWave( int _osc, const float * _graph )
+{
+	// building the band-limited tables is way too expensive for the audio
+	// threads, so it's done here and the result is swapped in
+	WatsynWave * old = m_waves[_osc].fetchAndStoreOrdered(
+						new WatsynWave( _graph ) );
+
+	// a note starting right now might not have referenced the old tables yet
+	while( m_waveReaders.loadAcquire() > 0 )
+	{
+		QThread::yieldCurrentThread();
+	}
+
+	if( old && old->unref() )
+	{
+		delete old;
+	}
+
+	deleteRetiredWaves();
+}
+
+
+void WatsynInstrument::acquireWaves( WatsynWave ** _waves )
+{
+	m_waveReaders.ref();
+	for( int i = 0; i < NUM_OSCS; i++ )
+	{
+		_waves[i] = m_waves[i].loadAcquire();
+		_waves[i]->ref();
+	}
+	m_waveReaders.deref();
+}
+
+
+void WatsynInstrument::retireWave( WatsynWave * _wave )
+{
+	WatsynWave * head;
+	do
+	{
+		head = m_retiredWaves.loadAcquire();
+		_wave->m_next = head;
+	}
+	while( !m_retiredWaves.testAndSetRelease( head, _wave ) );
+}
+
+
+void WatsynInstrument::deleteRetiredWaves()
+{
+	WatsynWave * wave = m_retiredWaves.fetchAndStoreAcquire( NULL );
+	while( wave )
+	{
+		WatsynWave * next = wave->m_next;
+		delete wave;
+		wave = next;
+	}
 }
 
 
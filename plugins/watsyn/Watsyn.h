@@ -34,8 +34,10 @@
 #include "TempoSyncKnob.h"
 #include "NotePlayHandle.h"
 #include "PixmapButton.h"
-#include <samplerate.h>
+#include <QAtomicPointer>
 #include "MemoryManager.h"
+#include "AtomicInt.h"
+#include "VoicePool.h"
 
 
 #define makeknob( name, x, y, hint, unit, oname ) 		\
@@ -79,18 +81,68 @@ const int	NUM_OSCS = 4;
 
 class WatsynInstrument;
 
+// band-limited, oversampled copy of one of the graphs - it is built once on
+// the GUI thread and then shared read-only by all notes started before the
+// graph changes again
+class WatsynWave
+{
+public:
+	// every level holds half the harmonics of the previous one
+	enum
+	{
+		Levels = 7
+	} ;
+
+	WatsynWave( const float * _graph );
+
+	// returns the level with as many harmonics as possible that stay
+	// below nyquist when advancing by _step table samples per frame
+	const float * table( float _step ) const;
+
+	void ref()
+	{
+		m_refs.ref();
+	}
+
+	// returns true if this was the last reference - the caller has to
+	// delete the wave then, or retire it if it's on the audio thread
+	bool unref()
+	{
+		return !m_refs.deref();
+	}
+
+private:
+	AtomicInt m_refs;
+	float m_tables [Levels][WAVELEN];
+
+	// next in WatsynInstrument's list of retired waves
+	WatsynWave * m_next;
+
+	friend class WatsynInstrument;
+};
+
 class WatsynObject
 {
 	MM_OPERATORS
 public:
-	WatsynObject( 	float * _A1wave, float * _A2wave,
-					float * _B1wave, float * _B2wave,
+	WatsynObject();
+	virtual ~WatsynObject();
+
+	// prepares a new or recycled object for playing the given note, the
+	// mix buffers are only reallocated if the period size has changed and
+	// the references held in _waves are taken over
+	void reset( 	WatsynWave ** _waves,
 					int _amod, int _bmod, const sample_rate_t _samplerate, NotePlayHandle * _nph, fpp_t _frames,
 					WatsynInstrument * _w );
-	virtual ~WatsynObject();
+
+	// (re)allocates the mix buffers if the period size has changed
+	void setPeriodSize( fpp_t _frames );
 
 	void renderOutput( fpp_t _frames );
 
+	// drops the wavetables once the note has ended
+	void releaseWaves();
+
 	inline sampleFrame * abuf() const
 	{
 		return m_abuf;
@@ -108,7 +160,7 @@ private:
 	int m_amod;
 	int m_bmod;
 
-	const sample_rate_t m_samplerate;
+	sample_rate_t m_samplerate;
 	NotePlayHandle * m_nph;
 
 	fpp_t m_fpp;
@@ -121,10 +173,7 @@ private:
 	float m_lphase [NUM_OSCS];
 	float m_rphase [NUM_OSCS];
 
-	float m_A1wave [WAVELEN];
-	float m_A2wave [WAVELEN];
-	float m_B1wave [WAVELEN];
-	float m_B2wave [WAVELEN];
+	WatsynWave * m_waves [NUM_OSCS];
 };
 
 class WatsynInstrument : public Instrument
@@ -181,30 +230,17 @@ private:
 		return ( _pan >= 0 ? 1.0 : 1.0 + ( _pan / 100.0 ) ) * _vol / 100.0;
 	}
 
-	// memcpy utilizing libsamplerate (src) for sinc interpolation
-	inline void srccpy( float * _dst, float * _src )
-	{
-		int err;
-		const int margin = 64;
-		
-		// copy to temp array
-		float tmps [ GRAPHLEN + margin ]; // temp array in stack
-		float * tmp = &tmps[0];
-
-		memcpy( tmp, _src, sizeof( float ) * GRAPHLEN );
-		memcpy( tmp + GRAPHLEN, _src, sizeof( float ) * margin );
-		SRC_STATE * src_state = src_new( SRC_SINC_FASTEST, 1, &err );
-		SRC_DATA src_data;
-		src_data.data_in = tmp;
-		src_data.input_frames = GRAPHLEN + margin;
-		src_data.data_out = _dst;
-		src_data.output_frames = WAVELEN;
-		src_data.src_ratio = static_cast<double>( WAVERATIO );
-		src_data.end_of_input = 0;
-		err = src_process( src_state, &src_data ); 
-		if( err ) { qDebug( "Watsyn SRC error: %s", src_strerror( err ) ); }
-		src_delete( src_state );
-	}
+	// replaces the wavetable of _osc by one built from _graph
+	void setWave( int _osc, const float * _graph );
+
+	// references the current wavetables for a new note
+	void acquireWaves( WatsynWave ** _waves );
+
+	// takes a wave whose last reference was dropped by a note, so that it
+	// isn't freed on the audio thread - deleteRetiredWaves() frees it
+	// with the next graph edit
+	void retireWave( WatsynWave * _wave );
+	void deleteRetiredWaves();
 
 	// memcpy utilizing cubic interpolation
 /*	inline void cipcpy( float * _dst, float * _src )
@@ -283,10 +319,13 @@ private:
 
 	IntModel m_selectedGraph;
 	
-	float A1_wave [WAVELEN];
-	float A2_wave [WAVELEN];
-	float B1_wave [WAVELEN];
-	float B2_wave [WAVELEN];
+	QAtomicPointer<WatsynWave> m_waves [NUM_OSCS];
+	// number of notes currently picking up m_waves
+	AtomicInt m_waveReaders;
+	// waves no note references anymore, linked through m_next
+	QAtomicPointer<WatsynWave> m_retiredWaves;
+
+	VoicePool<WatsynObject> m_objects;
 
 	friend class WatsynObject;
 	friend class WatsynView;
@@ -29,6 +29,8 @@
 #include <ctime>
 
 #include "LocalZynAddSubFx.h"
+#include "AtomicInt.h"
+#include "ThreadableJob.h"
 
 #include "zynaddsubfx/src/Nio/NulEngine.h"
 #include "zynaddsubfx/src/Misc/Master.h"
@@ -40,10 +42,80 @@ SYNTH_T* synth = NULL;
 
 int LocalZynAddSubFx::s_instanceCount = 0;
 
+// every thread starts with the same random generator state, so threads
+// rendering parts are seeded with their own state on their first job
+static ZYN_THREAD_LOCAL bool s_prngSeeded = false;
+static AtomicInt s_prngThreads;
+
+
+// wraps every part to be rendered in a job and hands them to the job runner
+class LocalZynAddSubFx::PartJobs : public Master::PartRenderer
+{
+public:
+	PartJobs( JobRunner _runner ) :
+		m_runner( _runner )
+	{
+		for( int i = 0; i < NUM_MIDI_PARTS; ++i )
+		{
+			m_jobPointers[i] = &m_jobs[i];
+		}
+	}
+
+	virtual void renderParts( Part * * _parts, int _count )
+	{
+		for( int i = 0; i < _count; ++i )
+		{
+			m_jobs[i].reset();
+			m_jobs[i].part = _parts[i];
+		}
+		m_runner( m_jobPointers, _count );
+	}
+
+
+private:
+	class PartJob : public ThreadableJob
+	{
+	public:
+		PartJob() :
+			part( NULL )
+		{
+		}
+
+		virtual bool requiresProcessing() const
+		{
+			return true;
+		}
+
+		Part * part;
+
+	protected:
+		virtual void doProcessing()
+		{
+			if( !s_prngSeeded )
+			{
+				const prng_t thread = s_prngThreads.fetchAndAddOrdered( 1 ) + 1;
+				sprng( 0x1234 + thread * 0x9e3779b9u );
+				s_prngSeeded = true;
+			}
+
+			// renders the kit items and the part's effect chain as well
+			part->ComputePartSmps();
+		}
+	} ;
+
+	JobRunner m_runner;
+	PartJob m_jobs[NUM_MIDI_PARTS];
+	ThreadableJob * m_jobPointers[NUM_MIDI_PARTS];
+
+} ;
+
+
 
 LocalZynAddSubFx::LocalZynAddSubFx() :
+	m_bufferSize( 0 ),
 	m_master( NULL ),
-	m_ioEngine( NULL )
+	m_ioEngine( NULL ),
+	m_partJobs( NULL )
 {
 	for( int i = 0; i < NumKeys; ++i )
 	{
@@ -77,6 +149,9 @@ LocalZynAddSubFx::LocalZynAddSubFx() :
 
 	++s_instanceCount;
 
+	m_bufferSize = synth->buffersize;
+	m_pendingEvents.reserve( 256 );
+
 	m_ioEngine = new NulEngine;
 
 	m_master = new Master();
@@ -90,6 +165,7 @@ LocalZynAddSubFx::~LocalZynAddSubFx()
 {
 	delete m_master;
 	delete m_ioEngine;
+	delete m_partJobs;
 
 	if( --s_instanceCount == 0 )
 	{
@@ -121,7 +197,17 @@ void LocalZynAddSubFx::setSampleRate( int sampleRate )
 
 void LocalZynAddSubFx::setBufferSize( int bufferSize )
 {
-	synth->buffersize = bufferSize;
+	m_bufferSize = bufferSize;
+
+	// render periods in smaller blocks so MIDI events can be applied
+	// close to their offsets even with large buffer sizes
+	int blockSize = bufferSize;
+	while( blockSize > MaxBlockSize && blockSize % 2 == 0 )
+	{
+		blockSize /= 2;
+	}
+
+	synth->buffersize = blockSize;
 	synth->alias();
 }
 
@@ -216,7 +302,25 @@ void LocalZynAddSubFx::setPitchWheelBendRange( int semitones )
 
 
 
-void LocalZynAddSubFx::processMidiEvent( const MidiEvent& event )
+void LocalZynAddSubFx::processMidiEvent( const MidiEvent& event, int _offset )
+{
+	PendingMidiEvent pending;
+	pending.event = event;
+	pending.offset = _offset;
+
+	// events usually arrive in order, so just look from the back
+	std::vector<PendingMidiEvent>::iterator it = m_pendingEvents.end();
+	while( it != m_pendingEvents.begin() && ( it - 1 )->offset > _offset )
+	{
+		--it;
+	}
+	m_pendingEvents.insert( it, pending );
+}
+
+
+
+
+void LocalZynAddSubFx::applyMidiEvent( const MidiEvent& event )
 {
 	switch( event.type() )
 	{
@@ -259,15 +363,45 @@ void LocalZynAddSubFx::processMidiEvent( const MidiEvent& event )
 
 
 
+void LocalZynAddSubFx::setJobRunner( JobRunner _runner )
+{
+	m_master->setPartRenderer( NULL );
+	delete m_partJobs;
+	m_partJobs = _runner ? new PartJobs( _runner ) : NULL;
+	m_master->setPartRenderer( m_partJobs );
+}
+
+
+
+
 void LocalZynAddSubFx::processAudio( sampleFrame * _out )
 {
-	float outputl[synth->buffersize];
-	float outputr[synth->buffersize];
+	const int blockSize = synth->buffersize;
+	float outputl[m_bufferSize];
+	float outputr[m_bufferSize];
+
+	// m_bufferSize is a multiple of blockSize, see setBufferSize()
+	std::vector<PendingMidiEvent>::const_iterator event = m_pendingEvents.begin();
+	for( int frame = 0; frame < m_bufferSize; frame += blockSize )
+	{
+		for( ; event != m_pendingEvents.end() &&
+				event->offset < frame + blockSize; ++event )
+		{
+			applyMidiEvent( event->event );
+		}
 
-	m_master->GetAudioOutSamples( synth->buffersize, synth->samplerate, outputl, outputr );
+		m_master->AudioOut( outputl + frame, outputr + frame );
+	}
+
+	// offsets beyond the end of the period
+	for( ; event != m_pendingEvents.end(); ++event )
+	{
+		applyMidiEvent( event->event );
+	}
+	m_pendingEvents.clear();
 
 	// TODO: move to MixHelpers
-	for( int f = 0; f < synth->buffersize; ++f )
+	for( int f = 0; f < m_bufferSize; ++f )
 	{
 		_out[f][0] = outputl[f];
 		_out[f][1] = outputr[f];
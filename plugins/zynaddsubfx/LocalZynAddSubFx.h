@@ -25,11 +25,14 @@
 #ifndef LOCAL_ZYNADDSUBFX_H
 #define LOCAL_ZYNADDSUBFX_H
 
+#include <vector>
+
 #include "MidiEvent.h"
 #include "Note.h"
 
 class Master;
 class NulEngine;
+class ThreadableJob;
 
 class LocalZynAddSubFx
 {
@@ -52,10 +55,20 @@ public:
 
 	void setPitchWheelBendRange( int semitones );
 
-	void processMidiEvent( const MidiEvent& event );
+	// queues event until the next call of processAudio() which applies it
+	// at the start of the block containing frame _offset
+	void processMidiEvent( const MidiEvent& event, int _offset = 0 );
 
 	void processAudio( sampleFrame * _out );
 
+	// function which queues and processes all of the given jobs, possibly
+	// on several threads, and returns once all of them are done
+	typedef void (* JobRunner)( ThreadableJob * * _jobs, int _count );
+
+	// renders the parts of the master as jobs using _runner, NULL renders
+	// them one after another in the calling thread
+	void setJobRunner( JobRunner _runner );
+
 	inline Master * master()
 	{
 		return m_master;
@@ -63,13 +76,31 @@ public:
 
 
 protected:
+	// largest block ZynAddSubFX renders at once, i.e. the maximum deviation
+	// of MIDI events from their offsets
+	static const int MaxBlockSize = 128;
+
+	struct PendingMidiEvent
+	{
+		MidiEvent event;
+		int offset;
+	} ;
+
+	void applyMidiEvent( const MidiEvent& event );
+
+	class PartJobs;
+
 	static int s_instanceCount;
 
 	std::string m_presetsDir;
 
 	int m_runningNotes[NumKeys];
+	int m_bufferSize;
+	// sorted by offset
+	std::vector<PendingMidiEvent> m_pendingEvents;
 	Master * m_master;
 	NulEngine* m_ioEngine;
+	PartJobs * m_partJobs;
 
 } ;
 
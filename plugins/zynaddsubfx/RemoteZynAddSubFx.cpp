@@ -29,11 +29,14 @@
 
 #include <queue>
 
+#include <QtCore/QThread>
+
 #define BUILD_REMOTE_PLUGIN_CLIENT
 #include "Note.h"
 #include "RemotePlugin.h"
 #include "RemoteZynAddSubFx.h"
 #include "LocalZynAddSubFx.h"
+#include "ThreadableJob.h"
 
 #include "zynaddsubfx/src/Nio/Nio.h"
 #include "zynaddsubfx/src/UI/MasterUI.h"
@@ -41,6 +44,150 @@
 #include <FL/x.H>
 
 
+// The worker threads of LMMS aren't available in this process, so a few
+// threads of its own help with rendering the parts of the master.
+class PartRenderThreads
+{
+public:
+	static void start()
+	{
+		// every instance runs in a process of its own, so don't claim
+		// all cores for a single one
+		s_threadCount = qBound( 0, QThread::idealThreadCount() - 1,
+							(int) MaxThreads );
+		s_quit = false;
+		s_generation = 0;
+		pthread_mutex_init( &s_mutex, NULL );
+		pthread_cond_init( &s_cond, NULL );
+		pthread_cond_init( &s_doneCond, NULL );
+		for( int i = 0; i < s_threadCount; ++i )
+		{
+			pthread_create( &s_threads[i], NULL, threadFunc, NULL );
+		}
+	}
+
+	static void stop()
+	{
+		pthread_mutex_lock( &s_mutex );
+		s_quit = true;
+		pthread_cond_broadcast( &s_cond );
+		pthread_mutex_unlock( &s_mutex );
+		for( int i = 0; i < s_threadCount; ++i )
+		{
+			pthread_join( s_threads[i], NULL );
+		}
+		pthread_cond_destroy( &s_cond );
+		pthread_cond_destroy( &s_doneCond );
+		pthread_mutex_destroy( &s_mutex );
+	}
+
+	static void runJobs( ThreadableJob * * _jobs, int _count )
+	{
+		for( int i = 0; i < _count; ++i )
+		{
+			_jobs[i]->queue();
+		}
+
+		if( s_threadCount > 0 )
+		{
+			pthread_mutex_lock( &s_mutex );
+			s_jobs = _jobs;
+			s_jobCount = _count;
+			++s_generation;
+			pthread_cond_broadcast( &s_cond );
+			pthread_mutex_unlock( &s_mutex );
+		}
+
+		// don't wait for the helpers to wake up, whatever job they didn't
+		// pick up yet is processed right here
+		processJobs( _jobs, _count );
+
+		if( s_threadCount == 0 )
+		{
+			return;
+		}
+
+		// sleep until the helpers are done with the jobs they picked up -
+		// they signal after each run of processJobs()
+		pthread_mutex_lock( &s_mutex );
+		for( int i = 0; i < _count; ++i )
+		{
+			while( _jobs[i]->state() != ThreadableJob::Done )
+			{
+				pthread_cond_wait( &s_doneCond, &s_mutex );
+			}
+		}
+		pthread_mutex_unlock( &s_mutex );
+	}
+
+
+private:
+	enum
+	{
+		MaxThreads = 4
+	} ;
+
+	static void processJobs( ThreadableJob * * _jobs, int _count )
+	{
+		// process() only runs jobs no other thread has started yet
+		for( int i = 0; i < _count; ++i )
+		{
+			_jobs[i]->process();
+		}
+	}
+
+	static void * threadFunc( void * )
+	{
+		int generation = 0;
+
+		pthread_mutex_lock( &s_mutex );
+		while( !s_quit )
+		{
+			if( generation == s_generation )
+			{
+				pthread_cond_wait( &s_cond, &s_mutex );
+				continue;
+			}
+			generation = s_generation;
+			ThreadableJob * * jobs = s_jobs;
+			const int count = s_jobCount;
+			pthread_mutex_unlock( &s_mutex );
+
+			processJobs( jobs, count );
+
+			pthread_mutex_lock( &s_mutex );
+			pthread_cond_broadcast( &s_doneCond );
+		}
+		pthread_mutex_unlock( &s_mutex );
+
+		return NULL;
+	}
+
+	static pthread_t s_threads[MaxThreads];
+	static int s_threadCount;
+	static pthread_mutex_t s_mutex;
+	static pthread_cond_t s_cond;
+	static pthread_cond_t s_doneCond;
+	static bool s_quit;
+	static int s_generation;
+	static ThreadableJob * * s_jobs;
+	static int s_jobCount;
+
+} ;
+
+pthread_t PartRenderThreads::s_threads[PartRenderThreads::MaxThreads];
+int PartRenderThreads::s_threadCount = 0;
+pthread_mutex_t PartRenderThreads::s_mutex;
+pthread_cond_t PartRenderThreads::s_cond;
+pthread_cond_t PartRenderThreads::s_doneCond;
+bool PartRenderThreads::s_quit = false;
+int PartRenderThreads::s_generation = 0;
+ThreadableJob * * PartRenderThreads::s_jobs = NULL;
+int PartRenderThreads::s_jobCount = 0;
+
+
+
+
 class RemoteZynAddSubFx : public RemotePluginClient, public LocalZynAddSubFx
 {
 public:
@@ -57,6 +204,9 @@ public:
 	{
 		Nio::start();
 
+		PartRenderThreads::start();
+		setJobRunner( PartRenderThreads::runJobs );
+
 		setInputCount( 0 );
 		sendMessage( IdInitDone );
 		waitForMessage( IdInitDone );
@@ -67,6 +217,9 @@ public:
 
 	virtual ~RemoteZynAddSubFx()
 	{
+		setJobRunner( NULL );
+		PartRenderThreads::stop();
+
 		Nio::stop();
 	}
 
@@ -134,9 +287,9 @@ public:
 	}
 
 	// all functions are called while m_master->mutex is held
-	virtual void processMidiEvent( const MidiEvent& event, const f_cnt_t /* _offset */ )
+	virtual void processMidiEvent( const MidiEvent& event, const f_cnt_t _offset )
 	{
-		LocalZynAddSubFx::processMidiEvent( event );
+		LocalZynAddSubFx::processMidiEvent( event, _offset );
 	}
 
 
@@ -44,6 +44,7 @@
 #include "RemoteZynAddSubFx.h"
 #include "LocalZynAddSubFx.h"
 #include "Mixer.h"
+#include "MixerWorkerThread.h"
 #include "ControllerConnection.h"
 
 #include "embed.cpp"
@@ -358,11 +359,11 @@ bool ZynAddSubFxInstrument::handleMidiEvent( const MidiEvent& event, const MidiT
 	m_pluginMutex.lock();
 	if( m_remotePlugin )
 	{
-		m_remotePlugin->processMidiEvent( localEvent, 0 );
+		m_remotePlugin->processMidiEvent( localEvent, offset );
 	}
 	else
 	{
-		m_plugin->processMidiEvent( localEvent );
+		m_plugin->processMidiEvent( localEvent, offset );
 	}
 	m_pluginMutex.unlock();
 
@@ -462,6 +463,8 @@ void ZynAddSubFxInstrument::initPlugin()
 		m_plugin = new LocalZynAddSubFx;
 		m_plugin->setSampleRate( Engine::mixer()->processingSampleRate() );
 		m_plugin->setBufferSize( Engine::mixer()->framesPerPeriod() );
+		// let the mixer's worker threads render the parts
+		m_plugin->setJobRunner( MixerWorkerThread::processJobs );
 	}
 
 	m_pluginMutex.unlock();
@@ -53,6 +53,7 @@ Master::Master()
     swaplr = 0;
     off  = 0;
     smps = 0;
+    partRenderer = NULL;
     bufl = new float[synth->buffersize];
     bufr = new float[synth->buffersize];
 
@@ -322,6 +323,11 @@ void Master::partonoff(int npart, int what)
     }
 }
 
+void Master::setPartRenderer(PartRenderer *renderer)
+{
+    partRenderer = renderer;
+}
+
 /*
  * Master audio out (the final sound)
  */
@@ -336,12 +342,21 @@ void Master::AudioOut(float *outl, float *outr)
     memset(outr, 0, synth->bufferbytes);
 
     //Compute part samples and store them part[npart]->partoutl,partoutr
-    for(int npart = 0; npart < NUM_MIDI_PARTS; ++npart) {
-        if(part[npart]->Penabled != 0 && !pthread_mutex_trylock(&part[npart]->load_mutex)) {
-            part[npart]->ComputePartSmps();
-            pthread_mutex_unlock(&part[npart]->load_mutex);
-        }
-    }
+    //Parts don't share any state, so they may be rendered concurrently
+    Part *toRender[NUM_MIDI_PARTS];
+    int   renderCount = 0;
+    for(int npart = 0; npart < NUM_MIDI_PARTS; ++npart)
+        if(part[npart]->Penabled != 0 && !pthread_mutex_trylock(&part[npart]->load_mutex))
+            toRender[renderCount++] = part[npart];
+
+    if(partRenderer && renderCount > 1)
+        partRenderer->renderParts(toRender, renderCount);
+    else
+        for(int i = 0; i < renderCount; ++i)
+            toRender[i]->ComputePartSmps();
+
+    for(int i = 0; i < renderCount; ++i)
+        pthread_mutex_unlock(&toRender[i]->load_mutex);
 
     //Insertion effects
     for(int nefx = 0; nefx < NUM_INS_EFX; ++nefx)
@@ -117,6 +117,20 @@ class Master
 
         void partonoff(int npart, int what);
 
+        /**Renders a set of parts, possibly concurrently.
+         * renderParts() must not return before ComputePartSmps() has
+         * been called for every one of the given parts.*/
+        class PartRenderer
+        {
+            public:
+                virtual ~PartRenderer() {}
+                virtual void renderParts(class Part **parts, int count) = 0;
+        };
+
+        /**Installs a renderer for the parts, NULL renders them one after
+         * another in the calling thread*/
+        void setPartRenderer(PartRenderer *renderer);
+
         /**parts \todo see if this can be made to be dynamic*/
         class Part * part[NUM_MIDI_PARTS];
 
@@ -179,6 +193,8 @@ class Master
         float *bufr;
         off_t  off;
         size_t smps;
+
+        PartRenderer *partRenderer;
 };
 
 #endif
@@ -41,7 +41,7 @@
 #endif
 
 
-prng_t prng_state = 0x1234;
+ZYN_THREAD_LOCAL prng_t prng_state = 0x1234;
 
 Config config;
 float *denormalkillbuf;
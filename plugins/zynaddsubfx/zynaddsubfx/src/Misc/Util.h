@@ -83,8 +83,16 @@ T limit(T val, T min, T max)
 
 //Random number generator
 
+//Parts may be rendered by several threads at once, so every thread
+//gets a generator state of its own
+#ifdef _MSC_VER
+# define ZYN_THREAD_LOCAL __declspec(thread)
+#else
+# define ZYN_THREAD_LOCAL __thread
+#endif
+
 typedef uint32_t prng_t;
-extern prng_t prng_state;
+extern ZYN_THREAD_LOCAL prng_t prng_state;
 
 // Portable Pseudo-Random Number Generator
 inline prng_t prng_r(prng_t &p)
@@ -32,7 +32,7 @@
 #include "ProjectJournal.h"
 
 float AutomatableModel::s_copiedValue = 0;
-long AutomatableModel::s_periodCounter = 0;
+unsigned int AutomatableModel::s_periodCounter = 0;
 
 
 
@@ -520,11 +520,12 @@ float AutomatableModel::controllerValue( int frameOffset ) const
 }
 
 
-ValueBuffer * AutomatableModel::valueBuffer()
+ValueBuffer * AutomatableModel::updateValueBuffer()
 {
 	QMutexLocker m( &m_valueBufferMutex );
-	// if we've already calculated the valuebuffer this period, return the cached buffer
-	if( m_lastUpdatedPeriod == s_periodCounter )
+	// another thread might have calculated the valuebuffer while we were
+	// waiting for the lock - in this case return the cached buffer
+	if( isValueBufferCurrent() )
 	{
 		return m_hasSampleExactData
 			? &m_valueBuffer
@@ -560,8 +561,8 @@ ValueBuffer * AutomatableModel::valueBuffer()
 					"lacks implementation for a scale type");
 				break;
 			}
-			m_lastUpdatedPeriod = s_periodCounter;
 			m_hasSampleExactData = true;
+			publishValueBuffer();
 			return &m_valueBuffer;
 		}
 	}
@@ -579,8 +580,8 @@ ValueBuffer * AutomatableModel::valueBuffer()
 		{
 			nvalues[i] = fittedValue( values[i] );
 		}
-		m_lastUpdatedPeriod = s_periodCounter;
 		m_hasSampleExactData = true;
+		publishValueBuffer();
 		return &m_valueBuffer;
 	}
 
@@ -588,15 +589,15 @@ ValueBuffer * AutomatableModel::valueBuffer()
 	{
 		m_valueBuffer.interpolate( m_oldValue, val );
 		m_oldValue = val;
-		m_lastUpdatedPeriod = s_periodCounter;
 		m_hasSampleExactData = true;
+		publishValueBuffer();
 		return &m_valueBuffer;
 	}
 
 	// if we have no sample-exact source for a ValueBuffer, return NULL to signify that no data is available at the moment
 	// in which case the recipient knows to use the static value() instead
-	m_lastUpdatedPeriod = s_periodCounter;
 	m_hasSampleExactData = false;
+	publishValueBuffer();
 	return NULL;
 }
 
@@ -247,6 +247,33 @@ MidiTime AutomationPattern::putValue( const MidiTime & time,
 
 
 
+void AutomationPattern::putValues( const timeMap & values,
+						const bool quantPos )
+{
+	cleanObjects();
+
+	for( timeMap::const_iterator it = values.begin(); it != values.end();
+									++it )
+	{
+		const MidiTime newTime = quantPos ?
+				Note::quantized( it.key(), quantization() ) :
+				it.key();
+		m_timeMap[ newTime ] = it.value();
+	}
+
+	generateTangents();
+
+	if( getTrack() && getTrack()->type() == Track::HiddenAutomationTrack )
+	{
+		updateLength();
+	}
+
+	emit dataChanged();
+}
+
+
+
+
 void AutomationPattern::removeValue( const MidiTime & time )
 {
 	cleanObjects();
@@ -0,0 +1,396 @@
+/*
+ * BatchRenderer.cpp - renders a list of projects one after another without
+ *                     restarting the engine
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QIODevice>
+#include <QTimer>
+
+#include "BatchRenderer.h"
+#include "RenderManager.h"
+#include "SampleBuffer.h"
+#include "Song.h"
+
+
+QList<BatchRenderer::LoadedData> BatchRenderer::s_loadedData;
+bool BatchRenderer::s_running = false;
+
+
+
+
+BatchRenderer::BatchRenderer(
+		const Mixer::qualitySettings & qualitySettings,
+		const OutputSettings & outputSettings,
+		ProjectRenderer::ExportFileFormats fmt,
+		bool loop ) :
+	m_defaults( qualitySettings, outputSettings, fmt, loop ),
+	m_worker( 0 ),
+	m_workers( 1 ),
+	m_currentJob( -1 ),
+	m_failedJobs( 0 ),
+	m_renderManager( NULL ),
+	m_loadTime( 0 )
+{
+}
+
+
+
+
+BatchRenderer::~BatchRenderer()
+{
+	delete m_renderManager;
+
+	SampleBuffer::setDecodeCacheEnabled( false );
+
+	s_running = false;
+	for( const LoadedData & loaded : s_loadedData )
+	{
+		loaded.release( loaded.data );
+	}
+	s_loadedData.clear();
+}
+
+
+
+
+void BatchRenderer::setWorker( int worker, int workers )
+{
+	m_worker = worker;
+	m_workers = workers;
+}
+
+
+
+
+bool BatchRenderer::readJobs( QIODevice & device )
+{
+	int lineNum = 0;
+	int jobNum = 0;
+	while( !device.atEnd() )
+	{
+		const QString line =
+			QString::fromLocal8Bit( device.readLine() ).trimmed();
+		++lineNum;
+
+		if( line.isEmpty() || line.startsWith( '#' ) )
+		{
+			continue;
+		}
+
+		Job job( m_defaults );
+		job.line = lineNum;
+
+		QStringList fields = splitLine( line );
+		job.project = fields.takeFirst();
+		if( !fields.isEmpty() && !fields.first().contains( '=' ) )
+		{
+			job.output = fields.takeFirst();
+		}
+
+		for( const QString & option : fields )
+		{
+			if( !parseOption( job, option ) )
+			{
+				printf( "\nInvalid option \"%s\" in line %d of job "
+						"list.\n\n",
+					option.toUtf8().constData(), lineNum );
+				return false;
+			}
+		}
+
+		// guess format from output file if it wasn't given explicitly
+		if( !job.formatGiven && !job.tracks && !job.output.isEmpty() )
+		{
+			ProjectRenderer::parseFileFormat(
+				QFileInfo( job.output ).suffix().toLower(),
+								job.format );
+		}
+
+		const QFileInfo projectInfo( job.project );
+		const QString base = projectInfo.absolutePath() + "/" +
+						projectInfo.completeBaseName();
+		if( job.output.isEmpty() )
+		{
+			job.output = base;
+		}
+		if( !job.tracks )
+		{
+			// like --render, replace the extension by the one of the
+			// chosen format
+			const QFileInfo outputInfo( job.output );
+			job.output = outputInfo.absolutePath() + "/" +
+					outputInfo.completeBaseName() +
+			ProjectRenderer::getFileExtensionFromFormat( job.format );
+		}
+
+		if( jobNum++ % m_workers == m_worker )
+		{
+			m_jobs.append( job );
+		}
+	}
+
+	return true;
+}
+
+
+
+
+void BatchRenderer::start()
+{
+	SampleBuffer::setDecodeCacheEnabled( true );
+	s_running = true;
+
+	m_totalTimer.start();
+
+	QTimer::singleShot( 0, this, SLOT( startNextJob() ) );
+}
+
+
+
+
+bool BatchRenderer::isRunning()
+{
+	return s_running;
+}
+
+
+
+
+void BatchRenderer::keepLoaded( void * data, void (* release)( void * ) )
+{
+	LoadedData loaded = { data, release };
+	s_loadedData.append( loaded );
+}
+
+
+
+
+void BatchRenderer::startNextJob()
+{
+	// can't be deleted from within its finished() signal
+	delete m_renderManager;
+	m_renderManager = NULL;
+
+	while( ++m_currentJob < m_jobs.size() )
+	{
+		const Job & job = m_jobs[m_currentJob];
+
+		printf( "[%d/%d] Loading %s...\n", m_currentJob + 1,
+				m_jobs.size(), job.project.toUtf8().constData() );
+
+		m_jobTimer.start();
+
+		// Song::loadProject() keeps the previous project if it can't
+		// open the file, so check it here
+		const QFileInfo projectInfo( job.project );
+		if( !projectInfo.isFile() || projectInfo.size() == 0 )
+		{
+			printf( "[%d/%d] Can't read %s, skipping job from line "
+					"%d\n", m_currentJob + 1, m_jobs.size(),
+					job.project.toUtf8().constData(), job.line );
+			++m_failedJobs;
+			continue;
+		}
+
+		Engine::getSong()->loadProject( job.project );
+		if( Engine::getSong()->isEmpty() )
+		{
+			printf( "[%d/%d] The project %s is empty, skipping\n",
+					m_currentJob + 1, m_jobs.size(),
+					job.project.toUtf8().constData() );
+			++m_failedJobs;
+			continue;
+		}
+
+		m_loadTime = m_jobTimer.restart();
+
+		Engine::getSong()->setExportLoop( job.loop );
+
+		if( job.tracks )
+		{
+			QDir().mkpath( job.output );
+		}
+		else
+		{
+			QDir().mkpath( QFileInfo( job.output ).absolutePath() );
+			// so that we can tell whether rendering succeeded
+			QFile::remove( job.output );
+		}
+
+		m_renderManager = new RenderManager( job.qualitySettings,
+						job.outputSettings, job.format,
+						job.output );
+		connect( m_renderManager, SIGNAL( finished() ),
+					this, SLOT( jobFinished() ) );
+
+		// timer for progress-updates
+		QTimer * t = new QTimer( m_renderManager );
+		m_renderManager->connect( t, SIGNAL( timeout() ),
+					SLOT( updateConsoleProgress() ) );
+		t->start( 200 );
+
+		if( job.tracks )
+		{
+			m_renderManager->renderTracks();
+		}
+		else
+		{
+			m_renderManager->renderProject();
+		}
+		return;
+	}
+
+	printf( "\nRendered %d of %d jobs in %.2f s\n",
+			m_jobs.size() - m_failedJobs, m_jobs.size(),
+			m_totalTimer.elapsed() / 1000.0 );
+
+	emit finished();
+}
+
+
+
+
+void BatchRenderer::jobFinished()
+{
+	const qint64 renderTime = m_jobTimer.elapsed();
+	const Job & job = m_jobs[m_currentJob];
+
+	if( job.tracks || QFileInfo( job.output ).exists() )
+	{
+		printf( "\n[%d/%d] %s: loaded in %.2f s, rendered in %.2f s\n",
+				m_currentJob + 1, m_jobs.size(),
+				job.output.toUtf8().constData(),
+				m_loadTime / 1000.0, renderTime / 1000.0 );
+	}
+	else
+	{
+		printf( "\n[%d/%d] Failed to render %s\n",
+				m_currentJob + 1, m_jobs.size(),
+				job.output.toUtf8().constData() );
+		++m_failedJobs;
+	}
+
+	QTimer::singleShot( 0, this, SLOT( startNextJob() ) );
+}
+
+
+
+
+QStringList BatchRenderer::splitLine( const QString & line )
+{
+	QStringList fields;
+	QString field;
+	bool quoted = false;
+	bool inField = false;
+
+	for( const QChar c : line )
+	{
+		if( c == '"' )
+		{
+			quoted = !quoted;
+			inField = true;
+		}
+		else if( c.isSpace() && !quoted )
+		{
+			if( inField )
+			{
+				fields << field;
+				field.clear();
+				inField = false;
+			}
+		}
+		else
+		{
+			field += c;
+			inField = true;
+		}
+	}
+	if( inField )
+	{
+		fields << field;
+	}
+
+	return fields;
+}
+
+
+
+
+bool BatchRenderer::parseOption( Job & job, const QString & option )
+{
+	const int sep = option.indexOf( '=' );
+	if( sep <= 0 )
+	{
+		return false;
+	}
+
+	const QString key = option.left( sep );
+	const QString value = option.mid( sep + 1 );
+
+	// the same values as the corresponding command line options
+	if( key == "format" )
+	{
+		job.formatGiven = true;
+		return ProjectRenderer::parseFileFormat( value, job.format );
+	}
+	else if( key == "samplerate" )
+	{
+		return ProjectRenderer::parseSampleRate( value,
+							job.outputSettings );
+	}
+	else if( key == "bitrate" )
+	{
+		return ProjectRenderer::parseBitRate( value, job.outputSettings );
+	}
+	else if( key == "float" )
+	{
+		job.outputSettings.setBitDepth( value.toInt() ?
+						OutputSettings::Depth_32Bit :
+						OutputSettings::Depth_16Bit );
+	}
+	else if( key == "interpolation" )
+	{
+		return ProjectRenderer::parseInterpolation( value,
+							job.qualitySettings );
+	}
+	else if( key == "oversampling" )
+	{
+		return ProjectRenderer::parseOversampling( value,
+							job.qualitySettings );
+	}
+	else if( key == "loop" )
+	{
+		job.loop = value.toInt() != 0;
+	}
+	else if( key == "tracks" )
+	{
+		job.tracks = value.toInt() != 0;
+	}
+	else
+	{
+		return false;
+	}
+
+	return true;
+}
@@ -27,20 +27,46 @@
 #include "BufferManager.h"
 
 #include "Engine.h"
+#include "LocklessAllocator.h"
 #include "Mixer.h"
 #include "MemoryManager.h"
 
 static fpp_t framesPerPeriod;
 
+// period-sized buffers recycled by acquire() and release() so that creating
+// play handles and audio ports doesn't have to go through the allocator -
+// enough for the audio ports and the notes of a busy project, anything
+// beyond that falls back to the allocator
+static LocklessAllocator * bufferPool = NULL;
+static const int BUFFER_POOL_SIZE = 256;
+
 void BufferManager::init( fpp_t framesPerPeriod )
 {
+	if( bufferPool != NULL && framesPerPeriod != ::framesPerPeriod )
+	{
+		// the pooled buffers are too small or too large now - this is
+		// only called when the mixer is set up, before any buffer is
+		// acquired, so the pool can simply be replaced
+		delete bufferPool;
+		bufferPool = NULL;
+	}
+
 	::framesPerPeriod = framesPerPeriod;
+
+	if( bufferPool == NULL )
+	{
+		bufferPool = new LocklessAllocator( BUFFER_POOL_SIZE,
+				framesPerPeriod * sizeof( sampleFrame ) );
+	}
 }
 
 
 sampleFrame * BufferManager::acquire()
 {
-	return MM_ALLOC( sampleFrame, ::framesPerPeriod );
+	sampleFrame * buf = bufferPool ?
+		static_cast<sampleFrame *>( bufferPool->tryAlloc() ) : NULL;
+	// fall back to the allocator if all pooled buffers are in use
+	return buf ? buf : MM_ALLOC( sampleFrame, ::framesPerPeriod );
 }
 
 void BufferManager::clear( sampleFrame *ab, const f_cnt_t frames, const f_cnt_t offset )
@@ -59,6 +85,13 @@ void BufferManager::clear( surroundSampleFrame * ab, const f_cnt_t frames,
 
 void BufferManager::release( sampleFrame * buf )
 {
-	MM_FREE( buf );
+	if( bufferPool && bufferPool->contains( buf ) )
+	{
+		bufferPool->free( buf );
+	}
+	else
+	{
+		MM_FREE( buf );
+	}
 }
 
@@ -32,6 +32,7 @@
 #include <QFile>
 #include <QFileInfo>
 #include <QMessageBox>
+#include <QThread>
 
 #include "base64.h"
 #include "ConfigManager.h"
@@ -45,6 +46,11 @@
 
 #include "lmmsversion.h"
 
+#ifndef LMMS_BUILD_WIN32
+#include <stdio.h>
+#include <unistd.h>
+#endif
+
 static void findIds(const QDomElement& elem, QList<jo_id_t>& idList);
 
 
@@ -269,62 +275,244 @@ void DataFile::write( QTextStream & _strm )
 bool DataFile::writeFile( const QString& filename )
 {
 	const QString fullName = nameWithExtension( filename );
-	const QString fullNameTemp = fullName + ".new";
-	const QString fullNameBak = fullName + ".bak";
+	const bool keepBackup = !ConfigManager::inst()->value( "app", "disablebackup" ).toInt();
 
-	QFile outfile( fullNameTemp );
+	bool opened;
+	const bool written = writeFileData( fullName, toByteArray(), keepBackup,
+								opened );
+	if( !written )
+	{
+		showWriteError( fullName, opened );
+	}
+
+	return written;
+}
+
+
+
+
+class DataFile::BackgroundWriter : public QThread
+{
+public:
+	BackgroundWriter( DataFile * dataFile, const QString& fullName,
+							bool keepBackup ) :
+		m_dataFile( dataFile ),
+		m_fullName( fullName ),
+		m_keepBackup( keepBackup ),
+		m_opened( false ),
+		m_written( false )
+	{
+	}
 
-	if( !outfile.open( QIODevice::WriteOnly | QIODevice::Truncate ) )
+	virtual ~BackgroundWriter()
 	{
-		if( gui )
+		delete m_dataFile;
+	}
+
+	// only valid once the thread has finished - nobody's waiting for
+	// a background write, so it's not worth a message box
+	void reportError() const
+	{
+		if( !m_written && gui )
 		{
-			QMessageBox::critical( NULL,
+			TextFloat::displayMessage(
 				SongEditor::tr( "Could not write file" ),
-				SongEditor::tr( "Could not open %1 for writing. You probably are not permitted to "
-								"write to this file. Please make sure you have write-access to "
-								"the file and try again." ).arg( fullName ) );
+				( m_opened ?
+					SongEditor::tr( "An error occurred while "
+						"writing %1. The previous version "
+						"of the file has been kept." ) :
+					SongEditor::tr( "Could not open %1 for "
+						"writing." ) ).arg( m_fullName ),
+				embed::getIconPixmap( "error", 24, 24 ),
+									4000 );
+		}
+	}
+
+protected:
+	virtual void run()
+	{
+		// the document has been handed over to us - QDomDocument
+		// isn't thread-safe, but nobody else has a reference to it
+		m_written = writeFileData( m_fullName, m_dataFile->toByteArray(),
+						m_keepBackup, m_opened );
+		if( !m_written )
+		{
+			qWarning( "Could not write %s", qPrintable( m_fullName ) );
 		}
+	}
+
+private:
+	DataFile * m_dataFile;
+	const QString m_fullName;
+	const bool m_keepBackup;
+	bool m_opened;
+	bool m_written;
+
+} ;
+
+
+DataFile::BackgroundWriter * DataFile::s_backgroundWriter = NULL;
+
+
+
+
+bool DataFile::isWritingInBackground()
+{
+	return s_backgroundWriter && s_backgroundWriter->isRunning();
+}
+
+
 
+
+bool DataFile::writeFileInBackground( DataFile * dataFile,
+						const QString& filename )
+{
+	if( isWritingInBackground() )
+	{
+		delete dataFile;
 		return false;
 	}
+	waitForBackgroundWrite();
+
+	s_backgroundWriter = new BackgroundWriter( dataFile,
+		dataFile->nameWithExtension( filename ),
+		!ConfigManager::inst()->value( "app", "disablebackup" ).toInt() );
+	s_backgroundWriter->start( QThread::LowPriority );
+
+	return true;
+}
+
+
+
 
-	if( fullName.section( '.', -1 ) == "mmpz" )
+void DataFile::waitForBackgroundWrite()
+{
+	if( s_backgroundWriter )
 	{
-		QString xml;
-		QTextStream ts( &xml );
-		write( ts );
-		outfile.write( qCompress( xml.toUtf8() ) );
+		s_backgroundWriter->wait();
+		s_backgroundWriter->reportError();
+		delete s_backgroundWriter;
+		s_backgroundWriter = NULL;
 	}
-	else
+}
+
+
+
+
+QByteArray DataFile::toByteArray()
+{
+	QString xml;
+	QTextStream ts( &xml );
+	write( ts );
+	ts.flush();
+
+	return xml.toUtf8();
+}
+
+
+
+
+bool DataFile::writeFileData( const QString& fullName, const QByteArray& xml,
+						bool keepBackup, bool& opened )
+{
+	const QString fullNameTemp = fullName + ".new";
+	const QString fullNameBak = fullName + ".bak";
+
+	QFile outfile( fullNameTemp );
+
+	opened = outfile.open( QIODevice::WriteOnly | QIODevice::Truncate );
+	if( !opened )
 	{
-		QTextStream ts( &outfile );
-		write( ts );
+		return false;
 	}
 
+	const QByteArray data = fullName.section( '.', -1 ) == "mmpz" ?
+						qCompress( xml ) : xml;
+	bool written = outfile.write( data ) == data.size() && outfile.flush();
+#ifndef LMMS_BUILD_WIN32
+	// make sure the data has hit the disk before we replace the old file
+	written = written && fsync( outfile.handle() ) == 0;
+#endif
 	outfile.close();
 
 	// make sure the file has been written correctly
-	if( QFileInfo( outfile.fileName() ).size() > 0 )
+	if( !written || QFileInfo( outfile.fileName() ).size() == 0 )
 	{
-		if( ConfigManager::inst()->value( "app", "disablebackup" ).toInt() )
+		QFile::remove( fullNameTemp );
+		return false;
+	}
+
+#ifdef LMMS_BUILD_WIN32
+	if( !keepBackup )
+	{
+		// remove current file
+		QFile::remove( fullName );
+	}
+	else if( QFile::exists( fullName ) )
+	{
+		// remove old backup file
+		QFile::remove( fullNameBak );
+		// move current file to backup file
+		if( !QFile::rename( fullName, fullNameBak ) )
 		{
-			// remove current file
-			QFile::remove( fullName );
+			return false;
 		}
-		else
+	}
+	// move temporary file to current file
+	return QFile::rename( fullNameTemp, fullName );
+#else
+	if( keepBackup && QFile::exists( fullName ) )
+	{
+		// keep a second link to the current file as backup, or a copy
+		// if the file system doesn't support hard links
+		QFile::remove( fullNameBak );
+		if( ::link( QFile::encodeName( fullName ).constData(),
+				QFile::encodeName( fullNameBak ).constData() ) != 0 &&
+					!QFile::copy( fullName, fullNameBak ) )
 		{
-			// remove old backup file
-			QFile::remove( fullNameBak );
-			// move current file to backup file
-			QFile::rename( fullName, fullNameBak );
+			perror( "link" );
+			return false;
 		}
-		// move temporary file to current file
-		QFile::rename( fullNameTemp, fullName );
+	}
+	// atomically replace the current file, so there's a complete
+	// project on disk at any time
+	if( ::rename( QFile::encodeName( fullNameTemp ).constData(),
+			QFile::encodeName( fullName ).constData() ) != 0 )
+	{
+		perror( "rename" );
+		return false;
+	}
+
+	return true;
+#endif
+}
+
 
-		return true;
+
+
+void DataFile::showWriteError( const QString& fullName, bool opened )
+{
+	if( !gui )
+	{
+		return;
 	}
 
-	return false;
+	if( !opened )
+	{
+		QMessageBox::critical( NULL,
+			SongEditor::tr( "Could not write file" ),
+			SongEditor::tr( "Could not open %1 for writing. You probably are not permitted to "
+							"write to this file. Please make sure you have write-access to "
+							"the file and try again." ).arg( fullName ) );
+	}
+	else
+	{
+		QMessageBox::critical( NULL,
+			SongEditor::tr( "Could not write file" ),
+			SongEditor::tr( "An error occurred while writing %1. The previous version "
+							"of the file has been kept. Please make sure there is "
+							"enough free space on the disk and try again." ).arg( fullName ) );
+	}
 }
 
 
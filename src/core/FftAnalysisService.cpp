@@ -0,0 +1,192 @@
+/*
+ * FftAnalysisService.cpp - low priority thread doing spectrum analysis for
+ *                          the GUI off the audio thread
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include "FftAnalysisService.h"
+
+#include <string.h>
+
+#include "MemoryManager.h"
+
+
+// size of each client's ring buffer in windows - must result in a power of 2
+static const int RING_WINDOWS = 4;
+
+// how often the analysis thread looks for new data (ms)
+static const int ANALYSIS_INTERVAL = 15;
+
+
+FftAnalysisService * FftAnalysisService::s_instance = NULL;
+
+
+
+FftAnalysisService::Client::Client( int windowSize ) :
+	m_windowSize( windowSize ),
+	m_writePos( 0 ),
+	m_readPos( 0 )
+{
+	m_ring = MM_ALLOC( sampleFrame, m_windowSize * RING_WINDOWS );
+	m_window = MM_ALLOC( sampleFrame, m_windowSize );
+	memset( m_ring, 0, m_windowSize * RING_WINDOWS * sizeof( sampleFrame ) );
+}
+
+
+
+
+FftAnalysisService::Client::~Client()
+{
+	MM_FREE( m_ring );
+	MM_FREE( m_window );
+}
+
+
+
+
+void FftAnalysisService::Client::pushFrames( const sampleFrame * buf, const fpp_t frames )
+{
+	const int ringSize = m_windowSize * RING_WINDOWS;
+	const unsigned int writePos = (int) m_writePos;
+	const unsigned int readPos = m_readPos.loadAcquire();
+
+	const int space = ringSize - static_cast<int>( writePos - readPos );
+	const int toWrite = qMin<int>( frames, space );
+
+	for( int f = 0; f < toWrite; ++f )
+	{
+		const int pos = ( writePos + f ) & ( ringSize - 1 );
+		m_ring[pos][0] = buf[f][0];
+		m_ring[pos][1] = buf[f][1];
+	}
+
+	m_writePos.storeRelease( writePos + toWrite );
+}
+
+
+
+
+bool FftAnalysisService::Client::fetchWindow()
+{
+	const int ringSize = m_windowSize * RING_WINDOWS;
+	const unsigned int writePos = m_writePos.loadAcquire();
+	unsigned int readPos = (int) m_readPos;
+
+	const int available = static_cast<int>( writePos - readPos );
+	if( available < m_windowSize )
+	{
+		return false;
+	}
+
+	// we're only interested in the latest complete window
+	readPos += ( available / m_windowSize - 1 ) * m_windowSize;
+
+	for( int f = 0; f < m_windowSize; ++f )
+	{
+		const int pos = ( readPos + f ) & ( ringSize - 1 );
+		m_window[f][0] = m_ring[pos][0];
+		m_window[f][1] = m_ring[pos][1];
+	}
+
+	m_readPos.storeRelease( readPos + m_windowSize );
+
+	return true;
+}
+
+
+
+
+FftAnalysisService::FftAnalysisService() :
+	QThread(),
+	m_quit( false )
+{
+}
+
+
+
+
+FftAnalysisService::~FftAnalysisService()
+{
+}
+
+
+
+
+void FftAnalysisService::addClient( Client * client )
+{
+	if( s_instance == NULL )
+	{
+		s_instance = new FftAnalysisService;
+	}
+
+	s_instance->m_clientsMutex.lock();
+	s_instance->m_clients.append( client );
+	s_instance->m_clientsMutex.unlock();
+
+	if( !s_instance->isRunning() )
+	{
+		s_instance->m_quit = false;
+		s_instance->start( QThread::LowestPriority );
+	}
+}
+
+
+
+
+void FftAnalysisService::removeClient( Client * client )
+{
+	if( s_instance == NULL )
+	{
+		return;
+	}
+
+	s_instance->m_clientsMutex.lock();
+	s_instance->m_clients.removeAll( client );
+	const bool idle = s_instance->m_clients.isEmpty();
+	s_instance->m_clientsMutex.unlock();
+
+	if( idle )
+	{
+		s_instance->m_quit = true;
+		s_instance->wait();
+	}
+}
+
+
+
+
+void FftAnalysisService::run()
+{
+	while( !m_quit )
+	{
+		m_clientsMutex.lock();
+		for( QList<Client *>::ConstIterator it = m_clients.begin();
+						it != m_clients.end(); ++it )
+		{
+			if( ( *it )->fetchWindow() )
+			{
+				( *it )->analyzeWindow( ( *it )->m_window, ( *it )->m_windowSize );
+			}
+		}
+		m_clientsMutex.unlock();
+
+		msleep( ANALYSIS_INTERVAL );
+	}
+}
@@ -0,0 +1,327 @@
+/*
+ * FreezeCache.cpp - post-effect render cache of a frozen instrument track
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include "FreezeCache.h"
+
+#include <string.h>
+
+#include <QtCore/QDataStream>
+#include <QtCore/QFile>
+#include <QtCore/QFileInfo>
+
+#include "Engine.h"
+#include "Mixer.h"
+#include "MixHelpers.h"
+#include "Song.h"
+
+
+// header of cache files, "LFZC" followed by the format version
+static const quint32 FileMagic = 0x4c465a43;
+static const qint32 FileVersion = 1;
+
+
+FreezeCache::FreezeCache() :
+	m_data( NULL ),
+	m_frames( 0 ),
+	m_sampleRate( 0 ),
+	m_lengthTicks( 0 ),
+	m_lastTick( -1 ),
+	m_position( 0 ),
+	m_positionValid( false ),
+	m_recordedUpTo( 0 ),
+	m_recording( false ),
+	m_complete( false )
+{
+}
+
+
+
+
+FreezeCache::~FreezeCache()
+{
+	MM_FREE( m_data );
+}
+
+
+
+
+void FreezeCache::startRecording( tick_t lengthTicks )
+{
+	// the song skips the fractional frame at the end of every tick, so
+	// a tick never lasts longer than framesPerTick() + 1 frames at the
+	// tempo we start with - process() makes room if tempo automation
+	// slows things down
+	const f_cnt_t frames = ( lengthTicks + 1 ) *
+			( static_cast<f_cnt_t>( Engine::framesPerTick() ) + 1 ) +
+					Engine::mixer()->framesPerPeriod();
+
+	if( frames != m_frames )
+	{
+		MM_FREE( m_data );
+		m_data = MM_ALLOC( sampleFrame, frames );
+		m_frames = frames;
+	}
+	memset( m_data, 0, sizeof( sampleFrame ) * m_frames );
+
+	m_sampleRate = Engine::mixer()->processingSampleRate();
+	m_tickFrames.fill( -1, lengthTicks + 1 );
+	m_lengthTicks = lengthTicks;
+	m_lastTick = -1;
+	m_positionValid = false;
+	m_recordedUpTo = 0;
+	m_recording = true;
+	m_complete = false;
+}
+
+
+
+
+bool FreezeCache::finishRecording()
+{
+	m_recording = false;
+	m_positionValid = false;
+
+	const f_cnt_t endFrame = m_tickFrames.value( m_lengthTicks, -1 );
+	m_complete = endFrame >= 0 && m_recordedUpTo >= endFrame;
+
+	return m_complete;
+}
+
+
+
+
+void FreezeCache::sync( tick_t tick, f_cnt_t offset )
+{
+	if( m_recording )
+	{
+		// the render plays the song straight through from tick 0
+		if( tick == 0 )
+		{
+			m_position = -offset;
+			m_positionValid = true;
+		}
+		if( m_positionValid && tick < m_tickFrames.size() &&
+						m_tickFrames[tick] < 0 )
+		{
+			m_tickFrames[tick] = m_position + offset;
+		}
+	}
+	else if( m_complete && tick < m_tickFrames.size() &&
+			m_tickFrames[tick] >= 0 &&
+			m_sampleRate == Engine::mixer()->processingSampleRate() )
+	{
+		// this also catches jumps and loops
+		m_position = m_tickFrames[tick] - offset;
+		m_positionValid = true;
+	}
+	else
+	{
+		// past the end of the cache or not rendered for this rate
+		m_positionValid = false;
+	}
+
+	m_lastTick = tick;
+}
+
+
+
+
+bool FreezeCache::process( sampleFrame * buf, fpp_t frames, bool hasAudio )
+{
+	if( !songIsPlaying() )
+	{
+		m_positionValid = false;
+		return false;
+	}
+	if( !m_positionValid || m_data == NULL )
+	{
+		return false;
+	}
+
+	// the render isn't realtime, so there's no harm in allocating here
+	if( m_recording && m_position + frames > m_frames )
+	{
+		const f_cnt_t size = qMax( m_frames * 2, m_position + frames );
+		sampleFrame * data = MM_ALLOC( sampleFrame, size );
+		memcpy( data, m_data, sizeof( sampleFrame ) * m_frames );
+		memset( data + m_frames, 0,
+				sizeof( sampleFrame ) * ( size - m_frames ) );
+		MM_FREE( m_data );
+		m_data = data;
+		m_frames = size;
+	}
+
+	// part of this period that lies within the cache
+	const f_cnt_t first = qMax<f_cnt_t>( 0, -m_position );
+	const f_cnt_t last = qMin<f_cnt_t>( frames, m_frames - m_position );
+
+	bool streamed = false;
+	if( m_recording )
+	{
+		if( m_position <= m_recordedUpTo &&
+				m_recordedUpTo < m_position + frames &&
+							first < last )
+		{
+			if( hasAudio )
+			{
+				memcpy( m_data + m_position + first, buf + first,
+					sizeof( sampleFrame ) * ( last - first ) );
+			}
+			else
+			{
+				memset( m_data + m_position + first, 0,
+					sizeof( sampleFrame ) * ( last - first ) );
+			}
+			m_recordedUpTo = m_position + last;
+		}
+	}
+	else if( m_complete && first < last )
+	{
+		MixHelpers::add( buf + first, m_data + m_position + first,
+								last - first );
+		streamed = true;
+	}
+
+	m_position += frames;
+	return streamed;
+}
+
+
+
+
+
+void FreezeCache::skip( fpp_t frames )
+{
+	if( !songIsPlaying() )
+	{
+		m_positionValid = false;
+		return;
+	}
+	if( m_positionValid )
+	{
+		m_position += frames;
+	}
+}
+
+
+
+
+bool FreezeCache::songIsPlaying() const
+{
+	const Song * song = Engine::getSong();
+	return song->isPlaying() && song->playMode() == Song::Mode_PlaySong;
+}
+
+
+
+
+bool FreezeCache::save( const QString & file ) const
+{
+	if( !m_complete )
+	{
+		return false;
+	}
+
+	QFile f( file );
+	if( !f.open( QIODevice::WriteOnly ) )
+	{
+		return false;
+	}
+
+	QDataStream out( &f );
+	out.setFloatingPointPrecision( QDataStream::SinglePrecision );
+	out << FileMagic << FileVersion << static_cast<quint32>( m_sampleRate )
+		<< static_cast<qint32>( m_lengthTicks ) << m_tickFrames
+		<< static_cast<qint32>( m_recordedUpTo );
+
+	for( f_cnt_t frame = 0; frame < m_recordedUpTo; ++frame )
+	{
+		out << m_data[frame][0] << m_data[frame][1];
+	}
+
+	return out.status() == QDataStream::Ok;
+}
+
+
+
+
+bool FreezeCache::load( const QString & file )
+{
+	QFile f( file );
+	if( !f.open( QIODevice::ReadOnly ) )
+	{
+		return false;
+	}
+
+	QDataStream in( &f );
+	in.setFloatingPointPrecision( QDataStream::SinglePrecision );
+
+	quint32 magic;
+	qint32 version;
+	quint32 sampleRate;
+	qint32 lengthTicks;
+	QVector<f_cnt_t> tickFrames;
+	qint32 frames;
+	in >> magic >> version >> sampleRate >> lengthTicks >> tickFrames >> frames;
+
+	if( in.status() != QDataStream::Ok || magic != FileMagic ||
+			version != FileVersion || lengthTicks < 0 ||
+			tickFrames.size() != lengthTicks + 1 || frames <= 0 )
+	{
+		return false;
+	}
+
+	sampleFrame * data = MM_ALLOC( sampleFrame, frames );
+	for( f_cnt_t frame = 0; frame < frames; ++frame )
+	{
+		in >> data[frame][0] >> data[frame][1];
+	}
+
+	if( in.status() != QDataStream::Ok )
+	{
+		MM_FREE( data );
+		return false;
+	}
+
+	MM_FREE( m_data );
+	m_data = data;
+	m_frames = frames;
+	m_sampleRate = sampleRate;
+	m_tickFrames = tickFrames;
+	m_lengthTicks = lengthTicks;
+	m_lastTick = -1;
+	m_positionValid = false;
+	m_recordedUpTo = frames;
+	m_recording = false;
+	m_complete = true;
+
+	return true;
+}
+
+
+
+
+QString FreezeCache::directoryFor( const QString & projectFile )
+{
+	const QFileInfo info( projectFile );
+	return info.absolutePath() + "/" + info.completeBaseName() + "-frozen";
+}
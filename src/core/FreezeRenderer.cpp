@@ -0,0 +1,156 @@
+/*
+ * FreezeRenderer.cpp - renders the song into the freeze cache of a track
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+
+#include "FreezeRenderer.h"
+
+#include "AudioDevice.h"
+#include "Engine.h"
+#include "InstrumentTrack.h"
+#include "Mixer.h"
+#include "Song.h"
+
+
+
+FreezeRenderer::FreezeRenderer( InstrumentTrack * track ) :
+	QThread( Engine::mixer() ),
+	m_track( track ),
+	m_device( NULL ),
+	m_lengthTicks( track->freezeLength() ),
+	m_trackWasMuted( false ),
+	m_progress( 0 ),
+	m_abort( false )
+{
+	connect( this, SIGNAL( finished() ),
+			this, SLOT( finishProcessing() ), Qt::QueuedConnection );
+}
+
+
+
+
+FreezeRenderer::~FreezeRenderer()
+{
+}
+
+
+
+
+void FreezeRenderer::startProcessing()
+{
+	Song * song = Engine::getSong();
+
+	// other tracks would only cost time - automation has to play along
+	// though as it's part of what's being rendered
+	for( Track * track : song->tracks() )
+	{
+		if( track != m_track && track->type() != Track::AutomationTrack &&
+							!track->isMuted() )
+		{
+			track->setMuted( true );
+			m_mutedTracks.push_back( track );
+		}
+	}
+	m_trackWasMuted = m_track->isMuted();
+	m_track->setMuted( false );
+
+	song->setRenderBetweenMarkers( false );
+	m_track->startFreezing();
+
+	// have to do mixer stuff with GUI-thread-affinity in order to make
+	// slots connected to sampleRateChanged()-signals being called
+	// immediately - a plain AudioDevice just drops what it's given
+	Mixer * mixer = Engine::mixer();
+	mixer->storeAudioDevice();
+	m_device = new AudioDevice( DEFAULT_CHANNELS, mixer );
+	mixer->setAudioDevice( m_device, mixer->currentQualitySettings(),
+									false );
+
+	start(
+#ifndef LMMS_BUILD_WIN32
+		QThread::HighPriority
+#endif
+				);
+}
+
+
+
+
+void FreezeRenderer::abortProcessing()
+{
+	m_abort = true;
+	wait();
+}
+
+
+
+
+void FreezeRenderer::run()
+{
+	MemoryManager::ThreadGuard mmThreadGuard; Q_UNUSED(mmThreadGuard);
+	Mixer::setupThread();
+
+	Song * song = Engine::getSong();
+	song->startExport();
+
+	const Song::PlayPos & pos = song->getPlayPos( Song::Mode_PlaySong );
+	m_progress = 0;
+
+	// the cache needs to know where the tick after the last one starts,
+	// so render until we're past it
+	while( pos.getTicks() <= m_lengthTicks && song->isExporting() &&
+								!m_abort )
+	{
+		m_device->processNextBuffer();
+		const int progress = qMin<int>( pos.getTicks() * 100 /
+						qMax<tick_t>( m_lengthTicks, 1 ), 100 );
+		if( m_progress != progress )
+		{
+			m_progress = progress;
+			emit progressChanged( m_progress );
+		}
+	}
+
+	// notify mixer of the end of processing
+	Engine::mixer()->stopProcessing();
+
+	song->stopExport();
+}
+
+
+
+
+void FreezeRenderer::finishProcessing()
+{
+	// deletes our device
+	Engine::mixer()->restoreAudioDevice();
+	m_device = NULL;
+
+	for( Track * track : m_mutedTracks )
+	{
+		track->setMuted( false );
+	}
+	m_mutedTracks.clear();
+	m_track->setMuted( m_trackWasMuted );
+
+	// an aborted render is incomplete and gets dropped by the track
+	emit finishedFreezing( m_track->finishFreezing() );
+}
@@ -61,8 +61,6 @@ FxChannel::FxChannel( int idx, Model * _parent ) :
 	m_fxChain( NULL ),
 	m_hasInput( false ),
 	m_stillRunning( false ),
-	m_peakLeft( 0.0f ),
-	m_peakRight( 0.0f ),
 	m_buffer( new sampleFrame[Engine::mixer()->framesPerPeriod()] ),
 	m_muteModel( false, _parent ),
 	m_soloModel( false, _parent ),
@@ -178,12 +176,12 @@ void FxChannel::doProcessing()
 		float peakLeft = 0.;
 		float peakRight = 0.;
 		Engine::mixer()->getPeakValues( m_buffer, fpp, peakLeft, peakRight );
-		m_peakLeft = qMax( m_peakLeft, peakLeft * v );
-		m_peakRight = qMax( m_peakRight, peakRight * v );
+		publishMeter( peakLeft * v, peakRight * v );
 	}
 	else
 	{
-		m_peakLeft = m_peakRight = 0.0f;
+		m_peaks = FxChannelMeter();
+		publishMeter( 0.0f, 0.0f );
 	}
 
 	// increment dependency counter of all receivers
@@ -192,6 +190,37 @@ void FxChannel::doProcessing()
 
 
 
+
+void FxChannel::publishMeter( float peakLeft, float peakRight )
+{
+	if( m_meter.isConsumed() )
+	{
+		// the GUI has seen everything so far, start over
+		m_peaks = FxChannelMeter();
+	}
+
+	m_peaks.peakLeft = qMax( m_peaks.peakLeft, peakLeft );
+	m_peaks.peakRight = qMax( m_peaks.peakRight, peakRight );
+
+	m_meter.writeBuffer() = m_peaks;
+	m_meter.publish();
+}
+
+
+
+
+bool FxChannel::pollMeter( FxChannelMeter & meter )
+{
+	if( !m_meter.update() )
+	{
+		return false;
+	}
+	meter = m_meter.readBuffer();
+	return true;
+}
+
+
+
 FxMixer::FxMixer() :
 	Model( NULL ),
 	JournallingObject(),
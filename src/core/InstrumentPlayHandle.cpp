@@ -28,7 +28,8 @@
 
 InstrumentPlayHandle::InstrumentPlayHandle( Instrument * instrument, InstrumentTrack* instrumentTrack ) :
 		PlayHandle( TypeInstrumentPlayHandle ),
-		m_instrument( instrument )
+		m_instrument( instrument ),
+		m_liveFrames( 0 )
 {
 	setAudioPort( instrumentTrack->audioPort() );
 }
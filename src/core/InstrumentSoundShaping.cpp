@@ -37,6 +37,9 @@
 const float CUT_FREQ_MULTIPLIER = 6000.0f;
 const float RES_MULTIPLIER = 2.0f;
 const float RES_PRECISION = 1000.0f;
+// number of frames between filter coefficient updates when cutoff or
+// resonance are modulated by an envelope/LFO
+const fpp_t FILTER_CONTROL_FRAMES = 16;
 
 
 // names for env- and lfo-targets - first is name being displayed to user
@@ -143,11 +146,8 @@ void InstrumentSoundShaping::processAudioBuffer( sampleFrame* buffer,
 		envReleaseBegin += frames;
 	}
 
-	// because of optimizations, there's special code for several cases:
-	// 	- cut- and res-lfo/envelope active
-	// 	- cut-lfo/envelope active
-	// 	- res-lfo/envelope active
-	//	- no lfo/envelope active but filter is used
+	// the filter is run block-wise: either over the whole period with
+	// static coefficients or, if cut/res are modulated, in control blocks
 
 	// only use filter, if it is really needed
 
@@ -156,8 +156,8 @@ void InstrumentSoundShaping::processAudioBuffer( sampleFrame* buffer,
 		float cutBuffer [frames];
 		float resBuffer [frames];
 
-		int old_filter_cut = 0;
-		int old_filter_res = 0;
+		int old_filter_cut = -1;
+		int old_filter_res = -1;
 
 		if( n->m_filter == NULL )
 		{
@@ -177,70 +177,46 @@ void InstrumentSoundShaping::processAudioBuffer( sampleFrame* buffer,
 		const float fcv = m_filterCutModel.value();
 		const float frv = m_filterResModel.value();
 
-		if( m_envLfoParameters[Cut]->isUsed() &&
-			m_envLfoParameters[Resonance]->isUsed() )
+		const bool cutUsed = m_envLfoParameters[Cut]->isUsed();
+		const bool resUsed = m_envLfoParameters[Resonance]->isUsed();
+
+		if( cutUsed || resUsed )
 		{
-			for( fpp_t frame = 0; frame < frames; ++frame )
+			// envelopes/LFOs are applied at control rate: the coefficients
+			// are calculated for the last frame of each control block and
+			// interpolated linearly from the ones of the previous block
+			for( fpp_t frame = 0; frame < frames; frame += FILTER_CONTROL_FRAMES )
 			{
-				const float new_cut_val = EnvelopeAndLfoParameters::expKnobVal( cutBuffer[frame] ) *
-								CUT_FREQ_MULTIPLIER + fcv;
+				const fpp_t blockFrames = qMin<fpp_t>( FILTER_CONTROL_FRAMES, frames - frame );
+				const fpp_t last = frame + blockFrames - 1;
+
+				const float new_cut_val = cutUsed
+					? EnvelopeAndLfoParameters::expKnobVal( cutBuffer[last] ) *
+								CUT_FREQ_MULTIPLIER + fcv
+					: fcv;
 
-				const float new_res_val = frv + RES_MULTIPLIER * resBuffer[frame];
+				const float new_res_val = resUsed
+					? frv + RES_MULTIPLIER * resBuffer[last]
+					: frv;
 
 				if( static_cast<int>( new_cut_val ) != old_filter_cut ||
 					static_cast<int>( new_res_val*RES_PRECISION ) != old_filter_res )
 				{
-					n->m_filter->calcFilterCoeffs( new_cut_val, new_res_val );
+					n->m_filter->processBlock( buffer + frame, blockFrames,
+								new_cut_val, new_res_val );
 					old_filter_cut = static_cast<int>( new_cut_val );
 					old_filter_res = static_cast<int>( new_res_val*RES_PRECISION );
 				}
-
-				buffer[frame][0] = n->m_filter->update( buffer[frame][0], 0 );
-				buffer[frame][1] = n->m_filter->update( buffer[frame][1], 1 );
-			}
-		}
-		else if( m_envLfoParameters[Cut]->isUsed() )
-		{
-			for( fpp_t frame = 0; frame < frames; ++frame )
-			{
-				float new_cut_val = EnvelopeAndLfoParameters::expKnobVal( cutBuffer[frame] ) *
-								CUT_FREQ_MULTIPLIER + fcv;
-
-				if( static_cast<int>( new_cut_val ) != old_filter_cut )
-				{
-					n->m_filter->calcFilterCoeffs( new_cut_val, frv );
-					old_filter_cut = static_cast<int>( new_cut_val );
-				}
-
-				buffer[frame][0] = n->m_filter->update( buffer[frame][0], 0 );
-				buffer[frame][1] = n->m_filter->update( buffer[frame][1], 1 );
-			}
-		}
-		else if( m_envLfoParameters[Resonance]->isUsed() )
-		{
-			for( fpp_t frame = 0; frame < frames; ++frame )
-			{
-				float new_res_val = frv + RES_MULTIPLIER * resBuffer[frame];
-
-				if( static_cast<int>( new_res_val*RES_PRECISION ) != old_filter_res )
+				else
 				{
-					n->m_filter->calcFilterCoeffs( fcv, new_res_val );
-					old_filter_res = static_cast<int>( new_res_val*RES_PRECISION );
+					n->m_filter->processBlock( buffer + frame, blockFrames );
 				}
-
-				buffer[frame][0] = n->m_filter->update( buffer[frame][0], 0 );
-				buffer[frame][1] = n->m_filter->update( buffer[frame][1], 1 );
 			}
 		}
 		else
 		{
 			n->m_filter->calcFilterCoeffs( fcv, frv );
-
-			for( fpp_t frame = 0; frame < frames; ++frame )
-			{
-				buffer[frame][0] = n->m_filter->update( buffer[frame][0], 0 );
-				buffer[frame][1] = n->m_filter->update( buffer[frame][1], 1 );
-			}
+			n->m_filter->processBlock( buffer, frames );
 		}
 	}
 
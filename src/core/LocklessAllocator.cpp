@@ -98,6 +98,19 @@ static int ffs( int i )
 
 
 void * LocklessAllocator::alloc()
+{
+	void * ptr = tryAlloc();
+	if( ptr == NULL )
+	{
+		fprintf( stderr, "LocklessAllocator: No free space\n" );
+	}
+	return ptr;
+}
+
+
+
+
+void * LocklessAllocator::tryAlloc()
 {
 	int available;
 	do
@@ -105,7 +118,6 @@ void * LocklessAllocator::alloc()
 		available = m_available;
 		if( !available )
 		{
-			fprintf( stderr, "LocklessAllocator: No free space\n" );
 			return NULL;
 		}
 	}
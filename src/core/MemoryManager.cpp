@@ -26,6 +26,7 @@
 #include "MemoryManager.h"
 
 #include <QtCore/QtGlobal>
+#include "AtomicInt.h"
 #include "rpmalloc.h"
 
 /// Global static object handling rpmalloc intializing and finalizing
@@ -59,12 +60,15 @@ MemoryManager::ThreadGuard::~ThreadGuard()
 
 static thread_local MemoryManager::ThreadGuard local_mm_thread_guard{};
 
+static AtomicInt allocations;
+
 void* MemoryManager::alloc(size_t size)
 {
 	// Reference local thread guard to ensure it is initialized.
 	// Compilers may optimize the instance away otherwise.
 	Q_UNUSED(&local_mm_thread_guard);
 	Q_ASSERT_X(rpmalloc_is_thread_initialized(), "MemoryManager::alloc", "Thread not initialized");
+	allocations.fetchAndAddRelaxed(1);
 	return rpmalloc(size);
 }
 
@@ -75,3 +79,9 @@ void MemoryManager::free(void * ptr)
 	Q_ASSERT_X(rpmalloc_is_thread_initialized(), "MemoryManager::free", "Thread not initialized");
 	return rpfree(ptr);
 }
+
+
+int MemoryManager::allocationCount()
+{
+	return allocations.loadAcquire();
+}
@@ -24,6 +24,8 @@
 
 #include "Mixer.h"
 
+#include <QtCore/QTimer>
+
 #include "denormals.h"
 
 #include "lmmsconfig.h"
@@ -60,12 +62,42 @@
 #include "MidiDummy.h"
 
 #include "BufferManager.h"
+#include "ScratchArena.h"
+
+#ifdef LMMS_HAVE_SCHED_H
+#include "sched.h"
+#endif
+
+#ifdef LMMS_HAVE_PTHREAD_H
+#include <pthread.h>
+#endif
 
 typedef LocklessList<PlayHandle *>::Element LocklessListElement;
 
 
 static __thread bool s_renderingThread;
 
+static Mixer::threadSettings s_threadSettings;
+
+// setupThread() failures that have been reported already
+static AtomicInt s_affinityFailed;
+static AtomicInt s_realtimeFailed;
+
+
+
+static int numWorkerThreads()
+{
+	if( s_threadSettings.workers >= 0 )
+	{
+		return s_threadSettings.workers;
+	}
+	// one thread less than CPUs, the rendering thread does work as well
+	const int cpus = s_threadSettings.cpus.isEmpty() ?
+					QThread::idealThreadCount() :
+					s_threadSettings.cpus.size();
+	return qMax( cpus - 1, 0 );
+}
+
 
 
 
@@ -77,7 +109,7 @@ Mixer::Mixer( bool renderOnly ) :
 	m_readBuf( NULL ),
 	m_writeBuf( NULL ),
 	m_workers(),
-	m_numWorkers( QThread::idealThreadCount()-1 ),
+	m_numWorkers( numWorkerThreads() ),
 	m_newPlayHandles( PlayHandle::MaxNumber ),
 	m_qualitySettings( qualitySettings::Mode_Draft ),
 	m_masterGain( 1.0f ),
@@ -88,6 +120,7 @@ Mixer::Mixer( bool renderOnly ) :
 	m_profiler(),
 	m_metronomeActive(false),
 	m_clearSignal( false ),
+	m_periodsRendered( 0 ),
 	m_changesSignal( false ),
 	m_changes( 0 ),
 	m_doChangesMutex( QMutex::Recursive ),
@@ -144,6 +177,12 @@ Mixer::Mixer( bool renderOnly ) :
 
 		BufferManager::clear( m_readBuf, m_framesPerPeriod );
 		m_bufferPool.push_back( m_readBuf );
+
+		m_outputSnapshot.at( i ) = (surroundSampleFrame*)
+			MemoryHelper::alignedMalloc( m_framesPerPeriod *
+						sizeof( surroundSampleFrame ) );
+		BufferManager::clear( m_outputSnapshot.at( i ),
+							m_framesPerPeriod );
 	}
 
 	for( int i = 0; i < m_numWorkers+1; ++i )
@@ -164,6 +203,124 @@ Mixer::Mixer( bool renderOnly ) :
 
 
 
+void Mixer::threadSettings::loadFromConfig()
+{
+	ConfigManager * config = ConfigManager::inst();
+
+	bool ok;
+	const int configWorkers =
+			config->value( "mixer", "workerthreads" ).toInt( &ok );
+	if( ok && configWorkers >= 0 )
+	{
+		workers = configWorkers;
+	}
+
+	QList<int> configCpus;
+	if( parseCpuList( config->value( "mixer", "cpuaffinity" ), configCpus ) )
+	{
+		cpus = configCpus;
+	}
+
+	// realtime scheduling is on unless disabled explicitly
+	realtime = config->value( "mixer", "realtime" ) != "0";
+
+	const int configPriority =
+			config->value( "mixer", "rtpriority" ).toInt( &ok );
+	if( ok && configPriority > 0 )
+	{
+		priority = configPriority;
+	}
+}
+
+
+
+
+bool Mixer::threadSettings::parseCpuList( const QString & list,
+							QList<int> & cpus )
+{
+	cpus.clear();
+	for( const QString & range : list.split( ',', QString::SkipEmptyParts ) )
+	{
+		const QStringList bounds = range.trimmed().split( '-' );
+		bool okFirst, okLast = true;
+		const int first = bounds[0].toInt( &okFirst );
+		const int last = bounds.size() > 1 ?
+					bounds[1].toInt( &okLast ) : first;
+		if( !okFirst || !okLast || bounds.size() > 2 ||
+						first < 0 || last < first )
+		{
+			cpus.clear();
+			return false;
+		}
+		for( int cpu = first; cpu <= last; ++cpu )
+		{
+			if( !cpus.contains( cpu ) )
+			{
+				cpus.append( cpu );
+			}
+		}
+	}
+	return !cpus.isEmpty();
+}
+
+
+
+
+void Mixer::setThreadSettings( const threadSettings & settings )
+{
+	s_threadSettings = settings;
+}
+
+
+
+
+void Mixer::setupThread( bool pinToCpus )
+{
+#if defined( LMMS_BUILD_LINUX ) && defined( LMMS_HAVE_SCHED_H )
+	if( pinToCpus && !s_threadSettings.cpus.isEmpty() )
+	{
+		cpu_set_t mask;
+		CPU_ZERO( &mask );
+		for( int cpu : s_threadSettings.cpus )
+		{
+			if( cpu < CPU_SETSIZE )
+			{
+				CPU_SET( cpu, &mask );
+			}
+		}
+		if( sched_setaffinity( 0, sizeof( mask ), &mask ) == -1 &&
+			s_affinityFailed.testAndSetOrdered( 0, 1 ) )
+		{
+			printf( "Notice: could not set CPU affinity.\n" );
+		}
+	}
+#endif
+
+#if defined( LMMS_HAVE_PTHREAD_H ) && defined( LMMS_HAVE_SCHED_H ) && \
+		!defined( LMMS_BUILD_WIN32 ) && !defined( __OpenBSD__ )
+	if( s_threadSettings.realtime )
+	{
+		const int minPriority = sched_get_priority_min( SCHED_FIFO );
+		const int maxPriority = sched_get_priority_max( SCHED_FIFO );
+
+		struct sched_param sparam;
+		sparam.sched_priority = s_threadSettings.priority > 0 ?
+			qBound( minPriority, s_threadSettings.priority,
+								maxPriority ) :
+			( minPriority + maxPriority ) / 2;
+		if( pthread_setschedparam( pthread_self(), SCHED_FIFO,
+							&sparam ) != 0 &&
+			s_realtimeFailed.testAndSetOrdered( 0, 1 ) )
+		{
+			printf( "Notice: could not set realtime priority.\n" );
+		}
+	}
+#endif
+}
+
+
+
+
 Mixer::~Mixer()
 {
 	runChangesInModel();
@@ -192,12 +349,19 @@ Mixer::~Mixer()
 	for( int i = 0; i < 3; i++ )
 	{
 		MemoryHelper::alignedFree( m_bufferPool[i] );
+		MemoryHelper::alignedFree( m_outputSnapshot.at( i ) );
 	}
 
 	for( int i = 0; i < 2; ++i )
 	{
 		delete[] m_inputBuffer[i];
 	}
+
+	// nothing is rendering anymore
+	for( QList<RetiredData>::Iterator it = m_retired.begin(); it != m_retired.end(); ++it )
+	{
+		it->free( it->data );
+	}
 }
 
 
@@ -474,7 +638,11 @@ const surroundSampleFrame * Mixer::renderNextBuffer()
 	fxMixer->masterMix( m_writeBuf );
 
 
-	emit nextAudioBuffer( m_readBuf );
+	// publish the finished period for visualization, the GUI picks it
+	// up whenever it repaints
+	memcpy( m_outputSnapshot.writeBuffer(), m_readBuf,
+			m_framesPerPeriod * sizeof( surroundSampleFrame ) );
+	m_outputSnapshot.publish();
 
 	runChangesInModel();
 
@@ -483,8 +651,13 @@ const surroundSampleFrame * Mixer::renderNextBuffer()
 	Controller::triggerFrameCounter();
 	AutomatableModel::incrementPeriodCounter();
 
+	// whatever was retired before this period started can be freed now
+	m_periodsRendered.fetchAndAddOrdered( 1 );
+
 	s_renderingThread = false;
 
+	ScratchArena::reset();
+
 	m_profiler.finishPeriod( processingSampleRate(), m_framesPerPeriod );
 
 	return m_readBuf;
@@ -534,7 +707,7 @@ void Mixer::clearInternal()
 
 
 
-void Mixer::getPeakValues( sampleFrame * _ab, const f_cnt_t _frames, float & peakLeft, float & peakRight ) const
+void Mixer::getPeakValues( const sampleFrame * _ab, const f_cnt_t _frames, float & peakLeft, float & peakRight ) const
 {
 	peakLeft = 0.0f;
 	peakRight = 0.0f;
@@ -691,6 +864,8 @@ bool Mixer::addPlayHandle( PlayHandle* handle )
 
 void Mixer::removePlayHandle( PlayHandle * _ph )
 {
+	PlayHandle * toDelete = NULL;
+
 	requestChangeInModel();
 	// check thread affinity as we must not delete play-handles
 	// which were created in a thread different than mixer thread
@@ -736,7 +911,10 @@ void Mixer::removePlayHandle( PlayHandle * _ph )
 			{
 				NotePlayHandleManager::release( (NotePlayHandle*) _ph );
 			}
-			else delete _ph;
+			else
+			{
+				toDelete = _ph;
+			}
 		}
 	}
 	else
@@ -744,6 +922,10 @@ void Mixer::removePlayHandle( PlayHandle * _ph )
 		m_playHandlesToRemove.push_back( _ph );
 	}
 	doneChangeInModel();
+
+	// the mixer doesn't know about it anymore, so there's no need to
+	// keep it waiting while the handle tears down its resources
+	delete toDelete;
 }
 
 
@@ -751,6 +933,8 @@ void Mixer::removePlayHandle( PlayHandle * _ph )
 
 void Mixer::removePlayHandlesOfTypes( Track * _track, const quint8 types )
 {
+	PlayHandleList toDelete;
+
 	requestChangeInModel();
 	PlayHandleList::Iterator it = m_playHandles.begin();
 	while( it != m_playHandles.end() )
@@ -762,7 +946,7 @@ void Mixer::removePlayHandlesOfTypes( Track * _track, const quint8 types )
 			{
 				NotePlayHandleManager::release( (NotePlayHandle*) *it );
 			}
-			else delete *it;
+			else toDelete.push_back( *it );
 			it = m_playHandles.erase( it );
 		}
 		else
@@ -771,6 +955,11 @@ void Mixer::removePlayHandlesOfTypes( Track * _track, const quint8 types )
 		}
 	}
 	doneChangeInModel();
+
+	for( PlayHandle * ph : toDelete )
+	{
+		delete ph;
+	}
 }
 
 
@@ -818,6 +1007,66 @@ void Mixer::doneChangeInModel()
 
 
 
+void Mixer::retire( void * _data, void (* _free)( void * ) )
+{
+	RetiredData retired;
+	retired.data = _data;
+	retired.free = _free;
+
+	QMutexLocker locker( &m_retiredMutex );
+
+	// the data has been replaced already, so every period that starts
+	// from now on reads the new version
+	retired.period = m_periodsRendered.fetchAndAddOrdered( 0 );
+
+	if( m_retired.isEmpty() )
+	{
+		QMetaObject::invokeMethod( this, "freeRetired", Qt::QueuedConnection );
+	}
+	m_retired.append( retired );
+}
+
+
+
+
+void Mixer::freeRetired()
+{
+	QList<RetiredData> done;
+
+	m_retiredMutex.lock();
+	const int rendered = m_periodsRendered.loadAcquire();
+	QList<RetiredData>::Iterator it = m_retired.begin();
+	while( it != m_retired.end() )
+	{
+		// the period that was in progress when the data was retired
+		// has been completed
+		if( rendered - it->period > 0 )
+		{
+			done.append( *it );
+			it = m_retired.erase( it );
+		}
+		else
+		{
+			++it;
+		}
+	}
+	const bool pending = !m_retired.isEmpty();
+	m_retiredMutex.unlock();
+
+	for( it = done.begin(); it != done.end(); ++it )
+	{
+		it->free( it->data );
+	}
+
+	if( pending )
+	{
+		QTimer::singleShot( 50, this, SLOT( freeRetired() ) );
+	}
+}
+
+
+
+
 void Mixer::runChangesInModel()
 {
 	if( m_changesSignal )
@@ -1107,16 +1356,7 @@ void Mixer::fifoWriter::run()
 {
 	disable_denormals();
 
-#if 0
-#ifdef LMMS_BUILD_LINUX
-#ifdef LMMS_HAVE_SCHED_H
-	cpu_set_t mask;
-	CPU_ZERO( &mask );
-	CPU_SET( 0, &mask );
-	sched_setaffinity( 0, sizeof( mask ), &mask );
-#endif
-#endif
-#endif
+	Mixer::setupThread();
 
 	const fpp_t frames = m_mixer->framesPerPeriod();
 	while( m_writing )
@@ -28,6 +28,8 @@
 MixerProfiler::MixerProfiler() :
 	m_periodTimer(),
 	m_cpuLoad( 0 ),
+	m_periodAllocations( 0 ),
+	m_allocations( 0 ),
 	m_outputFile()
 {
 }
@@ -42,13 +44,14 @@ MixerProfiler::~MixerProfiler()
 void MixerProfiler::finishPeriod( sample_rate_t sampleRate, fpp_t framesPerPeriod )
 {
 	int periodElapsed = m_periodTimer.elapsed();
+	m_allocations = MemoryManager::allocationCount() - m_periodAllocations;
 
 	const float newCpuLoad = periodElapsed / 10000.0f * sampleRate / framesPerPeriod;
     m_cpuLoad = qBound<int>( 0, ( newCpuLoad * 0.1f + m_cpuLoad * 0.9f ), 100 );
 
 	if( m_outputFile.isOpen() )
 	{
-		m_outputFile.write( QString( "%1\n" ).arg( periodElapsed ).toLatin1() );
+		m_outputFile.write( QString( "%1 %2\n" ).arg( periodElapsed ).arg( m_allocations ).toLatin1() );
 	}
 }
 
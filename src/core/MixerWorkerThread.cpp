@@ -29,6 +29,7 @@
 #include <QWaitCondition>
 #include "ThreadableJob.h"
 #include "Mixer.h"
+#include "ScratchArena.h"
 
 MixerWorkerThread::JobQueue MixerWorkerThread::globalJobQueue;
 QWaitCondition * MixerWorkerThread::queueReadyWaitCond = NULL;
@@ -60,6 +61,31 @@ void MixerWorkerThread::JobQueue::addJob( ThreadableJob * _job )
 
 
 
+bool MixerWorkerThread::JobQueue::addJobs( ThreadableJob * * _jobs, int _count )
+{
+	// reserve a range of slots at once so jobs added concurrently by
+	// another thread can't make us overflow the queue
+	int first;
+	do
+	{
+		first = m_queueSize;
+		if( first + _count > JOB_QUEUE_SIZE )
+		{
+			return false;
+		}
+	}
+	while( !m_queueSize.testAndSetOrdered( first, first + _count ) );
+
+	for( int i = 0; i < _count; ++i )
+	{
+		_jobs[i]->queue();
+		m_items[first + i] = _jobs[i];
+	}
+	return true;
+}
+
+
+
 void MixerWorkerThread::JobQueue::run()
 {
 	bool processedJob = true;
@@ -146,6 +172,45 @@ void MixerWorkerThread::startAndWaitForJobs()
 	// that otherwise would be caused by synchronizing with another thread.
 	globalJobQueue.run();
 	globalJobQueue.wait();
+
+	// end of a mixer stage
+	ScratchArena::reset();
+}
+
+
+
+
+void MixerWorkerThread::processJobs( ThreadableJob * * _jobs, int _count )
+{
+	if( !globalJobQueue.addJobs( _jobs, _count ) )
+	{
+		// queue is full, so process the jobs right here
+		for( int i = 0; i < _count; ++i )
+		{
+			_jobs[i]->queue();
+			_jobs[i]->process();
+		}
+		return;
+	}
+
+	// worker threads which already finished their pass over the queue are
+	// sleeping again - wake them up so they can pick up the new jobs
+	if( queueReadyWaitCond )
+	{
+		queueReadyWaitCond->wakeAll();
+	}
+	globalJobQueue.run();
+
+	// other threads might still be busy with some of our jobs
+	for( int i = 0; i < _count; ++i )
+	{
+		while( _jobs[i]->state() != ThreadableJob::Done )
+		{
+#if defined(LMMS_HOST_X86) || defined(LMMS_HOST_X86_64)
+			asm( "pause" );
+#endif
+		}
+	}
 }
 
 
@@ -155,6 +220,7 @@ void MixerWorkerThread::run()
 {
 	MemoryManager::ThreadGuard mmThreadGuard; Q_UNUSED(mmThreadGuard);
 	disable_denormals();
+	Mixer::setupThread();
 
 	QMutex m;
 	while( m_quit == false )
@@ -162,6 +228,7 @@ void MixerWorkerThread::run()
 		m.lock();
 		queueReadyWaitCond->wait( &m );
 		globalJobQueue.run();
+		ScratchArena::reset();
 		m.unlock();
 	}
 }
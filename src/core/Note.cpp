@@ -50,10 +50,6 @@ Note::Note( const MidiTime & length, const MidiTime & pos,
 	{
 		m_detuning = sharedObject::ref( detuning );
 	}
-	else
-	{
-		createDetuning();
-	}
 }
 
 
@@ -32,10 +32,6 @@
 #include "AudioFileOgg.h"
 #include "AudioFileMP3.h"
 
-#ifdef LMMS_HAVE_SCHED_H
-#include "sched.h"
-#endif
-
 const ProjectRenderer::FileEncodeDevice ProjectRenderer::fileEncodeDevices[] =
 {
 
@@ -137,6 +133,112 @@ QString ProjectRenderer::getFileExtensionFromFormat(
 
 
 
+bool ProjectRenderer::parseFileFormat( const QString & value,
+						ExportFileFormats & format )
+{
+	for( int i = 0; i < NumFileFormats; ++i )
+	{
+		if( fileEncodeDevices[i].isAvailable() &&
+				"." + value == fileEncodeDevices[i].m_extension )
+		{
+			format = fileEncodeDevices[i].m_fileFormat;
+			return true;
+		}
+	}
+	return false;
+}
+
+
+
+
+bool ProjectRenderer::parseSampleRate( const QString & value,
+					OutputSettings & outputSettings )
+{
+	const sample_rate_t sr = value.toUInt();
+	if( sr < 44100 || sr > 192000 )
+	{
+		return false;
+	}
+	outputSettings.setSampleRate( sr );
+	return true;
+}
+
+
+
+
+bool ProjectRenderer::parseBitRate( const QString & value,
+					OutputSettings & outputSettings )
+{
+	const int br = value.toUInt();
+	if( br < 64 || br > 384 )
+	{
+		return false;
+	}
+	OutputSettings::BitRateSettings bitRateSettings =
+					outputSettings.getBitRateSettings();
+	bitRateSettings.setBitRate( br );
+	outputSettings.setBitRateSettings( bitRateSettings );
+	return true;
+}
+
+
+
+
+bool ProjectRenderer::parseInterpolation( const QString & value,
+				Mixer::qualitySettings & qualitySettings )
+{
+	if( value == "linear" )
+	{
+		qualitySettings.interpolation = Mixer::qualitySettings::Interpolation_Linear;
+	}
+	else if( value == "sincfastest" )
+	{
+		qualitySettings.interpolation = Mixer::qualitySettings::Interpolation_SincFastest;
+	}
+	else if( value == "sincmedium" )
+	{
+		qualitySettings.interpolation = Mixer::qualitySettings::Interpolation_SincMedium;
+	}
+	else if( value == "sincbest" )
+	{
+		qualitySettings.interpolation = Mixer::qualitySettings::Interpolation_SincBest;
+	}
+	else
+	{
+		return false;
+	}
+	return true;
+}
+
+
+
+
+bool ProjectRenderer::parseOversampling( const QString & value,
+				Mixer::qualitySettings & qualitySettings )
+{
+	switch( value.toUInt() )
+	{
+		case 1:
+			qualitySettings.oversampling = Mixer::qualitySettings::Oversampling_None;
+			break;
+		case 2:
+			qualitySettings.oversampling = Mixer::qualitySettings::Oversampling_2x;
+			break;
+		case 4:
+			qualitySettings.oversampling = Mixer::qualitySettings::Oversampling_4x;
+			break;
+		case 8:
+			qualitySettings.oversampling = Mixer::qualitySettings::Oversampling_8x;
+			break;
+		default:
+			return false;
+	}
+	return true;
+}
+
+
+
+
 void ProjectRenderer::startProcessing()
 {
 
@@ -161,16 +263,7 @@ void ProjectRenderer::startProcessing()
 void ProjectRenderer::run()
 {
 	MemoryManager::ThreadGuard mmThreadGuard; Q_UNUSED(mmThreadGuard);
-#if 0
-#ifdef LMMS_BUILD_LINUX
-#ifdef LMMS_HAVE_SCHED_H
-	cpu_set_t mask;
-	CPU_ZERO( &mask );
-	CPU_SET( 0, &mask );
-	sched_setaffinity( 0, sizeof( mask ), &mask );
-#endif
-#endif
-#endif
+	Mixer::setupThread();
 
 	Engine::getSong()->startExport();
 	Engine::getSong()->updateLength();
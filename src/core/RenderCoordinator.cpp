@@ -0,0 +1,126 @@
+/*
+ * RenderCoordinator.cpp - distributes a command line render over several
+ *                         lmms processes
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include <QCoreApplication>
+
+#include "RenderCoordinator.h"
+
+
+RenderCoordinator::RenderCoordinator( const QStringList & arguments,
+							int workers ) :
+	m_arguments( arguments ),
+	m_input(),
+	m_profilerOutputFile(),
+	m_workers( workers ),
+	m_runningWorkers( 0 ),
+	m_failedWorkers( 0 )
+{
+}
+
+
+
+
+RenderCoordinator::~RenderCoordinator()
+{
+	for( QProcess * worker : m_workers )
+	{
+		if( worker && worker->state() != QProcess::NotRunning )
+		{
+			worker->kill();
+			worker->waitForFinished();
+		}
+		delete worker;
+	}
+}
+
+
+
+
+void RenderCoordinator::start()
+{
+	m_timer.start();
+
+	for( int i = 0; i < m_workers.size(); ++i )
+	{
+		QProcess * worker = new QProcess;
+		// let the workers print their progress and errors directly
+		worker->setProcessChannelMode( QProcess::ForwardedChannels );
+		connect( worker, SIGNAL( finished( int, QProcess::ExitStatus ) ),
+			this, SLOT( workerFinished( int, QProcess::ExitStatus ) ) );
+		m_workers[i] = worker;
+
+		QStringList arguments( m_arguments );
+		arguments << "--worker" <<
+				QString( "%1/%2" ).arg( i ).arg( m_workers.size() );
+		if( !m_profilerOutputFile.isEmpty() )
+		{
+			arguments << "--profile" <<
+				QString( "%1.%2" ).arg( m_profilerOutputFile ).arg( i );
+		}
+
+		worker->start( QCoreApplication::applicationFilePath(),
+								arguments );
+		if( !worker->waitForStarted() )
+		{
+			printf( "Could not start render process %d\n", i + 1 );
+			++m_failedWorkers;
+			continue;
+		}
+
+		if( !m_input.isEmpty() )
+		{
+			worker->write( m_input );
+		}
+		worker->closeWriteChannel();
+
+		++m_runningWorkers;
+	}
+
+	printf( "Rendering in %d processes\n", m_runningWorkers );
+
+	if( m_runningWorkers == 0 )
+	{
+		// the event loop isn't running yet
+		QMetaObject::invokeMethod( this, "finished",
+						Qt::QueuedConnection );
+	}
+}
+
+
+
+
+void RenderCoordinator::workerFinished( int exitCode,
+					QProcess::ExitStatus exitStatus )
+{
+	if( exitStatus != QProcess::NormalExit || exitCode != EXIT_SUCCESS )
+	{
+		++m_failedWorkers;
+	}
+
+	if( --m_runningWorkers == 0 )
+	{
+		printf( "\nAll render processes finished in %.2f s, %d failed\n",
+				m_timer.elapsed() / 1000.0, m_failedWorkers );
+		emit finished();
+	}
+}
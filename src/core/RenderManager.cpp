@@ -41,7 +41,10 @@ RenderManager::RenderManager(
 	m_outputSettings(outputSettings),
 	m_format(fmt),
 	m_outputPath(outputPath),
-	m_activeRenderer(NULL)
+	m_activeRenderer(NULL),
+	m_numTracksToRender(0),
+	m_worker(0),
+	m_workers(1)
 {
 	Engine::mixer()->storeAudioDevice();
 }
@@ -90,7 +93,7 @@ void RenderManager::renderNextTrack()
 		}
 
 		// for multi-render, prefix each output file with a different number
-		int trackNum = m_tracksToRender.size() + 1;
+		int trackNum = m_unmuted.indexOf( renderTrack ) + 1;
 
 		// create a renderer for this track
 		m_activeRenderer = new ProjectRenderer(
@@ -150,11 +153,21 @@ void RenderManager::renderTracks()
 
 	// copy the list of unmuted tracks into our rendering queue.
 	// we need to remember which tracks were unmuted to restore state at the end.
-	m_tracksToRender = m_unmuted;
+	for( int i = m_worker; i < m_unmuted.size(); i += m_workers )
+	{
+		m_tracksToRender.push_back( m_unmuted[i] );
+	}
+	m_numTracksToRender = m_tracksToRender.size();
 
 	renderNextTrack();
 }
 
+void RenderManager::setWorker( int worker, int workers )
+{
+	m_worker = worker;
+	m_workers = workers;
+}
+
 // Render the song into a single track
 void RenderManager::renderProject()
 {
@@ -210,7 +223,7 @@ void RenderManager::updateConsoleProgress()
 	{
 		m_activeRenderer->updateConsoleProgress();
 
-		int totalNum = m_unmuted.size();
+		int totalNum = m_numTracksToRender;
 		if ( totalNum > 0 )
 		{
 			// we are rendering multiple tracks, append a track counter to the output
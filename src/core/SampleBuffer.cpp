@@ -26,10 +26,15 @@
 
 
 #include <QBuffer>
+#include <QDateTime>
 #include <QFile>
 #include <QFileInfo>
+#include <QHash>
 #include <QMessageBox>
+#include <QMutex>
 #include <QPainter>
+#include <QReadLocker>
+#include <QThread>
 
 
 #include <sndfile.h>
@@ -55,16 +60,49 @@
 #include "Engine.h"
 #include "GuiApplication.h"
 #include "Mixer.h"
+#include "ScratchArena.h"
 
 #include "FileDialog.h"
 
 
+// File size and sample length limits
+static const int fileSizeMax = 300; // MB
+static const int sampleLengthMax = 90; // Minutes
+
+// number of frames summarized by each peak of the finest peak level
+static const int PEAK_BASE_FRAMES = 32;
+// number of peaks of a level summarized by one peak of the next level
+static const int PEAK_LEVEL_FACTOR = 4;
+// samples up to this length get their peaks built right away instead of
+// on a background thread
+static const f_cnt_t PEAK_SYNC_FRAMES = 64 * 1024;
+
+// upper limit for the amount of decoded audio kept in the decode cache
+static const f_cnt_t DECODE_CACHE_FRAMES = 32 * 1024 * 1024;
+
+struct DecodedFile
+{
+	sampleFrame * data;
+	f_cnt_t frames;
+	sample_rate_t sampleRate;
+	QDateTime lastModified;
+} ;
+
+static bool s_decodeCacheEnabled = false;
+static QMutex s_decodeCacheMutex;
+static QHash<QString, DecodedFile> s_decodeCache;
+// keys in the order they were added, oldest entries are dropped first
+static QList<QString> s_decodeCacheOrder;
+static f_cnt_t s_decodeCacheFrames = 0;
+
+
 SampleBuffer::SampleBuffer( const QString & _audio_file,
 							bool _is_base64_data ) :
 	m_audioFile( ( _is_base64_data == true ) ? "" : _audio_file ),
 	m_origData( NULL ),
 	m_origFrames( 0 ),
 	m_data( NULL ),
+	m_playData( NULL ),
 	m_frames( 0 ),
 	m_startFrame( 0 ),
 	m_endFrame( 0 ),
@@ -73,7 +111,8 @@ SampleBuffer::SampleBuffer( const QString & _audio_file,
 	m_amplification( 1.0f ),
 	m_reversed( false ),
 	m_frequency( BaseFreq ),
-	m_sampleRate( Engine::mixer()->baseSampleRate() )
+	m_sampleRate( Engine::mixer()->baseSampleRate() ),
+	m_peakBuilder( NULL )
 {
 	if( _is_base64_data == true )
 	{
@@ -91,6 +130,7 @@ SampleBuffer::SampleBuffer( const sampleFrame * _data, const f_cnt_t _frames ) :
 	m_origData( NULL ),
 	m_origFrames( 0 ),
 	m_data( NULL ),
+	m_playData( NULL ),
 	m_frames( 0 ),
 	m_startFrame( 0 ),
 	m_endFrame( 0 ),
@@ -99,7 +139,8 @@ SampleBuffer::SampleBuffer( const sampleFrame * _data, const f_cnt_t _frames ) :
 	m_amplification( 1.0f ),
 	m_reversed( false ),
 	m_frequency( BaseFreq ),
-	m_sampleRate( Engine::mixer()->baseSampleRate() )
+	m_sampleRate( Engine::mixer()->baseSampleRate() ),
+	m_peakBuilder( NULL )
 {
 	if( _frames > 0 )
 	{
@@ -119,6 +160,7 @@ SampleBuffer::SampleBuffer( const f_cnt_t _frames ) :
 	m_origData( NULL ),
 	m_origFrames( 0 ),
 	m_data( NULL ),
+	m_playData( NULL ),
 	m_frames( 0 ),
 	m_startFrame( 0 ),
 	m_endFrame( 0 ),
@@ -127,7 +169,8 @@ SampleBuffer::SampleBuffer( const f_cnt_t _frames ) :
 	m_amplification( 1.0f ),
 	m_reversed( false ),
 	m_frequency( BaseFreq ),
-	m_sampleRate( Engine::mixer()->baseSampleRate() )
+	m_sampleRate( Engine::mixer()->baseSampleRate() ),
+	m_peakBuilder( NULL )
 {
 	if( _frames > 0 )
 	{
@@ -144,6 +187,11 @@ SampleBuffer::SampleBuffer( const f_cnt_t _frames ) :
 
 SampleBuffer::~SampleBuffer()
 {
+	stopPeakBuilder();
+
+	// whoever owns us made sure that we're not being played anymore
+	delete m_playData.loadAcquire();
+
 	MM_FREE( m_origData );
 	MM_FREE( m_data );
 }
@@ -158,18 +206,107 @@ void SampleBuffer::sampleRateChanged()
 
 void SampleBuffer::update( bool _keep_settings )
 {
-	const bool lock = ( m_data != NULL );
-	if( lock )
+	bool fileLoadError;
+	if( m_data == NULL )
 	{
-		Engine::mixer()->requestChangeInModel();
+		// nobody can be playing us yet
+		fileLoadError = !loadData( _keep_settings );
+		publishPlayData();
+	}
+	else
+	{
+		// decode and resample into a scratch buffer while the mixer
+		// keeps playing the old data
+		SampleBuffer scratch;
+		MM_FREE( scratch.m_data );
+		scratch.m_data = NULL;
+		scratch.m_audioFile = m_audioFile;
+		scratch.m_origData = m_origData;
+		scratch.m_origFrames = m_origFrames;
+		scratch.m_frames = m_frames;
+		scratch.m_reversed = m_reversed;
+		scratch.m_startFrame = m_startFrame;
+		scratch.m_endFrame = m_endFrame;
+		scratch.m_loopStartFrame = m_loopStartFrame;
+		scratch.m_loopEndFrame = m_loopEndFrame;
+		fileLoadError = !scratch.loadData( _keep_settings );
+
+		// the peak builder reads the old data
+		stopPeakBuilder();
+
+		// the lock only keeps out GUI threads drawing us, the audio
+		// thread picks up the new data on its next play() call
 		m_varLock.lockForWrite();
-		MM_FREE( m_data );
+		m_data = scratch.m_data;
+		m_frames = scratch.m_frames;
+		m_startFrame = scratch.m_startFrame;
+		m_endFrame = scratch.m_endFrame;
+		m_loopStartFrame = scratch.m_loopStartFrame;
+		m_loopEndFrame = scratch.m_loopEndFrame;
+		publishPlayData();
+		m_varLock.unlock();
+
+		// the original data was only borrowed and the decoded data
+		// is ours now
+		scratch.m_origData = NULL;
+		scratch.m_data = NULL;
 	}
 
-	// File size and sample length limits
-	const int fileSizeMax = 300; // MB
-	const int sampleLengthMax = 90; // Minutes
+	updatePeaks();
+
+	emit sampleUpdated();
+
+	if( fileLoadError )
+	{
+		QString title = tr( "Fail to open file" );
+		QString message = tr( "Audio files are limited to %1 MB "
+				"in size and %2 minutes of playing time"
+				).arg( fileSizeMax ).arg( sampleLengthMax );
+		if( gui )
+		{
+			QMessageBox::information( NULL,
+				title, message,	QMessageBox::Ok );
+		}
+		else
+		{
+			fprintf( stderr, "%s\n", message.toUtf8().constData() );
+			exit( EXIT_FAILURE );
+		}
+	}
+}
+
+
+
+
+
+void SampleBuffer::publishPlayData()
+{
+	PlayData * playData = new PlayData;
+	playData->data = m_data;
+	playData->frames = m_frames;
+
+	PlayData * old = m_playData.fetchAndStoreOrdered( playData );
+	if( old != NULL )
+	{
+		Engine::mixer()->retire( old, &SampleBuffer::freePlayData );
+	}
+}
+
+
+
+
+void SampleBuffer::freePlayData( void * _playData )
+{
+	PlayData * playData = static_cast<PlayData *>( _playData );
+	MM_FREE( playData->data );
+	delete playData;
+}
 
+
+
+
+bool SampleBuffer::loadData( bool _keep_settings )
+{
 	bool fileLoadError = false;
 	if( m_audioFile.isEmpty() && m_origData != NULL && m_origFrames > 0 )
 	{
@@ -220,7 +357,7 @@ void SampleBuffer::update( bool _keep_settings )
 			}
 		}
 
-		if( !fileLoadError )
+		if( !fileLoadError && !loadFromDecodeCache( file, samplerate ) )
 		{
 #ifdef LMMS_HAVE_OGGVORBIS
 			// workaround for a bug in libsndfile or our libsndfile decoder
@@ -249,9 +386,11 @@ void SampleBuffer::update( bool _keep_settings )
 									samplerate );
 			}
 
-			delete[] f;
+			addToDecodeCache( file, samplerate );
 		}
 
+		delete[] f;
+
 		if ( m_frames == 0 || fileLoadError )  // if still no frames, bail
 		{
 			// sample couldn't be decoded, create buffer containing
@@ -278,34 +417,106 @@ void SampleBuffer::update( bool _keep_settings )
 		m_loopEndFrame = m_endFrame = 1;
 	}
 
-	if( lock )
+	return !fileLoadError;
+}
+
+
+bool SampleBuffer::loadFromDecodeCache( const QString & _file,
+						sample_rate_t & _sample_rate )
+{
+	if( !s_decodeCacheEnabled )
 	{
-		m_varLock.unlock();
-		Engine::mixer()->doneChangeInModel();
+		return false;
 	}
 
-	emit sampleUpdated();
+	const QString key = m_reversed ? _file + "|reversed" : _file;
 
-	if( fileLoadError )
+	QMutexLocker lock( &s_decodeCacheMutex );
+	QHash<QString, DecodedFile>::iterator it = s_decodeCache.find( key );
+	if( it == s_decodeCache.end() )
 	{
-		QString title = tr( "Fail to open file" );
-		QString message = tr( "Audio files are limited to %1 MB "
-				"in size and %2 minutes of playing time"
-				).arg( fileSizeMax ).arg( sampleLengthMax );
-		if( gui )
-		{
-			QMessageBox::information( NULL,
-				title, message,	QMessageBox::Ok );
-		}
-		else
+		return false;
+	}
+	if( it->lastModified != QFileInfo( _file ).lastModified() )
+	{
+		// the file changed since we decoded it
+		MM_FREE( it->data );
+		s_decodeCacheFrames -= it->frames;
+		s_decodeCacheOrder.removeOne( key );
+		s_decodeCache.erase( it );
+		return false;
+	}
+
+	m_data = MM_ALLOC( sampleFrame, it->frames );
+	memcpy( m_data, it->data, it->frames * BYTES_PER_FRAME );
+	m_frames = it->frames;
+	_sample_rate = it->sampleRate;
+	return true;
+}
+
+
+
+
+void SampleBuffer::addToDecodeCache( const QString & _file,
+						sample_rate_t _sample_rate )
+{
+	if( !s_decodeCacheEnabled || m_frames == 0 ||
+					m_frames > DECODE_CACHE_FRAMES )
+	{
+		return;
+	}
+
+	const QString key = m_reversed ? _file + "|reversed" : _file;
+
+	QMutexLocker lock( &s_decodeCacheMutex );
+	if( s_decodeCache.contains( key ) )
+	{
+		return;
+	}
+
+	while( s_decodeCacheFrames + m_frames > DECODE_CACHE_FRAMES )
+	{
+		const DecodedFile oldest =
+			s_decodeCache.take( s_decodeCacheOrder.takeFirst() );
+		MM_FREE( oldest.data );
+		s_decodeCacheFrames -= oldest.frames;
+	}
+
+	DecodedFile decoded;
+	decoded.data = MM_ALLOC( sampleFrame, m_frames );
+	memcpy( decoded.data, m_data, m_frames * BYTES_PER_FRAME );
+	decoded.frames = m_frames;
+	decoded.sampleRate = _sample_rate;
+	decoded.lastModified = QFileInfo( _file ).lastModified();
+
+	s_decodeCache.insert( key, decoded );
+	s_decodeCacheOrder.append( key );
+	s_decodeCacheFrames += m_frames;
+}
+
+
+
+
+void SampleBuffer::setDecodeCacheEnabled( bool enabled )
+{
+	QMutexLocker lock( &s_decodeCacheMutex );
+	s_decodeCacheEnabled = enabled;
+	if( !enabled )
+	{
+		for( QHash<QString, DecodedFile>::iterator it =
+			s_decodeCache.begin(); it != s_decodeCache.end(); ++it )
 		{
-			fprintf( stderr, "%s\n", message.toUtf8().constData() );
-			exit( EXIT_FAILURE );
+			MM_FREE( it->data );
 		}
+		s_decodeCache.clear();
+		s_decodeCacheOrder.clear();
+		s_decodeCacheFrames = 0;
 	}
 }
 
 
+
+
 void SampleBuffer::convertIntToFloat ( int_sample_t * & _ibuf, f_cnt_t _frames, int _channels)
 {
 	// following code transforms int-samples into
@@ -628,10 +839,13 @@ bool SampleBuffer::play( sampleFrame * _ab, handleState * _state,
 					const float _freq,
 					const LoopMode _loopmode )
 {
+	// stick to one version of the data for the whole call, the frame
+	// markers might have been set for a newer one already
+	const PlayData * playData = m_playData.loadAcquire();
 	f_cnt_t startFrame = m_startFrame;
-	f_cnt_t endFrame = m_endFrame;
+	f_cnt_t endFrame = qMin( m_endFrame, playData->frames );
 	f_cnt_t loopStartFrame = m_loopStartFrame;
-	f_cnt_t loopEndFrame = m_loopEndFrame;
+	f_cnt_t loopEndFrame = qMin( m_loopEndFrame, playData->frames );
 
 	if( endFrame == 0 || _frames == 0 )
 	{
@@ -685,7 +899,7 @@ bool SampleBuffer::play( sampleFrame * _ab, handleState * _state,
 		SRC_DATA src_data;
 		// Generate output
 		src_data.data_in =
-			getSampleFragment( play_frame, fragment_size, _loopmode, &tmp, &is_backwards,
+			getSampleFragment( playData->data, play_frame, fragment_size, _loopmode, &tmp, &is_backwards,
 			loopStartFrame, loopEndFrame, endFrame )[0];
 		src_data.data_out = _ab[0];
 		src_data.input_frames = fragment_size;
@@ -740,7 +954,7 @@ bool SampleBuffer::play( sampleFrame * _ab, handleState * _state,
 
 		// Generate output
 		memcpy( _ab,
-			getSampleFragment( play_frame, _frames, _loopmode, &tmp, &is_backwards,
+			getSampleFragment( playData->data, play_frame, _frames, _loopmode, &tmp, &is_backwards,
 						loopStartFrame, loopEndFrame, endFrame ),
 						_frames * BYTES_PER_FRAME );
 		// Advance
@@ -775,7 +989,7 @@ bool SampleBuffer::play( sampleFrame * _ab, handleState * _state,
 
 	if( tmp != NULL ) 
 	{
-		MM_FREE( tmp );
+		SCRATCH_FREE( tmp );
 	}
 
 	_state->setBackwards( is_backwards );
@@ -793,7 +1007,7 @@ bool SampleBuffer::play( sampleFrame * _ab, handleState * _state,
 
 
 
-sampleFrame * SampleBuffer::getSampleFragment( f_cnt_t _index,
+sampleFrame * SampleBuffer::getSampleFragment( sampleFrame * _data, f_cnt_t _index,
 		f_cnt_t _frames, LoopMode _loopmode, sampleFrame * * _tmp, bool * _backwards,
 		f_cnt_t _loopstart, f_cnt_t _loopend, f_cnt_t _end ) const
 {
@@ -801,42 +1015,42 @@ sampleFrame * SampleBuffer::getSampleFragment( f_cnt_t _index,
 	{
 		if( _index + _frames <= _end )
 		{
-			return m_data + _index;
+			return _data + _index;
 		}
 	}
 	else if( _loopmode == LoopOn )
 	{
 		if( _index + _frames <= _loopend )
 		{
-			return m_data + _index;
+			return _data + _index;
 		}
 	}
 	else
 	{
 		if( ! *_backwards && _index + _frames < _loopend )
 		{
-			return m_data + _index;
+			return _data + _index;
 		}
 	}
 
-	*_tmp = MM_ALLOC( sampleFrame, _frames );
+	*_tmp = SCRATCH_ALLOC( sampleFrame, _frames );
 
 	if( _loopmode == LoopOff )
 	{
 		f_cnt_t available = _end - _index;
-		memcpy( *_tmp, m_data + _index, available * BYTES_PER_FRAME );
+		memcpy( *_tmp, _data + _index, available * BYTES_PER_FRAME );
 		memset( *_tmp + available, 0, ( _frames - available ) *
 							BYTES_PER_FRAME );
 	}
 	else if( _loopmode == LoopOn )
 	{
 		f_cnt_t copied = qMin( _frames, _loopend - _index );
-		memcpy( *_tmp, m_data + _index, copied * BYTES_PER_FRAME );
+		memcpy( *_tmp, _data + _index, copied * BYTES_PER_FRAME );
 		f_cnt_t loop_frames = _loopend - _loopstart;
 		while( copied < _frames )
 		{
 			f_cnt_t todo = qMin( _frames - copied, loop_frames );
-			memcpy( *_tmp + copied, m_data + _loopstart, todo * BYTES_PER_FRAME );
+			memcpy( *_tmp + copied, _data + _loopstart, todo * BYTES_PER_FRAME );
 			copied += todo;
 		}
 	}
@@ -854,8 +1068,8 @@ sampleFrame * SampleBuffer::getSampleFragment( f_cnt_t _index,
 			copied = qMin( _frames, pos - _loopstart );
 			for( int i=0; i < copied; i++ )
 			{
-				(*_tmp)[i][0] = m_data[ pos - i ][0];
-				(*_tmp)[i][1] = m_data[ pos - i ][1];
+				(*_tmp)[i][0] = _data[ pos - i ][0];
+				(*_tmp)[i][1] = _data[ pos - i ][1];
 			}
 			pos -= copied;
 			if( pos == _loopstart ) backwards = false;
@@ -863,7 +1077,7 @@ sampleFrame * SampleBuffer::getSampleFragment( f_cnt_t _index,
 		else
 		{
 			copied = qMin( _frames, _loopend - pos );
-			memcpy( *_tmp, m_data + pos, copied * BYTES_PER_FRAME );
+			memcpy( *_tmp, _data + pos, copied * BYTES_PER_FRAME );
 			pos += copied;
 			if( pos == _loopend ) backwards = true;
 		}
@@ -875,8 +1089,8 @@ sampleFrame * SampleBuffer::getSampleFragment( f_cnt_t _index,
 				f_cnt_t todo = qMin( _frames - copied, pos - _loopstart );
 				for ( int i=0; i < todo; i++ )
 				{
-					(*_tmp)[ copied + i ][0] = m_data[ pos - i ][0];
-					(*_tmp)[ copied + i ][1] = m_data[ pos - i ][1];
+					(*_tmp)[ copied + i ][0] = _data[ pos - i ][0];
+					(*_tmp)[ copied + i ][1] = _data[ pos - i ][1];
 				}
 				pos -= todo;
 				copied += todo;
@@ -885,7 +1099,7 @@ sampleFrame * SampleBuffer::getSampleFragment( f_cnt_t _index,
 			else
 			{
 				f_cnt_t todo = qMin( _frames - copied, _loopend - pos );
-				memcpy( *_tmp + copied, m_data + pos, todo * BYTES_PER_FRAME );
+				memcpy( *_tmp + copied, _data + pos, todo * BYTES_PER_FRAME );
 				pos += todo;
 				copied += todo;
 				if( pos >= _loopend ) backwards = true;
@@ -926,9 +1140,165 @@ f_cnt_t SampleBuffer::getPingPongIndex( f_cnt_t _index, f_cnt_t _startf, f_cnt_t
 }
 
 
+// builds the peak pyramid of a sample on a low-priority thread and swaps it
+// into the buffer once it's complete
+class SampleBuffer::PeakBuilder : public QThread
+{
+public:
+	PeakBuilder( SampleBuffer * _buffer ) :
+		m_buffer( _buffer ),
+		m_abort( 0 )
+	{
+	}
+
+	void abort()
+	{
+		m_abort.storeRelease( 1 );
+	}
+
+protected:
+	virtual void run()
+	{
+		QVector<PeakLevel> peaks;
+
+		// the data can't be swapped out while we're reading it, update()
+		// aborts us before it tries to
+		m_buffer->m_varLock.lockForRead();
+		const bool complete = buildPeaks( m_buffer->m_data,
+					m_buffer->m_frames, peaks, &m_abort );
+		m_buffer->m_varLock.unlock();
+
+		if( !complete )
+		{
+			return;
+		}
+
+		m_buffer->m_varLock.lockForWrite();
+		m_buffer->m_peaks.swap( peaks );
+		m_buffer->m_varLock.unlock();
+
+		emit m_buffer->peaksUpdated();
+	}
+
+private:
+	SampleBuffer * m_buffer;
+	AtomicInt m_abort;
+
+} ;
+
+
+
+
+bool SampleBuffer::buildPeaks( const sampleFrame * _data, f_cnt_t _frames,
+					QVector<PeakLevel> & _peaks,
+					const AtomicInt * _abort )
+{
+	// finest level directly from sample data
+	PeakLevel level( ( _frames + PEAK_BASE_FRAMES - 1 ) / PEAK_BASE_FRAMES );
+	for( int i = 0; i < level.size(); ++i )
+	{
+		if( _abort && i % 4096 == 0 && _abort->loadAcquire() )
+		{
+			return false;
+		}
+		const f_cnt_t first = i * PEAK_BASE_FRAMES;
+		const f_cnt_t last = qMin<f_cnt_t>( first + PEAK_BASE_FRAMES, _frames );
+		Peak & p = level[i];
+		for( ch_cnt_t ch = 0; ch < DEFAULT_CHANNELS; ++ch )
+		{
+			p.min[ch] = p.max[ch] = _data[first][ch];
+		}
+		for( f_cnt_t f = first + 1; f < last; ++f )
+		{
+			for( ch_cnt_t ch = 0; ch < DEFAULT_CHANNELS; ++ch )
+			{
+				p.min[ch] = qMin( p.min[ch], _data[f][ch] );
+				p.max[ch] = qMax( p.max[ch], _data[f][ch] );
+			}
+		}
+	}
+	_peaks.append( level );
+
+	// coarser levels from the previous one
+	while( _peaks.last().size() > PEAK_LEVEL_FACTOR )
+	{
+		const PeakLevel & src = _peaks.last();
+		PeakLevel dst( ( src.size() + PEAK_LEVEL_FACTOR - 1 ) / PEAK_LEVEL_FACTOR );
+		for( int i = 0; i < dst.size(); ++i )
+		{
+			const int first = i * PEAK_LEVEL_FACTOR;
+			const int last = qMin( first + PEAK_LEVEL_FACTOR, src.size() );
+			Peak p = src[first];
+			for( int j = first + 1; j < last; ++j )
+			{
+				for( ch_cnt_t ch = 0; ch < DEFAULT_CHANNELS; ++ch )
+				{
+					p.min[ch] = qMin( p.min[ch], src[j].min[ch] );
+					p.max[ch] = qMax( p.max[ch], src[j].max[ch] );
+				}
+			}
+			dst[i] = p;
+		}
+		_peaks.append( dst );
+	}
+
+	return true;
+}
+
+
+
+
+void SampleBuffer::updatePeaks()
+{
+	stopPeakBuilder();
+
+	if( m_frames <= PEAK_SYNC_FRAMES )
+	{
+		// not worth a thread - this is the case for most buffers
+		// that are created on the fly
+		QVector<PeakLevel> peaks;
+		if( m_frames > 0 )
+		{
+			buildPeaks( m_data, m_frames, peaks, NULL );
+		}
+		m_varLock.lockForWrite();
+		m_peaks.swap( peaks );
+		m_varLock.unlock();
+		return;
+	}
+
+	// visualize() draws from the raw data until the new peaks are in
+	m_varLock.lockForWrite();
+	m_peaks.clear();
+	m_varLock.unlock();
+
+	m_peakBuilder = new PeakBuilder( this );
+	m_peakBuilder->start( QThread::LowPriority );
+}
+
+
+
+
+void SampleBuffer::stopPeakBuilder()
+{
+	if( m_peakBuilder )
+	{
+		m_peakBuilder->abort();
+		m_peakBuilder->wait();
+		delete m_peakBuilder;
+		m_peakBuilder = NULL;
+	}
+}
+
+
+
+
 void SampleBuffer::visualize( QPainter & _p, const QRect & _dr,
 							const QRect & _clip, f_cnt_t _from_frame, f_cnt_t _to_frame )
 {
+	// the peaks are swapped in from a background thread
+	QReadLocker locker( &m_varLock );
+
 	if( m_frames == 0 ) return;
 
 	const bool focus_on_range = _to_frame <= m_frames
@@ -940,14 +1310,60 @@ void SampleBuffer::visualize( QPainter & _p, const QRect & _dr,
 	const int yb = h / 2 + _dr.y();
 	const float y_space = h*0.5f;
 	const int nb_frames = focus_on_range ? _to_frame - _from_frame : m_frames;
+	const int xb = _dr.x();
+	const int first = focus_on_range ? _from_frame : 0;
+	const int last = focus_on_range ? _to_frame : m_frames;
+
+	if( w > 0 && nb_frames / w >= PEAK_BASE_FRAMES && !m_peaks.isEmpty() )
+	{
+		// more than one peak per pixel - draw a min/max line for each pixel
+		// column from the coarsest peak level that's still fine enough
+		const double framesPerPixel = double( nb_frames ) / w;
+		int levelIdx = 0;
+		int peakFrames = PEAK_BASE_FRAMES;
+		while( levelIdx + 1 < m_peaks.size() &&
+				peakFrames * PEAK_LEVEL_FACTOR <= framesPerPixel )
+		{
+			peakFrames *= PEAK_LEVEL_FACTOR;
+			++levelIdx;
+		}
+		const PeakLevel & level = m_peaks[levelIdx];
+
+		QVector<QLineF> lines;
+		lines.reserve( w * DEFAULT_CHANNELS );
+		for( int x = 0; x < w; ++x )
+		{
+			const int p0 = static_cast<int>( first + x * framesPerPixel ) / peakFrames;
+			const int p1 = qMin( qMax( p0 + 1,
+				static_cast<int>( first + ( x + 1 ) * framesPerPixel ) / peakFrames ),
+								level.size() );
+			if( p0 >= p1 )
+			{
+				break;
+			}
+			Peak p = level[p0];
+			for( int i = p0 + 1; i < p1; ++i )
+			{
+				for( ch_cnt_t ch = 0; ch < DEFAULT_CHANNELS; ++ch )
+				{
+					p.min[ch] = qMin( p.min[ch], level[i].min[ch] );
+					p.max[ch] = qMax( p.max[ch], level[i].max[ch] );
+				}
+			}
+			for( ch_cnt_t ch = 0; ch < DEFAULT_CHANNELS; ++ch )
+			{
+				lines += QLineF( xb + x + 0.5, yb - ( p.max[ch] * y_space * m_amplification ),
+							xb + x + 0.5, yb - ( p.min[ch] * y_space * m_amplification ) );
+			}
+		}
+		_p.drawLines( lines );
+		return;
+	}
 
 	const int fpp = tLimit<int>( nb_frames / w, 1, 20 );
 	QPointF * l = new QPointF[nb_frames / fpp + 1];
 	QPointF * r = new QPointF[nb_frames / fpp + 1];
 	int n = 0;
-	const int xb = _dr.x();
-	const int first = focus_on_range ? _from_frame : 0;
-	const int last = focus_on_range ? _to_frame : m_frames;
 	for( int frame = first; frame < last; frame += fpp )
 	{
 		l[n] = QPointF( xb + ( (frame - first) * double( w ) / nb_frames ),
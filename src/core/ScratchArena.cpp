@@ -0,0 +1,116 @@
+/*
+ * ScratchArena.cpp - per-thread memory for temporary buffers of the mixer
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include "ScratchArena.h"
+
+#include "MemoryHelper.h"
+#include "MemoryManager.h"
+
+
+static const size_t ARENA_SIZE = 1024 * 1024;
+static const size_t ARENA_ALIGNMENT = 16;
+
+
+namespace {
+
+struct Arena
+{
+	Arena() :
+		base( NULL ),
+		used( 0 ),
+		last( 0 )
+	{
+	}
+
+	~Arena()
+	{
+		MemoryHelper::alignedFree( base );
+	}
+
+	bool contains( void * ptr ) const
+	{
+		return base != NULL && ptr >= base && ptr < base + ARENA_SIZE;
+	}
+
+	char * base;
+	// bytes in use and offset of the most recent allocation
+	size_t used;
+	size_t last;
+} ;
+
+static thread_local Arena arena;
+
+}
+
+
+
+
+void * ScratchArena::alloc( size_t size )
+{
+	if( arena.base == NULL )
+	{
+		// once per thread
+		arena.base = static_cast<char *>(
+				MemoryHelper::alignedMalloc( ARENA_SIZE ) );
+	}
+
+	size = ( size + ARENA_ALIGNMENT - 1 ) & ~( ARENA_ALIGNMENT - 1 );
+	if( arena.base == NULL || arena.used + size > ARENA_SIZE )
+	{
+		return MemoryManager::alloc( size );
+	}
+
+	arena.last = arena.used;
+	arena.used += size;
+	return arena.base + arena.last;
+}
+
+
+
+
+void ScratchArena::free( void * ptr )
+{
+	if( ptr == NULL )
+	{
+		return;
+	}
+
+	if( arena.contains( ptr ) )
+	{
+		if( ptr == arena.base + arena.last )
+		{
+			arena.used = arena.last;
+		}
+		return;
+	}
+
+	MemoryManager::free( ptr );
+}
+
+
+
+
+void ScratchArena::reset()
+{
+	arena.used = 0;
+	arena.last = 0;
+}
@@ -47,6 +47,7 @@
 #include "FxMixerView.h"
 #include "GuiApplication.h"
 #include "ImportFilter.h"
+#include "InstrumentTrack.h"
 #include "ExportFilter.h"
 #include "MainWindow.h"
 #include "FileDialog.h"
@@ -1166,33 +1167,62 @@ void Song::loadProject( const QString & fileName )
 
 
 // only save current song as _filename and do nothing else
-bool Song::saveProjectFile( const QString & filename )
+bool Song::saveProjectFile( const QString & filename, bool inBackground )
 {
+	// the previous document is still being written - don't bother
+	// collecting a new one
+	if( inBackground && DataFile::isWritingInBackground() )
+	{
+		return false;
+	}
+
 	DataFile::LocaleHelper localeHelper( DataFile::LocaleHelper::ModeSave );
 
-	DataFile dataFile( DataFile::SongProject );
+	// background writes take the document over, so it has to outlive
+	// this function
+	DataFile * dataFile = new DataFile( DataFile::SongProject );
 
-	m_tempoModel.saveSettings( dataFile, dataFile.head(), "bpm" );
-	m_timeSigModel.saveSettings( dataFile, dataFile.head(), "timesig" );
-	m_masterVolumeModel.saveSettings( dataFile, dataFile.head(), "mastervol" );
-	m_masterPitchModel.saveSettings( dataFile, dataFile.head(), "masterpitch" );
+	m_tempoModel.saveSettings( *dataFile, dataFile->head(), "bpm" );
+	m_timeSigModel.saveSettings( *dataFile, dataFile->head(), "timesig" );
+	m_masterVolumeModel.saveSettings( *dataFile, dataFile->head(), "mastervol" );
+	m_masterPitchModel.saveSettings( *dataFile, dataFile->head(), "masterpitch" );
 
-	saveState( dataFile, dataFile.content() );
+	saveState( *dataFile, dataFile->content() );
 
-	m_globalAutomationTrack->saveState( dataFile, dataFile.content() );
-	Engine::fxMixer()->saveState( dataFile, dataFile.content() );
+	m_globalAutomationTrack->saveState( *dataFile, dataFile->content() );
+	Engine::fxMixer()->saveState( *dataFile, dataFile->content() );
 	if( gui )
 	{
-		gui->getControllerRackView()->saveState( dataFile, dataFile.content() );
-		gui->pianoRoll()->saveState( dataFile, dataFile.content() );
-		gui->automationEditor()->m_editor->saveState( dataFile, dataFile.content() );
-		gui->getProjectNotes()->SerializingObject::saveState( dataFile, dataFile.content() );
-		m_playPos[Mode_PlaySong].m_timeLine->saveState( dataFile, dataFile.content() );
+		gui->getControllerRackView()->saveState( *dataFile, dataFile->content() );
+		gui->pianoRoll()->saveState( *dataFile, dataFile->content() );
+		gui->automationEditor()->m_editor->saveState( *dataFile, dataFile->content() );
+		gui->getProjectNotes()->SerializingObject::saveState( *dataFile, dataFile->content() );
+		m_playPos[Mode_PlaySong].m_timeLine->saveState( *dataFile, dataFile->content() );
+	}
+
+	saveControllerStates( *dataFile, dataFile->content() );
+
+	if( inBackground )
+	{
+		return DataFile::writeFileInBackground( dataFile, filename );
+	}
+
+	// frozen tracks keep their render next to the project
+	for( Track * track : tracks() )
+	{
+		if( track->type() == Track::InstrumentTrack &&
+			!static_cast<InstrumentTrack *>( track )->
+						writeFreezeCache( filename ) )
+		{
+			qWarning( "Could not store frozen render of track %s",
+					qPrintable( track->name() ) );
+		}
 	}
 
-	saveControllerStates( dataFile, dataFile.content() );
+	const bool written = dataFile->writeFile( filename );
+	delete dataFile;
 
-	return dataFile.writeFile( filename );
+	return written;
 }
 
 
@@ -449,17 +449,20 @@ void TrackContentObjectView::cut()
  */
 void TrackContentObjectView::updateLength()
 {
-	if( fixedTCOs() )
-	{
-		setFixedWidth( parentWidget()->width() );
-	}
-	else
-	{
-		setFixedWidth(
+	const int newWidth = fixedTCOs() ? parentWidget()->width() :
 		static_cast<int>( m_tco->length() * pixelsPerTact() /
 					MidiTime::ticksPerTact() ) + 1 /*+
-						TCO_BORDER_WIDTH * 2-1*/ );
+						TCO_BORDER_WIDTH * 2-1*/;
+
+	// this is called for every TCO whenever the visible part of the song
+	// changes - don't trigger a repaint of the whole track container
+	// unless our size actually changed
+	if( newWidth == width() )
+	{
+		return;
 	}
+
+	setFixedWidth( newWidth );
 	m_trackView->trackContainerView()->update();
 }
 
@@ -1248,7 +1251,10 @@ void TrackContentWidget::changePosition( const MidiTime & newPos )
 		TrackContentObjectView * tcov = *it;
 		TrackContentObject * tco = tcov->getTrackContentObject();
 
-		tco->changeLength( tco->length() );
+		// adapt to the current zoom level - there's no need to touch the
+		// TCO itself, that would make the song recalculate its length
+		// for every single TCO
+		tcov->updateLength();
 
 		const int ts = tco->startPosition();
 		const int te = tco->endPosition()-3;
@@ -1849,6 +1855,16 @@ void TrackOperationsWidget::updateMenu()
 
 		toMenu->addSeparator();
 		toMenu->addMenu( trackView->midiMenu() );
+
+		if( trackView->model()->trackContainer() == Engine::getSong() )
+		{
+			QAction * freezeAction = toMenu->addAction(
+						tr( "Freeze track" ),
+						trackView, SLOT( toggleFrozen( bool ) ) );
+			freezeAction->setCheckable( true );
+			freezeAction->setChecked(
+				trackView->model()->frozenModel()->value() );
+		}
 	}
 	if( dynamic_cast<AutomationTrackView *>( m_trackView ) )
 	{
@@ -25,6 +25,7 @@
 #include "AudioPort.h"
 #include "AudioDevice.h"
 #include "EffectChain.h"
+#include "FreezeCache.h"
 #include "FxMixer.h"
 #include "Engine.h"
 #include "Mixer.h"
@@ -41,6 +42,7 @@ AudioPort::AudioPort( const QString & _name, bool _has_effect_chain,
 	m_nextFxChannel( 0 ),
 	m_name( "unnamed port" ),
 	m_effects( _has_effect_chain ? new EffectChain( NULL ) : NULL ),
+	m_freezeCache( NULL ),
 	m_volumeModel( volumeModel ),
 	m_panningModel( panningModel ),
 	m_mutedModel( mutedModel )
@@ -104,13 +106,17 @@ bool AudioPort::processEffects()
 
 void AudioPort::doProcessing()
 {
+	const fpp_t fpp = Engine::mixer()->framesPerPeriod();
+
 	if( m_mutedModel && m_mutedModel->value() )
 	{
+		if( m_freezeCache )
+		{
+			m_freezeCache->skip( fpp );
+		}
 		return;
 	}
 
-	const fpp_t fpp = Engine::mixer()->framesPerPeriod();
-
 	// clear the buffer
 	BufferManager::clear( m_portBuffer, fpp );
 
@@ -217,9 +223,21 @@ void AudioPort::doProcessing()
 	// as of now there's no situation where we only have panning model but no volume model
 	// if we have neither, we don't have to do anything here - just pass the audio as is
 
-	// handle effects
-	const bool me = processEffects();
-	if( me || m_bufferUsage )
+	// handle effects - the output of frozen tracks has been rendered
+	// through them already, so only live input still needs them
+	const bool streaming = m_freezeCache && m_freezeCache->isStreaming();
+	const bool me = ( streaming && !m_bufferUsage ) ? false :
+							processEffects();
+
+	// record what we've got so far or add the frozen output
+	bool frozen = false;
+	if( m_freezeCache )
+	{
+		frozen = m_freezeCache->process( m_portBuffer, fpp,
+							me || m_bufferUsage );
+	}
+
+	if( me || m_bufferUsage || frozen )
 	{
 		Engine::fxMixer()->mixToChannel( m_portBuffer, m_nextFxChannel ); 	// send output to fx mixer
 																			// TODO: improve the flow here - convert to pull model
@@ -26,6 +26,11 @@
 #include "fft_helpers.h"
 
 #include <cmath>
+#include <QtCore/QFile>
+#include <QtCore/QMap>
+#include <QtCore/QMutex>
+
+#include "ConfigManager.h"
 #include "lmms_constants.h"
 
 /* returns biggest value from abs_spectrum[spec_size] array
@@ -241,3 +246,96 @@ float signalpower(float *timesignal, int num_values)
 	return power;
 }
 
+
+
+
+/* FFTW's planner is not thread-safe, so all planning and wisdom handling
+   goes through this mutex - executing plans is thread-safe */
+static QMutex s_planMutex;
+static QMap<int, fftwf_plan> s_plans;
+static QMap<int, fftwf_plan> s_c2rPlans;
+static bool s_wisdomLoaded = false;
+
+static QByteArray wisdomFileName()
+{
+	return QFile::encodeName( ConfigManager::inst()->fftwWisdomFile() );
+}
+
+static void loadWisdom()
+{
+	if( !s_wisdomLoaded )
+	{
+		fftwf_import_wisdom_from_filename( wisdomFileName().constData() );
+		s_wisdomLoaded = true;
+	}
+}
+
+fftwf_plan sharedFftPlanR2C( int size )
+{
+	if( size <= 0 )
+		return NULL;
+
+	QMutexLocker lock( &s_planMutex );
+
+	QMap<int, fftwf_plan>::ConstIterator it = s_plans.find( size );
+	if( it != s_plans.end() )
+		return it.value();
+
+	loadWisdom();
+
+	// plan on temporary buffers - callers use the new-array execute
+	// functions with their own (fftwf_malloc()ed, thus aligned) buffers
+	float * in = (float *) fftwf_malloc( size * sizeof( float ) );
+	fftwf_complex * out = (fftwf_complex *)
+		fftwf_malloc( ( size / 2 + 1 ) * sizeof( fftwf_complex ) );
+
+	fftwf_plan plan = fftwf_plan_dft_r2c_1d( size, in, out, FFTW_MEASURE );
+
+	fftwf_free( in );
+	fftwf_free( out );
+
+	if( plan == NULL )
+		return NULL;
+
+	s_plans[size] = plan;
+
+	// remember what we measured so the next start doesn't need to again
+	fftwf_export_wisdom_to_filename( wisdomFileName().constData() );
+
+	return plan;
+}
+
+
+
+
+fftwf_plan sharedFftPlanC2R( int size )
+{
+	if( size <= 0 )
+		return NULL;
+
+	QMutexLocker lock( &s_planMutex );
+
+	QMap<int, fftwf_plan>::ConstIterator it = s_c2rPlans.find( size );
+	if( it != s_c2rPlans.end() )
+		return it.value();
+
+	loadWisdom();
+
+	fftwf_complex * in = (fftwf_complex *)
+		fftwf_malloc( ( size / 2 + 1 ) * sizeof( fftwf_complex ) );
+	float * out = (float *) fftwf_malloc( size * sizeof( float ) );
+
+	fftwf_plan plan = fftwf_plan_dft_c2r_1d( size, in, out, FFTW_MEASURE );
+
+	fftwf_free( in );
+	fftwf_free( out );
+
+	if( plan == NULL )
+		return NULL;
+
+	s_c2rPlans[size] = plan;
+
+	fftwf_export_wisdom_to_filename( wisdomFileName().constData() );
+
+	return plan;
+}
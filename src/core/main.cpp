@@ -42,10 +42,6 @@
 #include <windows.h>
 #endif
 
-#ifdef LMMS_HAVE_SCHED_H
-#include "sched.h"
-#endif
-
 #ifdef LMMS_HAVE_PROCESS_H
 #include <process.h>
 #endif
@@ -57,6 +53,7 @@
 #include <signal.h>
 
 #include "MainApplication.h"
+#include "BatchRenderer.h"
 #include "ConfigManager.h"
 #include "NotePlayHandle.h"
 #include "embed.h"
@@ -66,6 +63,7 @@
 #include "MainWindow.h"
 #include "OutputSettings.h"
 #include "ProjectRenderer.h"
+#include "RenderCoordinator.h"
 #include "RenderManager.h"
 #include "Song.h"
 #include "SetupDialog.h"
@@ -115,6 +113,7 @@ void printHelp()
 		"Copyright (c) %s\n\n"
 		"Usage: lmms [ -a ]\n"
 		"            [ -b <bitrate> ]\n"
+		"            [ --batch <job file> ] [ options ]\n"
 		"            [ -c <configfile> ]\n"
 		"            [ -d <in> ]\n"
 		"            [ -f <format> ]\n"
@@ -122,6 +121,7 @@ void printHelp()
 		"            [ -h ]\n"
 		"            [ -i <method> ]\n"
 		"            [ --import <in> [-e]]\n"
+		"            [ -j <processes> ]\n"
 		"            [ -l ]\n"
 		"            [ -m <mode>]\n"
 		"            [ -o <path> ]\n"
@@ -135,7 +135,15 @@ void printHelp()
 		"-a, --float                   32bit float bit depth\n"
 		"-b, --bitrate <bitrate>       Specify output bitrate in KBit/s\n"
 		"       Default: 160.\n"
+		"    --batch <job file>        Render all jobs listed in <job file>\n"
+		"       one after another, use - to read them from stdin.\n"
+		"       Each line is <project> [<output>] [<option>=<value> ...]\n"
+		"       with options format, samplerate, bitrate, float,\n"
+		"       interpolation, oversampling, loop and tracks. Other\n"
+		"       render options given on the command line are defaults.\n"
 		"-c, --config <configfile>     Get the configuration from <configfile>\n"
+		"    --cpus <list>             Only run the mixer threads on the given CPUs,\n"
+		"       e.g. 0-3,6\n"
 		"-d, --dump <in>               Dump XML of compressed file <in>\n"
 		"-f, --format <format>         Specify format of render-output where\n"
 		"       Format is either 'wav', 'ogg' or 'mp3'.\n"
@@ -150,6 +158,8 @@ void printHelp()
 		"          - sincbest\n"
 		"    --import <in> [-e]        Import MIDI file <in>.\n"
 		"       If -e is specified lmms exits after importing the file.\n"
+		"-j, --jobs <processes>        Split --rendertracks or --batch across\n"
+		"       <processes> lmms processes rendering in parallel.\n"
 		"-l, --loop                    Render as a loop\n"
 		"-m, --mode                    Stereo mode used for MP3 export\n"
 		"       Possible values: s, j, m\n"
@@ -161,6 +171,9 @@ void printHelp()
 		"       For --render, provide a file path\n"
 		"       For --rendertracks, provide a directory path\n"
 		"-p, --profile <out>           Dump profiling information to file <out>\n"
+		"       With --jobs, each process writes to <out>.<n>\n"
+		"    --rtprio <priority>       Realtime priority of audio threads,\n"
+		"       0 disables realtime scheduling\n"
 		"-r, --render <project file>   Render given project file\n"
 		"    --rendertracks <project>  Render each track to a different file\n"
 		"-s, --samplerate <samplerate> Specify output samplerate in Hz\n"
@@ -169,6 +182,8 @@ void printHelp()
 		"       Standard out is used if no output file is specifed\n"
 		"-v, --version                 Show version information and exit.\n"
 		"    --allowroot               Bypass root user startup check (use with caution).\n"
+		"    --workers <number>        Number of mixer worker threads\n"
+		"       Default: number of CPUs - 1\n"
 		"-x, --oversampling <value>    Specify oversampling\n"
 		"       Possible values: 1, 2, 4, 8\n"
 		"       Default: 2\n\n",
@@ -216,6 +231,13 @@ int main( int argc, char * * argv )
 	bool renderLoop = false;
 	bool renderTracks = false;
 	QString fileToLoad, fileToImport, renderOut, profilerOutputFile, configFile;
+	QString batchFile;
+	int renderProcesses = 1;
+	int worker = -1;
+	int workers = 1;
+	int mixerWorkers = -1;
+	int rtPriority = -1;
+	QString cpuList;
 
 	// first of two command-line parsing stages
 	for( int i = 1; i < argc; ++i )
@@ -224,7 +246,8 @@ int main( int argc, char * * argv )
 
 		if( arg == "--help"    || arg == "-h" ||
 		    arg == "--version" || arg == "-v" ||
-		    arg == "--render"  || arg == "-r" )
+		    arg == "--render"  || arg == "-r" ||
+		    arg == "--batch" )
 		{
 			coreOnly = true;
 		}
@@ -355,55 +378,152 @@ int main( int argc, char * * argv )
 			fileToLoad = QString::fromLocal8Bit( argv[i] );
 			renderOut = fileToLoad;
 		}
-		else if( arg == "--loop" || arg == "-l" )
+		else if( arg == "--batch" )
 		{
-			renderLoop = true;
+			++i;
+
+			if( i == argc )
+			{
+				printf( "\nNo job file specified.\n\n"
+	"Try \"%s --help\" for more information.\n\n", argv[0] );
+				return EXIT_FAILURE;
+			}
+
+
+			batchFile = QString::fromLocal8Bit( argv[i] );
 		}
-		else if( arg == "--output" || arg == "-o" )
+		else if( arg == "--jobs" || arg == "-j" )
 		{
 			++i;
 
 			if( i == argc )
 			{
-				printf( "\nNo output file specified.\n\n"
+				printf( "\nNo number of processes specified.\n\n"
 	"Try \"%s --help\" for more information.\n\n", argv[0] );
 				return EXIT_FAILURE;
 			}
 
 
-			renderOut = QString::fromLocal8Bit( argv[i] );
+			renderProcesses = QString( argv[i] ).toInt();
+			if( renderProcesses < 1 )
+			{
+				printf( "\nInvalid number of processes %s.\n\n"
+	"Try \"%s --help\" for more information.\n\n", argv[i], argv[0] );
+				return EXIT_FAILURE;
+			}
 		}
-		else if( arg == "--format" || arg == "-f" )
+		else if( arg == "--worker" )
+		{
+			// internal, passed to the processes started for --jobs
+			++i;
+
+			const QStringList share = i < argc ?
+				QString( argv[i] ).split( '/' ) : QStringList();
+			if( share.size() == 2 )
+			{
+				worker = share[0].toInt();
+				workers = share[1].toInt();
+			}
+			if( worker < 0 || worker >= workers )
+			{
+				printf( "\nInvalid worker specification.\n\n" );
+				return EXIT_FAILURE;
+			}
+		}
+		else if( arg == "--workers" )
 		{
 			++i;
 
 			if( i == argc )
 			{
-				printf( "\nNo output format specified.\n\n"
+				printf( "\nNo number of worker threads specified.\n\n"
+	"Try \"%s --help\" for more information.\n\n", argv[0] );
+				return EXIT_FAILURE;
+			}
+
+
+			bool ok;
+			mixerWorkers = QString( argv[i] ).toInt( &ok );
+			if( !ok || mixerWorkers < 0 )
+			{
+				printf( "\nInvalid number of worker threads %s.\n\n"
+	"Try \"%s --help\" for more information.\n\n", argv[i], argv[0] );
+				return EXIT_FAILURE;
+			}
+		}
+		else if( arg == "--cpus" )
+		{
+			++i;
+
+			if( i == argc )
+			{
+				printf( "\nNo CPUs specified.\n\n"
 	"Try \"%s --help\" for more information.\n\n", argv[0] );
 				return EXIT_FAILURE;
 			}
 
 
-			const QString ext = QString( argv[i] );
+			cpuList = QString( argv[i] );
+			QList<int> cpus;
+			if( !Mixer::threadSettings::parseCpuList( cpuList, cpus ) )
+			{
+				printf( "\nInvalid list of CPUs %s.\n\n"
+	"Try \"%s --help\" for more information.\n\n", argv[i], argv[0] );
+				return EXIT_FAILURE;
+			}
+		}
+		else if( arg == "--rtprio" )
+		{
+			++i;
 
-			if( ext == "wav" )
+			if( i == argc )
 			{
-				eff = ProjectRenderer::WaveFile;
+				printf( "\nNo realtime priority specified.\n\n"
+	"Try \"%s --help\" for more information.\n\n", argv[0] );
+				return EXIT_FAILURE;
 			}
-#ifdef LMMS_HAVE_OGGVORBIS
-			else if( ext == "ogg" )
+
+
+			bool ok;
+			rtPriority = QString( argv[i] ).toInt( &ok );
+			if( !ok || rtPriority < 0 )
 			{
-				eff = ProjectRenderer::OggFile;
+				printf( "\nInvalid realtime priority %s.\n\n"
+	"Try \"%s --help\" for more information.\n\n", argv[i], argv[0] );
+				return EXIT_FAILURE;
 			}
-#endif
-#ifdef LMMS_HAVE_MP3LAME
-			else if( ext == "mp3" )
+		}
+		else if( arg == "--loop" || arg == "-l" )
+		{
+			renderLoop = true;
+		}
+		else if( arg == "--output" || arg == "-o" )
+		{
+			++i;
+
+			if( i == argc )
 			{
-				eff = ProjectRenderer::MP3File;
+				printf( "\nNo output file specified.\n\n"
+	"Try \"%s --help\" for more information.\n\n", argv[0] );
+				return EXIT_FAILURE;
 			}
-#endif
-			else
+
+
+			renderOut = QString::fromLocal8Bit( argv[i] );
+		}
+		else if( arg == "--format" || arg == "-f" )
+		{
+			++i;
+
+			if( i == argc )
+			{
+				printf( "\nNo output format specified.\n\n"
+	"Try \"%s --help\" for more information.\n\n", argv[0] );
+				return EXIT_FAILURE;
+			}
+
+
+			if( !ProjectRenderer::parseFileFormat( argv[i], eff ) )
 			{
 				printf( "\nInvalid output format %s.\n\n"
 	"Try \"%s --help\" for more information.\n\n", argv[i], argv[0] );
@@ -422,12 +542,7 @@ int main( int argc, char * * argv )
 			}
 
 
-			sample_rate_t sr = QString( argv[i] ).toUInt();
-			if( sr >= 44100 && sr <= 192000 )
-			{
-				os.setSampleRate(sr);
-			}
-			else
+			if( !ProjectRenderer::parseSampleRate( argv[i], os ) )
 			{
 				printf( "\nInvalid samplerate %s.\n\n"
 	"Try \"%s --help\" for more information.\n\n", argv[i], argv[0] );
@@ -446,15 +561,7 @@ int main( int argc, char * * argv )
 			}
 
 
-			int br = QString( argv[i] ).toUInt();
-
-			if( br >= 64 && br <= 384 )
-			{
-				OutputSettings::BitRateSettings bitRateSettings = os.getBitRateSettings();
-				bitRateSettings.setBitRate(br);
-				os.setBitRateSettings(bitRateSettings);
-			}
-			else
+			if( !ProjectRenderer::parseBitRate( argv[i], os ) )
 			{
 				printf( "\nInvalid bitrate %s.\n\n"
 	"Try \"%s --help\" for more information.\n\n", argv[i], argv[0] );
@@ -509,25 +616,7 @@ int main( int argc, char * * argv )
 			}
 
 
-			const QString ip = QString( argv[i] );
-
-			if( ip == "linear" )
-			{
-		qs.interpolation = Mixer::qualitySettings::Interpolation_Linear;
-			}
-			else if( ip == "sincfastest" )
-			{
-		qs.interpolation = Mixer::qualitySettings::Interpolation_SincFastest;
-			}
-			else if( ip == "sincmedium" )
-			{
-		qs.interpolation = Mixer::qualitySettings::Interpolation_SincMedium;
-			}
-			else if( ip == "sincbest" )
-			{
-		qs.interpolation = Mixer::qualitySettings::Interpolation_SincBest;
-			}
-			else
+			if( !ProjectRenderer::parseInterpolation( argv[i], qs ) )
 			{
 				printf( "\nInvalid interpolation method %s.\n\n"
 	"Try \"%s --help\" for more information.\n\n", argv[i], argv[0] );
@@ -546,23 +635,8 @@ int main( int argc, char * * argv )
 			}
 
 
-			int o = QString( argv[i] ).toUInt();
-
-			switch( o )
+			if( !ProjectRenderer::parseOversampling( argv[i], qs ) )
 			{
-				case 1:
-		qs.oversampling = Mixer::qualitySettings::Oversampling_None;
-		break;
-				case 2:
-		qs.oversampling = Mixer::qualitySettings::Oversampling_2x;
-		break;
-				case 4:
-		qs.oversampling = Mixer::qualitySettings::Oversampling_4x;
-		break;
-				case 8:
-		qs.oversampling = Mixer::qualitySettings::Oversampling_8x;
-		break;
-				default:
 				printf( "\nInvalid oversampling %s.\n\n"
 	"Try \"%s --help\" for more information.\n\n", argv[i], argv[0] );
 				return EXIT_FAILURE;
@@ -638,6 +712,45 @@ int main( int argc, char * * argv )
 		fileCheck( fileToImport );
 	}
 
+	// let several copies of ourselves render a share of the tracks or jobs
+	// each, one engine per process
+	if( renderProcesses > 1 && worker < 0 &&
+				( renderTracks || !batchFile.isEmpty() ) )
+	{
+		QStringList arguments;
+		for( int i = 1; i < argc; ++i )
+		{
+			const QString arg = argv[i];
+			// every worker gets a profile file of its own
+			if( arg == "--jobs" || arg == "-j" ||
+				arg == "--profile" || arg == "-p" )
+			{
+				++i;
+				continue;
+			}
+			arguments << QString::fromLocal8Bit( argv[i] );
+		}
+
+		RenderCoordinator * coordinator =
+			new RenderCoordinator( arguments, renderProcesses );
+		coordinator->setProfilerOutputFile( profilerOutputFile );
+		if( batchFile == "-" )
+		{
+			// we can only read our stdin once, so pass it on
+			QFile input;
+			input.open( stdin, QIODevice::ReadOnly );
+			coordinator->setInput( input.readAll() );
+		}
+		app->connect( coordinator, SIGNAL( finished() ), SLOT( quit() ) );
+		coordinator->start();
+		app->exec();
+
+		const int failed = coordinator->failedWorkers();
+		delete coordinator;
+		delete app;
+		return failed > 0 ? EXIT_FAILURE : EXIT_SUCCESS;
+	}
+
 	ConfigManager::inst()->loadConfigFile(configFile);
 
 	// set language
@@ -661,20 +774,29 @@ int main( int argc, char * * argv )
 	loadTranslation( pos );
 
 
-	// try to set realtime priority
-#ifdef LMMS_BUILD_LINUX
-#ifdef LMMS_HAVE_SCHED_H
-#ifndef __OpenBSD__
-	struct sched_param sparam;
-	sparam.sched_priority = ( sched_get_priority_max( SCHED_FIFO ) +
-				sched_get_priority_min( SCHED_FIFO ) ) / 2;
-	if( sched_setscheduler( 0, SCHED_FIFO, &sparam ) == -1 )
+	// thread setup from configuration, command line options override it
+	// for this session only
+	Mixer::threadSettings ts;
+	ts.loadFromConfig();
+	if( mixerWorkers >= 0 )
 	{
-		printf( "Notice: could not set realtime priority.\n" );
+		ts.workers = mixerWorkers;
 	}
-#endif
-#endif
-#endif
+	if( !cpuList.isEmpty() )
+	{
+		Mixer::threadSettings::parseCpuList( cpuList, ts.cpus );
+	}
+	if( rtPriority >= 0 )
+	{
+		ts.realtime = rtPriority > 0;
+		ts.priority = rtPriority;
+	}
+	Mixer::setThreadSettings( ts );
+
+	// try to set realtime priority - all threads created from now on
+	// inherit it; the CPU affinity is only applied by the mixer threads
+	// themselves so that the GUI isn't restricted to these CPUs
+	Mixer::setupThread( false );
 
 #ifdef LMMS_BUILD_WIN32
 	if( !SetPriorityClass( GetCurrentProcess(), HIGH_PRIORITY_CLASS ) )
@@ -698,10 +820,48 @@ int main( int argc, char * * argv )
 #endif
 
 	bool destroyEngine = false;
+	BatchRenderer * batchRenderer = NULL;
+
+	// render all jobs of the job list reusing the engine for all of them
+	if( !batchFile.isEmpty() )
+	{
+		batchRenderer = new BatchRenderer( qs, os, eff, renderLoop );
+		if( worker >= 0 )
+		{
+			batchRenderer->setWorker( worker, workers );
+		}
 
+		QFile jobFile( batchFile );
+		const bool opened = batchFile == "-" ?
+				jobFile.open( stdin, QIODevice::ReadOnly ) :
+				jobFile.open( QIODevice::ReadOnly );
+		if( !opened )
+		{
+			printf( "\nCould not open job file %s.\n\n",
+					batchFile.toUtf8().constData() );
+			return EXIT_FAILURE;
+		}
+		if( !batchRenderer->readJobs( jobFile ) )
+		{
+			return EXIT_FAILURE;
+		}
+		printf( "%d jobs to render\n", batchRenderer->jobCount() );
+
+		Engine::init( true );
+		destroyEngine = true;
+
+		if( profilerOutputFile.isEmpty() == false )
+		{
+			Engine::mixer()->profiler().setOutputFile( profilerOutputFile );
+		}
+
+		QCoreApplication::instance()->connect( batchRenderer,
+				SIGNAL( finished() ), SLOT( quit() ) );
+		batchRenderer->start();
+	}
 	// if we have an output file for rendering, just render the song
 	// without starting the GUI
-	if( !renderOut.isEmpty() )
+	else if( !renderOut.isEmpty() )
 	{
 		Engine::init( true );
 		destroyEngine = true;
@@ -741,6 +901,11 @@ int main( int argc, char * * argv )
 			Engine::mixer()->profiler().setOutputFile( profilerOutputFile );
 		}
 
+		if( worker >= 0 )
+		{
+			r->setWorker( worker, workers );
+		}
+
 		// start now!
 		if ( renderTracks )
 		{
@@ -920,9 +1085,18 @@ int main( int argc, char * * argv )
 		}
 	}
 
-	const int ret = app->exec();
+	int ret = app->exec();
 	delete app;
 
+	if( batchRenderer )
+	{
+		if( batchRenderer->failedJobs() > 0 )
+		{
+			ret = EXIT_FAILURE;
+		}
+		delete batchRenderer;
+	}
+
 	if( destroyEngine )
 	{
 		Engine::destroy();
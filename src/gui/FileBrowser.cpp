@@ -551,13 +551,14 @@ void FileBrowserTreeWidget::mouseReleaseEvent(QMouseEvent * me )
 
 void FileBrowserTreeWidget::handleFile(FileItem * f, InstrumentTrack * it )
 {
-	Engine::mixer()->requestChangeInModel();
 	switch( f->handling() )
 	{
 		case FileItem::LoadAsProject:
 			if( gui->mainWindow()->mayChangeProject(true) )
 			{
+				Engine::mixer()->requestChangeInModel();
 				Engine::getSong()->loadProject( f->fullName() );
+				Engine::mixer()->doneChangeInModel();
 			}
 			break;
 
@@ -568,9 +569,13 @@ void FileBrowserTreeWidget::handleFile(FileItem * f, InstrumentTrack * it )
 			if( i == NULL ||
 				!i->descriptor()->supportsFileType( e ) )
 			{
+				Engine::mixer()->requestChangeInModel();
 				i = it->loadInstrument(
 					pluginFactory->pluginSupportingExtension(e).name() );
+				Engine::mixer()->doneChangeInModel();
 			}
+			// instruments guard their own data while loading, so
+			// decoding a file doesn't need to hold up the mixer
 			i->loadFile( f->fullName() );
 			break;
 		}
@@ -580,13 +585,17 @@ void FileBrowserTreeWidget::handleFile(FileItem * f, InstrumentTrack * it )
 			DataFile dataFile( f->fullName() );
 			InstrumentTrack::removeMidiPortNode( dataFile );
 			it->setSimpleSerializing();
+			Engine::mixer()->requestChangeInModel();
 			it->loadSettings( dataFile.content().toElement() );
+			Engine::mixer()->doneChangeInModel();
 			break;
 		}
 
 		case FileItem::ImportAsProject:
+			Engine::mixer()->requestChangeInModel();
 			ImportFilter::import( f->fullName(),
 							Engine::getSong() );
+			Engine::mixer()->doneChangeInModel();
 			break;
 
 		case FileItem::NotSupported:
@@ -594,7 +603,6 @@ void FileBrowserTreeWidget::handleFile(FileItem * f, InstrumentTrack * it )
 			break;
 
 	}
-	Engine::mixer()->doneChangeInModel();
 }
 
 
@@ -571,29 +571,33 @@ void FxMixerView::updateFaders()
 {
 	FxMixer * m = Engine::fxMixer();
 
-	// apply master gain
-	m->effectChannel(0)->m_peakLeft *= Engine::mixer()->masterGain();
-	m->effectChannel(0)->m_peakRight *= Engine::mixer()->masterGain();
-
 	for( int i = 0; i < m_fxChannelViews.size(); ++i )
 	{
 		const float opl = m_fxChannelViews[i]->m_fader->getPeak_L();
 		const float opr = m_fxChannelViews[i]->m_fader->getPeak_R();
 		const float fall_off = 1.2;
-		if( m->effectChannel(i)->m_peakLeft > opl )
+
+		// peaks published by the audio threads since the last update
+		FxChannelMeter meter;
+		if( m->effectChannel(i)->pollMeter( meter ) && i == 0 )
+		{
+			// apply master gain
+			meter.peakLeft *= Engine::mixer()->masterGain();
+			meter.peakRight *= Engine::mixer()->masterGain();
+		}
+
+		if( meter.peakLeft > opl )
 		{
-			m_fxChannelViews[i]->m_fader->setPeak_L( m->effectChannel(i)->m_peakLeft );
-			m->effectChannel(i)->m_peakLeft = 0;
+			m_fxChannelViews[i]->m_fader->setPeak_L( meter.peakLeft );
 		}
 		else
 		{
 			m_fxChannelViews[i]->m_fader->setPeak_L( opl/fall_off );
 		}
 
-		if( m->effectChannel(i)->m_peakRight > opr )
+		if( meter.peakRight > opr )
 		{
-			m_fxChannelViews[i]->m_fader->setPeak_R( m->effectChannel(i)->m_peakRight );
-			m->effectChannel(i)->m_peakRight = 0;
+			m_fxChannelViews[i]->m_fader->setPeak_R( meter.peakRight );
 		}
 		else
 		{
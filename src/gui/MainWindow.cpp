@@ -43,6 +43,7 @@
 #include "AutomationEditor.h"
 #include "BBEditor.h"
 #include "ControllerRackView.h"
+#include "DataFile.h"
 #include "embed.h"
 #include "Engine.h"
 #include "FileBrowser.h"
@@ -1407,7 +1408,9 @@ void MainWindow::closeEvent( QCloseEvent * _ce )
 
 void MainWindow::sessionCleanup()
 {
-	// delete recover session files
+	// delete recover session files - after a pending autosave has been
+	// written, otherwise it would bring the file back
+	DataFile::waitForBackgroundWrite();
 	QFile::remove( ConfigManager::inst()->recoveryFile() );
 	setSession( Normal );
 }
@@ -1556,20 +1559,22 @@ void MainWindow::autoSave()
 	if( !Engine::getSong()->isExporting() &&
 		!Engine::getSong()->isLoadingProject() &&
 		!RemotePluginBase::isMainThreadWaiting() &&
-		!QApplication::mouseButtons() &&
-		( ConfigManager::inst()->value( "ui",
-				"enablerunningautosave" ).toInt() ||
-			! Engine::getSong()->isPlaying() ) )
+		!QApplication::mouseButtons() )
 	{
-		Engine::getSong()->saveProjectFile(ConfigManager::inst()->recoveryFile());
-		autoSaveTimerReset();  // Reset timer
-	}
-	else
-	{
-		// try again in 10 seconds
-		if( getAutoSaveTimerInterval() != m_autoSaveShortTime )
+		// collecting the project's state is all we do here -
+		// formatting, compressing and writing it is done in the
+		// background, so this is cheap enough to do while playing
+		if( Engine::getSong()->saveProjectFile(
+				ConfigManager::inst()->recoveryFile(), true ) )
 		{
-			autoSaveTimerReset( m_autoSaveShortTime );
+			autoSaveTimerReset();  // Reset timer
+			return;
 		}
 	}
+
+	// try again in 10 seconds
+	if( getAutoSaveTimerInterval() != m_autoSaveShortTime )
+	{
+		autoSaveTimerReset( m_autoSaveShortTime );
+	}
 }
@@ -43,6 +43,7 @@
 #include "debug.h"
 #include "ToolTip.h"
 #include "FileDialog.h"
+#include "VoicePool.h"
 
 
 // platform-specific audio-interface-classes
@@ -118,10 +119,10 @@ SetupDialog::SetupDialog( ConfigTabs _tab_to_open ) :
 	m_backgroundArtwork( QDir::toNativeSeparators( ConfigManager::inst()->backgroundArtwork() ) ),
 	m_smoothScroll( ConfigManager::inst()->value( "ui", "smoothscroll" ).toInt() ),
 	m_enableAutoSave( ConfigManager::inst()->value( "ui", "enableautosave", "1" ).toInt() ),
-	m_enableRunningAutoSave( ConfigManager::inst()->value( "ui", "enablerunningautosave", "0" ).toInt() ),
 	m_saveInterval(	ConfigManager::inst()->value( "ui", "saveinterval" ).toInt() < 1 ?
 					MainWindow::DEFAULT_SAVE_INTERVAL_MINUTES :
 			ConfigManager::inst()->value( "ui", "saveinterval" ).toInt() ),
+	m_polyphony( VoicePoolBase::polyphony() ),
 	m_oneInstrumentTrackWindow( ConfigManager::inst()->value( "ui",
 					"oneinstrumenttrackwindow" ).toInt() ),
 	m_compactTrackButtons( ConfigManager::inst()->value( "ui",
@@ -654,7 +655,7 @@ SetupDialog::SetupDialog( ConfigTabs _tab_to_open ) :
 
 
 	QWidget * performance = new QWidget( ws );
-	performance->setFixedSize( 360, 200 );
+	performance->setFixedSize( 360, 300 );
 	QVBoxLayout * perf_layout = new QVBoxLayout( performance );
 	perf_layout->setSpacing( 0 );
 	perf_layout->setMargin( 0 );
@@ -687,13 +688,6 @@ SetupDialog::SetupDialog( ConfigTabs _tab_to_open ) :
 	connect( m_autoSave, SIGNAL( toggled( bool ) ),
 				this, SLOT( toggleAutoSave( bool ) ) );
 
-	m_runningAutoSave = new LedCheckBox(
-			tr( "Allow auto-save while playing" ), auto_save_tw );
-	m_runningAutoSave->move( 20, 90 );
-	m_runningAutoSave->setChecked( m_enableRunningAutoSave );
-	connect( m_runningAutoSave, SIGNAL( toggled( bool ) ),
-				this, SLOT( toggleRunningAutoSave( bool ) ) );
-
 	QPushButton * autoSaveResetBtn = new QPushButton(
 			embed::getIconPixmap( "reload" ), "", auto_save_tw );
 	autoSaveResetBtn->setGeometry( 290, 70, 28, 28 );
@@ -708,7 +702,6 @@ SetupDialog::SetupDialog( ConfigTabs _tab_to_open ) :
 						SLOT( displaySaveIntervalHelp() ) );
 
 	m_saveIntervalSlider->setEnabled( m_enableAutoSave );
-	m_runningAutoSave->setVisible( m_enableAutoSave );
 
 
 	perf_layout->addWidget( auto_save_tw );
@@ -738,6 +731,43 @@ SetupDialog::SetupDialog( ConfigTabs _tab_to_open ) :
 
 
 	perf_layout->addWidget( ui_fx_tw );
+	perf_layout->addSpacing( 10 );
+
+
+	TabWidget * polyphony_tw = new TabWidget(
+			tr( "Instrument voices" ).toUpper(), performance );
+	polyphony_tw->setFixedHeight( 80 );
+
+	m_polyphonySlider = new QSlider( Qt::Horizontal, polyphony_tw );
+	m_polyphonySlider->setRange( 1, VoicePoolBase::MaxPolyphony );
+	m_polyphonySlider->setTickPosition( QSlider::TicksBelow );
+	m_polyphonySlider->setPageStep( 4 );
+	m_polyphonySlider->setTickInterval( 4 );
+	m_polyphonySlider->setGeometry( 10, 16, 340, 18 );
+	m_polyphonySlider->setValue( m_polyphony );
+
+	connect( m_polyphonySlider, SIGNAL( valueChanged( int ) ), this,
+						SLOT( setPolyphony( int ) ) );
+
+	m_polyphonyLbl = new QLabel( polyphony_tw );
+	m_polyphonyLbl->setGeometry( 10, 40, 260, 24 );
+	setPolyphony( m_polyphonySlider->value() );
+
+	QPushButton * polyphony_reset_btn = new QPushButton(
+			embed::getIconPixmap( "reload" ), "", polyphony_tw );
+	polyphony_reset_btn->setGeometry( 290, 40, 28, 28 );
+	connect( polyphony_reset_btn, SIGNAL( clicked() ), this,
+						SLOT( resetPolyphony() ) );
+	ToolTip::add( polyphony_reset_btn, tr( "Reset to default-value" ) );
+
+	QPushButton * polyphony_help_btn = new QPushButton(
+			embed::getIconPixmap( "help" ), "", polyphony_tw );
+	polyphony_help_btn->setGeometry( 320, 40, 28, 28 );
+	connect( polyphony_help_btn, SIGNAL( clicked() ), this,
+						SLOT( displayPolyphonyHelp() ) );
+
+
+	perf_layout->addWidget( polyphony_tw );
 	perf_layout->addStretch();
 
 
@@ -1063,8 +1093,8 @@ void SetupDialog::accept()
 					QString::number( m_enableAutoSave ) );
 	ConfigManager::inst()->setValue( "ui", "saveinterval",
 					QString::number( m_saveInterval ) );
-	ConfigManager::inst()->setValue( "ui", "enablerunningautosave",
-					QString::number( m_enableRunningAutoSave ) );
+	ConfigManager::inst()->setValue( "mixer", "polyphony",
+					QString::number( m_polyphony ) );
 	ConfigManager::inst()->setValue( "ui", "oneinstrumenttrackwindow",
 					QString::number( m_oneInstrumentTrackWindow ) );
 	ConfigManager::inst()->setValue( "ui", "compacttrackbuttons",
@@ -1245,21 +1275,12 @@ void SetupDialog::toggleAutoSave( bool _enabled )
 {
 	m_enableAutoSave = _enabled;
 	m_saveIntervalSlider->setEnabled( _enabled );
-	m_runningAutoSave->setVisible( _enabled );
 	setAutoSaveInterval( m_saveIntervalSlider->value() );
 }
 
 
 
 
-void SetupDialog::toggleRunningAutoSave( bool _enabled )
-{
-	m_enableRunningAutoSave = _enabled;
-}
-
-
-
-
 void SetupDialog::toggleCompactTrackButtons( bool _enabled )
 {
 	m_compactTrackButtons = _enabled;
@@ -1550,7 +1571,6 @@ void SetupDialog::resetAutoSave()
 {
 	setAutoSaveInterval( MainWindow::DEFAULT_SAVE_INTERVAL_MINUTES );
 	m_autoSave->setChecked( true );
-	m_runningAutoSave->setChecked( false );
 }
 
 
@@ -1560,15 +1580,46 @@ void SetupDialog::displaySaveIntervalHelp()
 {
 	QWhatsThis::showText( QCursor::pos(),
 			tr( "Set the time between automatic backup to %1.\n"
-			"Remember to also save your project manually. "
-			"You can choose to disable saving while playing, "
-			"something some older systems find difficult." ).arg(
+			"Remember to also save your project manually." ).arg(
 			ConfigManager::inst()->recoveryFile() ) );
 }
 
 
 
 
+void SetupDialog::setPolyphony( int _value )
+{
+	m_polyphony = _value;
+	m_polyphonyLbl->setText( tr( "Voices per instrument: %1" ).arg(
+								_value ) );
+}
+
+
+
+
+void SetupDialog::resetPolyphony()
+{
+	m_polyphonySlider->setValue( VoicePoolBase::DefaultPolyphony );
+}
+
+
+
+
+void SetupDialog::displayPolyphonyHelp()
+{
+	QWhatsThis::showText( QCursor::pos(),
+			tr( "Here you can set how many voices instruments "
+				"like Mallets, Monstro or Vibed keep ready "
+				"so that playing notes doesn't need to "
+				"allocate memory. Playing more notes at once "
+				"still works but may cause dropouts. Higher "
+				"values need more memory. The setting applies "
+				"to instruments created afterwards." ) );
+}
+
+
+
+
 void SetupDialog::audioInterfaceChanged( const QString & _iface )
 {
 	for( AswMap::iterator it = m_audioIfaceSetupWidgets.begin();
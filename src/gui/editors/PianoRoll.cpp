@@ -1401,11 +1401,19 @@ void PianoRoll::mousePressEvent(QMouseEvent * me )
 			// get note-vector of current pattern
 			const NoteVector & notes = m_pattern->notes();
 
+			// only notes around the click can be hit - in the note edit
+			// area that includes notes whose edit line is left of it
+			const int edit_line_ticks = NOTE_EDIT_LINE_WIDTH *
+					MidiTime::ticksPerTact() / m_ppt;
+			int first, last;
+			notesInRange( edit_note ? pos_ticks - edit_line_ticks :
+							pos_ticks, pos_ticks, first, last );
+
 			// will be our iterator in the following loop
-			NoteVector::ConstIterator it = notes.begin()+notes.size()-1;
+			NoteVector::ConstIterator it = notes.begin()+last-1;
 
-			// loop through whole note-vector...
-			for( int i = 0; i < notes.size(); ++i )
+			// loop through these notes, last one first...
+			for( int i = first; i < last; ++i )
 			{
 				Note *note = *it;
 				MidiTime len = note->length();
@@ -1423,8 +1431,7 @@ void PianoRoll::mousePressEvent(QMouseEvent * me )
 					note->key() == key_num )
 					||
 					( edit_note &&
-					pos_ticks <= note->pos() +
-						NOTE_EDIT_LINE_WIDTH * MidiTime::ticksPerTact() / m_ppt )
+					pos_ticks <= note->pos() + edit_line_ticks )
 					)
 					)
 				{
@@ -1433,6 +1440,12 @@ void PianoRoll::mousePressEvent(QMouseEvent * me )
 				--it;
 			}
 
+			if( it == notes.begin()+first-1 )
+			{
+				// no note was hit
+				it = notes.begin()-1;
+			}
+
 			// first check whether the user clicked in note-edit-
 			// area
 			if( edit_note )
@@ -1864,13 +1877,19 @@ void PianoRoll::computeSelectedNotes(bool shift)
 	//int y_base = noteEditTop() - 1;
 	if( hasValidPattern() )
 	{
-		for( Note *note : m_pattern->notes() )
+		// make a new selection unless they're holding shift
+		if( ! shift )
 		{
-			// make a new selection unless they're holding shift
-			if( ! shift )
-			{
-				note->setSelected( false );
-			}
+			clearSelectedNotes();
+		}
+
+		// only notes overlapping the selected ticks can be selected
+		const NoteVector & notes = m_pattern->notes();
+		int first, last;
+		notesInRange( sel_pos_start, sel_pos_end, first, last );
+		for( int i = first; i < last; ++i )
+		{
+			Note *note = notes[i];
 
 			int len_ticks = note->length();
 
@@ -1924,10 +1943,11 @@ void PianoRoll::mouseReleaseEvent( QMouseEvent * me )
 			computeSelectedNotes(
 					me->modifiers() & Qt::ShiftModifier );
 		}
-		else if( m_action == ActionMoveNote )
+		else if( m_action == ActionMoveNote ||
+				m_action == ActionResizeNote )
 		{
-			// we moved one or more notes so they have to be
-			// moved properly according to new starting-
+			// we moved or resized one or more notes so they have
+			// to be moved properly according to new starting-
 			// time in the note-array of pattern
 			m_pattern->rearrangeAllNotes();
 
@@ -2174,11 +2194,19 @@ void PianoRoll::mouseMoveEvent( QMouseEvent * me )
 			// get note-vector of current pattern
 			const NoteVector & notes = m_pattern->notes();
 
+			// only notes around the click can be hit - in the note edit
+			// area that includes notes whose edit line is left of it
+			const int edit_line_ticks = NOTE_EDIT_LINE_WIDTH *
+					MidiTime::ticksPerTact() / m_ppt;
+			int first, last;
+			notesInRange( edit_note ? pos_ticks - edit_line_ticks :
+							pos_ticks, pos_ticks, first, last );
+
 			// will be our iterator in the following loop
-			NoteVector::ConstIterator it = notes.begin()+notes.size()-1;
+			NoteVector::ConstIterator it = notes.begin()+last-1;
 
-			// loop through whole note-vector...
-			for( int i = 0; i < notes.size(); ++i )
+			// loop through these notes, last one first...
+			for( int i = first; i < last; ++i )
 			{
 				Note *note = *it;
 				// and check whether the cursor is over an
@@ -2583,6 +2611,7 @@ void PianoRoll::dragNotes( int x, int y, bool alt, bool shift, bool ctrl )
 		}
 	}
 
+	m_pattern->rearrangeAllNotes();
 	m_pattern->updateLength();
 	m_pattern->dataChanged();
 	Engine::getSong()->setModified();
@@ -2594,6 +2623,120 @@ int PianoRoll::xCoordOfTick(int tick )
 		* m_ppt / MidiTime::ticksPerTact() );
 }
 
+void PianoRoll::drawGrid( QPainter & _p )
+{
+	int q, x, tick;
+
+	if( m_zoomingModel.value() > 3 )
+	{
+		// If we're over 100% zoom, we allow all quantization level grids
+		q = quantization();
+	}
+	else if( quantization() % 3 != 0 )
+	{
+		// If we're under 100% zoom, we allow quantization grid up to 1/24 for triplets
+		// to ensure a dense doesn't fill out the background
+		q = quantization() < 8 ? 8 : quantization();
+	}
+	else {
+		// If we're under 100% zoom, we allow quantization grid up to 1/32 for normal notes
+		q = quantization() < 6 ? 6 : quantization();
+	}
+
+	const MeterModel & timeSig = Engine::getSong()->getTimeSigModel();
+
+	// everything the grid depends on - only re-render it when one of
+	// these changed, e.g. by scrolling, zooming or resizing
+	const QVector<int> params = QVector<int>() << width() << height() <<
+		keyAreaBottom() << m_currentPosition << m_startKey << m_ppt <<
+		m_zoomingModel.value() << q << timeSig.getNumerator() <<
+		timeSig.getDenominator() << (int) lineColor().rgba() <<
+		(int) beatLineColor().rgba() << (int) barLineColor().rgba() <<
+		(int) backgroundShade().rgba();
+
+	if( params != m_gridCacheParams )
+	{
+		m_gridCacheParams = params;
+		m_gridCache = QPixmap( size() );
+		m_gridCache.fill( Qt::transparent );
+
+		QPainter p( &m_gridCache );
+		p.setClipRect( WHITE_KEY_WIDTH, PR_TOP_MARGIN,
+					width() - WHITE_KEY_WIDTH,
+					height() - PR_TOP_MARGIN - PR_BOTTOM_MARGIN );
+
+		// First we draw the vertical quantization lines
+		for( tick = m_currentPosition - m_currentPosition % q, x = xCoordOfTick( tick );
+			x <= width(); tick += q, x = xCoordOfTick( tick ) )
+		{
+			p.setPen( lineColor() );
+			p.drawLine( x, PR_TOP_MARGIN, x, height() - PR_BOTTOM_MARGIN );
+		}
+
+		// Draw horizontal lines
+		int key = m_startKey;
+		for( int y = keyAreaBottom() - 1; y > PR_TOP_MARGIN;
+				y -= KEY_LINE_HEIGHT )
+		{
+			if( static_cast<Keys>( key % KeysPerOctave ) == Key_C )
+			{
+				// C note gets accented
+				p.setPen( beatLineColor() );
+			}
+			else
+			{
+				p.setPen( lineColor() );
+			}
+			p.drawLine( WHITE_KEY_WIDTH, y, width(), y );
+			++key;
+		}
+
+
+		// Draw alternating shades on bars
+		float timeSignature = static_cast<float>( timeSig.getNumerator() )
+				/ static_cast<float>( timeSig.getDenominator() );
+		float zoomFactor = m_zoomLevels[m_zoomingModel.value()];
+		//the bars which disappears at the left side by scrolling
+		int leftBars = m_currentPosition * zoomFactor / MidiTime::ticksPerTact();
+
+		//iterates the visible bars and draw the shading on uneven bars
+		for( int x = WHITE_KEY_WIDTH, barCount = leftBars; x < width() + m_currentPosition * zoomFactor / timeSignature; x += m_ppt, ++barCount )
+		{
+			if( ( barCount + leftBars )  % 2 != 0 )
+			{
+				p.fillRect( x - m_currentPosition * zoomFactor / timeSignature, PR_TOP_MARGIN, m_ppt,
+					height() - ( PR_BOTTOM_MARGIN + PR_TOP_MARGIN ), backgroundShade() );
+			}
+		}
+
+
+		// Draw the vertical beat lines
+		int ticksPerBeat = DefaultTicksPerTact / timeSig.getDenominator();
+
+		for( tick = m_currentPosition - m_currentPosition % ticksPerBeat,
+			x = xCoordOfTick( tick ); x <= width();
+			tick += ticksPerBeat, x = xCoordOfTick( tick ) )
+		{
+			p.setPen( beatLineColor() );
+			p.drawLine( x, PR_TOP_MARGIN, x, height() - PR_BOTTOM_MARGIN );
+		}
+
+		// Draw the vertical bar lines
+		for( tick = m_currentPosition - m_currentPosition % MidiTime::ticksPerTact(),
+			x = xCoordOfTick( tick ); x <= width();
+			tick += MidiTime::ticksPerTact(), x = xCoordOfTick( tick ) )
+		{
+			p.setPen( barLineColor() );
+			p.drawLine( x, PR_TOP_MARGIN, x, height() - PR_BOTTOM_MARGIN );
+		}
+	}
+
+	_p.drawPixmap( 0, 0, m_gridCache );
+}
+
+
+
+
 void PianoRoll::paintEvent(QPaintEvent * pe )
 {
 	bool drawNoteNames = ConfigManager::inst()->value( "ui", "printnotelabels").toInt();
@@ -2855,89 +2998,7 @@ void PianoRoll::paintEvent(QPaintEvent * pe )
 	// draw the grid
 	if( hasValidPattern() )
 	{
-		int q, x, tick;
-
-		if( m_zoomingModel.value() > 3 )
-		{
-			// If we're over 100% zoom, we allow all quantization level grids
-			q = quantization();
-		}
-		else if( quantization() % 3 != 0 )
-		{
-			// If we're under 100% zoom, we allow quantization grid up to 1/24 for triplets
-			// to ensure a dense doesn't fill out the background
-			q = quantization() < 8 ? 8 : quantization();
-		}
-		else {
-			// If we're under 100% zoom, we allow quantization grid up to 1/32 for normal notes
-			q = quantization() < 6 ? 6 : quantization();
-		}
-
-		// First we draw the vertical quantization lines
-		for( tick = m_currentPosition - m_currentPosition % q, x = xCoordOfTick( tick );
-			x <= width(); tick += q, x = xCoordOfTick( tick ) )
-		{
-			p.setPen( lineColor() );
-			p.drawLine( x, PR_TOP_MARGIN, x, height() - PR_BOTTOM_MARGIN );
-		}
-
-		// Draw horizontal lines
-		key = m_startKey;
-		for( int y = keyAreaBottom() - 1; y > PR_TOP_MARGIN;
-				y -= KEY_LINE_HEIGHT )
-		{
-			if( static_cast<Keys>( key % KeysPerOctave ) == Key_C )
-			{
-				// C note gets accented
-				p.setPen( beatLineColor() );
-			}
-			else
-			{
-				p.setPen( lineColor() );
-			}
-			p.drawLine( WHITE_KEY_WIDTH, y, width(), y );
-			++key;
-		}
-
-
-		// Draw alternating shades on bars
-		float timeSignature = static_cast<float>( Engine::getSong()->getTimeSigModel().getNumerator() )
-				/ static_cast<float>( Engine::getSong()->getTimeSigModel().getDenominator() );
-		float zoomFactor = m_zoomLevels[m_zoomingModel.value()];
-		//the bars which disappears at the left side by scrolling
-		int leftBars = m_currentPosition * zoomFactor / MidiTime::ticksPerTact();
-
-		//iterates the visible bars and draw the shading on uneven bars
-		for( int x = WHITE_KEY_WIDTH, barCount = leftBars; x < width() + m_currentPosition * zoomFactor / timeSignature; x += m_ppt, ++barCount )
-		{
-			if( ( barCount + leftBars )  % 2 != 0 )
-			{
-				p.fillRect( x - m_currentPosition * zoomFactor / timeSignature, PR_TOP_MARGIN, m_ppt,
-					height() - ( PR_BOTTOM_MARGIN + PR_TOP_MARGIN ), backgroundShade() );
-			}
-		}
-
-
-		// Draw the vertical beat lines
-		int ticksPerBeat = DefaultTicksPerTact /
-			Engine::getSong()->getTimeSigModel().getDenominator();
-
-		for( tick = m_currentPosition - m_currentPosition % ticksPerBeat,
-			x = xCoordOfTick( tick ); x <= width();
-			tick += ticksPerBeat, x = xCoordOfTick( tick ) )
-		{
-			p.setPen( beatLineColor() );
-			p.drawLine( x, PR_TOP_MARGIN, x, height() - PR_BOTTOM_MARGIN );
-		}
-
-		// Draw the vertical bar lines
-		for( tick = m_currentPosition - m_currentPosition % MidiTime::ticksPerTact(),
-			x = xCoordOfTick( tick ); x <= width();
-			tick += MidiTime::ticksPerTact(), x = xCoordOfTick( tick ) )
-		{
-			p.setPen( barLineColor() );
-			p.drawLine( x, PR_TOP_MARGIN, x, height() - PR_BOTTOM_MARGIN );
-		}
+		drawGrid( p );
 	}
 
 
@@ -2971,9 +3032,17 @@ void PianoRoll::paintEvent(QPaintEvent * pe )
 
 		QPolygonF editHandles;
 
-		for( const Note *note : m_pattern->notes() )
+		// only look at notes which may be visible at all
+		const NoteVector & notes = m_pattern->notes();
+		const Pattern::NoteData & data = m_pattern->noteData();
+		int first, last;
+		notesInRange( m_currentPosition, m_currentPosition +
+				( width() - WHITE_KEY_WIDTH ) *
+					MidiTime::ticksPerTact() / m_ppt, first, last );
+
+		for( int i = first; i < last; ++i )
 		{
-			int len_ticks = note->length();
+			int len_ticks = data.lengths[i];
 
 			if( len_ticks == 0 )
 			{
@@ -2984,9 +3053,9 @@ void PianoRoll::paintEvent(QPaintEvent * pe )
 				len_ticks = 4;
 			}
 
-			const int key = note->key() - m_startKey + 1;
+			const int key = data.keys[i] - m_startKey + 1;
 
-			int pos_ticks = note->pos();
+			int pos_ticks = data.positions[i];
 
 			int note_width = len_ticks * m_ppt / MidiTime::ticksPerTact();
 			const int x = ( pos_ticks - m_currentPosition ) *
@@ -2997,6 +3066,9 @@ void PianoRoll::paintEvent(QPaintEvent * pe )
 				continue;
 			}
 
+			// only notes actually drawn need their handle
+			const Note *note = notes[i];
+
 			// is the note in visible area?
 			if( key > 0 && key <= visible_keys )
 			{
@@ -3013,7 +3085,7 @@ void PianoRoll::paintEvent(QPaintEvent * pe )
 			int editHandleTop = 0;
 			if( m_noteEditMode == NoteEditVolume )
 			{
-				QColor color = barColor().lighter( 30 + ( note->getVolume() * 90 / MaxVolume ) );
+				QColor color = barColor().lighter( 30 + ( data.volumes[i] * 90 / MaxVolume ) );
 				if( note->selected() )
 				{
 					color = selectedNoteColor();
@@ -3021,7 +3093,7 @@ void PianoRoll::paintEvent(QPaintEvent * pe )
 				p.setPen( QPen( color, NOTE_EDIT_LINE_WIDTH ) );
 
 				editHandleTop = noteEditBottom() -
-					( (float)( note->getVolume() - MinVolume ) ) /
+					( (float)( data.volumes[i] - MinVolume ) ) /
 					( (float)( MaxVolume - MinVolume ) ) *
 					( (float)( noteEditBottom() - noteEditTop() ) );
 
@@ -3040,7 +3112,7 @@ void PianoRoll::paintEvent(QPaintEvent * pe )
 				p.setPen( QPen( color, NOTE_EDIT_LINE_WIDTH ) );
 
 				editHandleTop = noteEditBottom() -
-					( (float)( note->getPanning() - PanningLeft ) ) /
+					( (float)( data.pannings[i] - PanningLeft ) ) /
 					( (float)( (PanningRight - PanningLeft ) ) ) *
 					( (float)( noteEditBottom() - noteEditTop() ) );
 
@@ -3254,6 +3326,7 @@ void PianoRoll::wheelEvent(QWheelEvent * we )
 					showPanTextFloat( nv[0]->getPanning(), we->pos(), 1000 );
 				}
 			}
+			m_pattern->dataChanged();
 			update();
 		}
 	}
@@ -3668,6 +3741,8 @@ void PianoRoll::enterValue( NoteVector* nv )
 		}
 
 	}
+
+	m_pattern->dataChanged();
 }
 
 
@@ -4007,6 +4082,24 @@ bool PianoRoll::mouseOverNote()
 
 
 
+void PianoRoll::notesInRange( int startTick, int endTick,
+						int & first, int & last ) const
+{
+	if( m_action == ActionMoveNote || m_action == ActionResizeNote )
+	{
+		// the notes are being edited right now and the pattern's index
+		// is only updated once the mouse is released
+		first = 0;
+		last = m_pattern->notes().size();
+		return;
+	}
+	// step notes are drawn with a length of 4 ticks
+	m_pattern->notesInRange( startTick - 4, endTick, first, last );
+}
+
+
+
+
 Note * PianoRoll::noteUnderMouse()
 {
 	QPoint pos = mapFromGlobal( QCursor::pos() );
@@ -4023,9 +4116,13 @@ Note * PianoRoll::noteUnderMouse()
 	int pos_ticks = ( pos.x() - WHITE_KEY_WIDTH ) *
 			MidiTime::ticksPerTact() / m_ppt + m_currentPosition;
 
-	// loop through whole note-vector...
-	for( Note* const& note : m_pattern->notes() )
+	// loop through all notes around the cursor...
+	const NoteVector & notes = m_pattern->notes();
+	int first, last;
+	notesInRange( pos_ticks, pos_ticks, first, last );
+	for( int i = first; i < last; ++i )
 	{
+		Note * note = notes[i];
 		// and check whether the cursor is over an
 		// existing note
 		if( pos_ticks >= note->pos()
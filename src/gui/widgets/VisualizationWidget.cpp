@@ -35,8 +35,6 @@
 #include "ToolTip.h"
 #include "Song.h"
 
-#include "BufferManager.h"
-
 
 VisualizationWidget::VisualizationWidget( const QPixmap & _bg, QWidget * _p,
 						visualizationTypes _vtype ) :
@@ -49,12 +47,6 @@ VisualizationWidget::VisualizationWidget( const QPixmap & _bg, QWidget * _p,
 	setAttribute( Qt::WA_OpaquePaintEvent, true );
 	setActive( ConfigManager::inst()->value( "ui", "displaywaveform").toInt() );
 
-	const fpp_t frames = Engine::mixer()->framesPerPeriod();
-	m_buffer = new sampleFrame[frames];
-
-	BufferManager::clear( m_buffer, frames );
-
-
 	ToolTip::add( this, tr( "click to enable/disable visualization of "
 							"master-output" ) );
 }
@@ -64,25 +56,12 @@ VisualizationWidget::VisualizationWidget( const QPixmap & _bg, QWidget * _p,
 
 VisualizationWidget::~VisualizationWidget()
 {
-	delete[] m_buffer;
 	delete[] m_points;
 }
 
 
 
 
-void VisualizationWidget::updateAudioBuffer( const surroundSampleFrame * buffer )
-{
-	if( !Engine::getSong()->isExporting() )
-	{
-		const fpp_t fpp = Engine::mixer()->framesPerPeriod();
-		memcpy( m_buffer, buffer, sizeof( surroundSampleFrame ) * fpp );
-	}
-}
-
-
-
-
 void VisualizationWidget::setActive( bool _active )
 {
 	m_active = _active;
@@ -91,18 +70,12 @@ void VisualizationWidget::setActive( bool _active )
 		connect( gui->mainWindow(),
 					SIGNAL( periodicUpdate() ),
 					this, SLOT( update() ) );
-		connect( Engine::mixer(),
-			SIGNAL( nextAudioBuffer( const surroundSampleFrame* ) ),
-			this, SLOT( updateAudioBuffer( const surroundSampleFrame* ) ) );
 	}
 	else
 	{
 		disconnect( gui->mainWindow(),
 					SIGNAL( periodicUpdate() ),
 					this, SLOT( update() ) );
-		disconnect( Engine::mixer(),
-			SIGNAL( nextAudioBuffer( const surroundSampleFrame* ) ),
-			this, SLOT( updateAudioBuffer( const surroundSampleFrame* ) ) );
 		// we have to update (remove last waves),
 		// because timer doesn't do that anymore
 		update();
@@ -120,7 +93,7 @@ void VisualizationWidget::paintEvent( QPaintEvent * )
 
 	if( m_active && !Engine::getSong()->isExporting() )
 	{
-		Mixer const * mixer = Engine::mixer();
+		Mixer * mixer = Engine::mixer();
 
 		float master_output = mixer->masterGain();
 		int w = width()-4;
@@ -132,9 +105,11 @@ void VisualizationWidget::paintEvent( QPaintEvent * )
 
 
 		const fpp_t frames = mixer->framesPerPeriod();
+		// latest period published by the audio thread
+		const surroundSampleFrame * buffer = mixer->outputSnapshot();
 		float peakLeft;
 		float peakRight;
-		mixer->getPeakValues( m_buffer, frames, peakLeft, peakRight );
+		mixer->getPeakValues( buffer, frames, peakLeft, peakRight );
 		const float max_level = qMax<float>( peakLeft, peakRight );
 
 		// and set color according to that...
@@ -164,7 +139,7 @@ void VisualizationWidget::paintEvent( QPaintEvent * )
 				m_points[frame] = QPointF(
 					x_base + (float) frame * xd,
 					y_base + ( Mixer::clip(
-						m_buffer[frame][ch] ) *
+						buffer[frame][ch] ) *
 								half_h ) );
 			}
 			p.drawPolyline( m_points, frames );
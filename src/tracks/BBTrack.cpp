@@ -164,6 +164,7 @@ BBTCOView::BBTCOView( TrackContentObject * _tco, TrackView * _tv ) :
 {
 	connect( _tco->getTrack(), SIGNAL( dataChanged() ), this, SLOT( update() ) );
 
+	setAttribute( Qt::WA_OpaquePaintEvent, true );
 	setStyle( QApplication::style() );
 }
 
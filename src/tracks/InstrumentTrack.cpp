@@ -35,6 +35,8 @@
 #include <QMessageBox>
 #include <QMdiSubWindow>
 #include <QPainter>
+#include <QProgressDialog>
+#include <QUuid>
 
 #include "FileDialog.h"
 #include "InstrumentTrack.h"
@@ -47,6 +49,8 @@
 #include "EffectRackView.h"
 #include "embed.h"
 #include "FileBrowser.h"
+#include "FreezeCache.h"
+#include "FreezeRenderer.h"
 #include "FxMixer.h"
 #include "FxMixerView.h"
 #include "GuiApplication.h"
@@ -109,7 +113,9 @@ InstrumentTrack::InstrumentTrack( TrackContainer* tc ) :
 	m_soundShaping( this ),
 	m_arpeggio( this ),
 	m_noteStacking( this ),
-	m_piano( this )
+	m_piano( this ),
+	m_frozenModel( false, this, tr( "Frozen" ) ),
+	m_freezeCache( NULL )
 {
 	m_pitchModel.setCenterValue( 0 );
 	m_panningModel.setCenterValue( DefaultPanning );
@@ -130,6 +136,7 @@ InstrumentTrack::InstrumentTrack( TrackContainer* tc ) :
 	connect( &m_pitchModel, SIGNAL( dataChanged() ), this, SLOT( updatePitch() ) );
 	connect( &m_pitchRangeModel, SIGNAL( dataChanged() ), this, SLOT( updatePitchRange() ) );
 	connect( &m_effectChannelModel, SIGNAL( dataChanged() ), this, SLOT( updateEffectChannel() ) );
+	connect( &m_frozenModel, SIGNAL( dataChanged() ), this, SLOT( updateFrozen() ) );
 }
 
 
@@ -149,6 +156,9 @@ InstrumentTrack::~InstrumentTrack()
 
 	// now we're save deleting the instrument
 	if( m_instrument ) delete m_instrument;
+
+	m_audioPort.setFreezeCache( NULL );
+	delete m_freezeCache;
 }
 
 
@@ -605,6 +615,11 @@ void InstrumentTrack::removeMidiPortNode( DataFile & _dataFile )
 bool InstrumentTrack::play( const MidiTime & _start, const fpp_t _frames,
 							const f_cnt_t _offset, int _tco_num )
 {
+	if( m_freezeCache && _tco_num < 0 )
+	{
+		m_freezeCache->sync( _start.getTicks(), _offset );
+	}
+
 	if( ! m_instrument || ! tryLock() )
 	{
 		return false;
@@ -635,6 +650,13 @@ bool InstrumentTrack::play( const MidiTime & _start, const fpp_t _frames,
 		( *it )->processMidiTime( _start );
 	}
 
+	// frozen tracks are played back from the cache by our audio port
+	if( _tco_num < 0 && isStreamingFrozen() )
+	{
+		unlock();
+		return false;
+	}
+
 	if ( tcos.size() == 0 )
 	{
 		unlock();
@@ -659,20 +681,11 @@ bool InstrumentTrack::play( const MidiTime & _start, const fpp_t _frames,
 
 		// get all notes from the given pattern...
 		const NoteVector & notes = p->notes();
-		// ...and set our index to zero
+		// ...and skip the ones which are posated before start-tact
 		NoteVector::ConstIterator nit = notes.begin();
-
-		// very effective algorithm for playing notes that are
-		// posated within the current sample-frame
-
-
 		if( cur_start > 0 )
 		{
-			// skip notes which are posated before start-tact
-			while( nit != notes.end() && ( *nit )->pos() < cur_start )
-			{
-				++nit;
-			}
+			nit += qMin( p->firstNoteAt( cur_start ), notes.size() );
 		}
 
 		Note * cur_note;
@@ -730,6 +743,11 @@ void InstrumentTrack::saveTrackSpecificSettings( QDomDocument& doc, QDomElement
 	m_effectChannelModel.saveSettings( doc, thisElement, "fxch" );
 	m_baseNoteModel.saveSettings( doc, thisElement, "basenote" );
 	m_useMasterPitchModel.saveSettings( doc, thisElement, "usemasterpitch");
+	m_frozenModel.saveSettings( doc, thisElement, "frozen" );
+	if( m_frozenModel.value() )
+	{
+		thisElement.setAttribute( "freezefile", m_freezeFile );
+	}
 
 	if( m_instrument != NULL )
 	{
@@ -765,6 +783,9 @@ void InstrumentTrack::loadTrackSpecificSettings( const QDomElement & thisElement
 	}
 	m_baseNoteModel.loadSettings( thisElement, "basenote" );
 	m_useMasterPitchModel.loadSettings( thisElement, "usemasterpitch");
+	// picked up by updateFrozen()
+	m_freezeFile = thisElement.attribute( "freezefile" );
+	m_frozenModel.loadSettings( thisElement, "frozen" );
 
 	// clear effect-chain just in case we load an old preset without FX-data
 	m_audioPort.effects()->clear();
@@ -837,6 +858,254 @@ void InstrumentTrack::setPreviewMode( const bool value )
 
 
 
+bool InstrumentTrack::isStreamingFrozen() const
+{
+	return m_freezeCache && m_freezeCache->isStreaming();
+}
+
+
+
+
+void InstrumentTrack::updateFrozen()
+{
+	if( !m_frozenModel.value() )
+	{
+		// don't pull the cache away from under a running render
+		if( m_freezeCache && !m_freezeCache->isRecording() )
+		{
+			setFreezeCache( NULL );
+		}
+		return;
+	}
+
+	// there's nothing to play back unless FreezeRenderer has just
+	// rendered us or the render can be read from next to the project
+	if( ( m_freezeCache && m_freezeCache->isComplete() ) ||
+							loadFreezeCache() )
+	{
+		connectFreezeSources();
+		return;
+	}
+
+	m_frozenModel.setValue( false );
+}
+
+
+
+
+tick_t InstrumentTrack::freezeLength() const
+{
+	// the cache covers all our TCOs plus one tact for release and
+	// effect tails
+	tick_t length = 0;
+	for( TrackContentObject * tco : getTCOs() )
+	{
+		length = qMax<tick_t>( length, tco->endPosition() );
+	}
+	return length + MidiTime::ticksPerTact();
+}
+
+
+
+
+void InstrumentTrack::startFreezing()
+{
+	FreezeCache * cache = new FreezeCache;
+	cache->startRecording( freezeLength() );
+	setFreezeCache( cache );
+}
+
+
+
+
+bool InstrumentTrack::finishFreezing()
+{
+	if( m_freezeCache == NULL || !m_freezeCache->isRecording() )
+	{
+		return false;
+	}
+
+	if( !m_freezeCache->finishRecording() )
+	{
+		setFreezeCache( NULL );
+		return false;
+	}
+
+	m_freezeFile = QUuid::createUuid().toString().mid( 1, 36 ) + ".frz";
+	m_frozenModel.setValue( true );
+
+	return true;
+}
+
+
+
+
+bool InstrumentTrack::writeFreezeCache( const QString & projectFile ) const
+{
+	if( !m_frozenModel.value() || m_freezeCache == NULL ||
+					!m_freezeCache->isComplete() )
+	{
+		return true;
+	}
+
+	QDir dir( FreezeCache::directoryFor( projectFile ) );
+	if( dir.exists( m_freezeFile ) )
+	{
+		return true;
+	}
+
+	return dir.mkpath( "." ) &&
+			m_freezeCache->save( dir.filePath( m_freezeFile ) );
+}
+
+
+
+
+bool InstrumentTrack::loadFreezeCache()
+{
+	// only the song can be frozen - BB tracks are played per TCO
+	const QString & projectFile = Engine::getSong()->projectFileName();
+	if( trackContainer() != Engine::getSong() || m_freezeFile.isEmpty() ||
+						projectFile.isEmpty() )
+	{
+		return false;
+	}
+
+	FreezeCache * cache = new FreezeCache;
+	if( !cache->load( QDir( FreezeCache::directoryFor( projectFile ) ).
+						filePath( m_freezeFile ) ) )
+	{
+		delete cache;
+		return false;
+	}
+
+	setFreezeCache( cache );
+	return true;
+}
+
+
+
+
+void InstrumentTrack::setFreezeCache( FreezeCache * cache )
+{
+	FreezeCache * old = m_freezeCache;
+
+	Engine::mixer()->requestChangeInModel();
+	m_freezeCache = cache;
+	m_audioPort.setFreezeCache( m_freezeCache );
+	Engine::mixer()->doneChangeInModel();
+
+	delete old;
+}
+
+
+
+
+void InstrumentTrack::invalidateFreezeCache()
+{
+	// nothing to do while we're being rendered or still loading - the
+	// render that's being loaded matches what has been saved
+	if( m_freezeCache == NULL || m_freezeCache->isRecording() ||
+				Engine::getSong()->isLoadingProject() )
+	{
+		return;
+	}
+
+	// automated values are part of the song and have been rendered into
+	// the cache like everything else
+	AutomatableModel * m = dynamic_cast<AutomatableModel *>( sender() );
+	if( m && m->isAutomatedOrControlled() )
+	{
+		return;
+	}
+
+	// the track has to be rendered again to be frozen
+	m_frozenModel.setValue( false );
+}
+
+
+
+
+void InstrumentTrack::connectFreezeSources()
+{
+	// all of this is safe to call repeatedly thanks to
+	// Qt::UniqueConnection
+	QList<AutomatableModel *> models = findChildren<AutomatableModel *>();
+	models += m_audioPort.effects()->findChildren<AutomatableModel *>();
+	if( m_instrument )
+	{
+		models += m_instrument->findChildren<AutomatableModel *>();
+	}
+
+	// the cache maps ticks to frames, so it depends on the tempo map - but
+	// not on the tempo changing during playback as it's been automated
+	models += &Engine::getSong()->getTempoModel();
+
+	for( AutomatableModel * m : models )
+	{
+		// muting just silences the port, it doesn't change what
+		// has been rendered
+		if( m == &m_frozenModel || m == &m_mutedModel )
+		{
+			continue;
+		}
+		connect( m, SIGNAL( dataChanged() ),
+				this, SLOT( invalidateFreezeCache() ),
+				Qt::UniqueConnection );
+
+		// editing the automation changes what would be rendered
+		for( AutomationPattern * p : AutomationPattern::patternsForModel( m ) )
+		{
+			connect( p, SIGNAL( dataChanged() ),
+					this, SLOT( invalidateFreezeCache() ),
+					Qt::UniqueConnection );
+		}
+	}
+
+	for( TrackContentObject * tco : getTCOs() )
+	{
+		connect( tco, SIGNAL( dataChanged() ),
+				this, SLOT( invalidateFreezeCache() ),
+				Qt::UniqueConnection );
+		connect( tco, SIGNAL( positionChanged() ),
+				this, SLOT( invalidateFreezeCache() ),
+				Qt::UniqueConnection );
+		connect( tco, SIGNAL( lengthChanged() ),
+				this, SLOT( invalidateFreezeCache() ),
+				Qt::UniqueConnection );
+		connect( tco, SIGNAL( destroyedTCO() ),
+				this, SLOT( invalidateFreezeCache() ),
+				Qt::UniqueConnection );
+	}
+
+	// new instruments, effects and TCOs bring new models with them, and
+	// automation patterns are only resolved once the project is loaded
+	connect( this, SIGNAL( instrumentChanged() ),
+				this, SLOT( connectFreezeSources() ),
+				Qt::UniqueConnection );
+	connect( this, SIGNAL( instrumentChanged() ),
+				this, SLOT( invalidateFreezeCache() ),
+				Qt::UniqueConnection );
+	connect( this, SIGNAL( trackContentObjectAdded( TrackContentObject * ) ),
+				this, SLOT( connectFreezeSources() ),
+				Qt::UniqueConnection );
+	connect( this, SIGNAL( trackContentObjectAdded( TrackContentObject * ) ),
+				this, SLOT( invalidateFreezeCache() ),
+				Qt::UniqueConnection );
+	connect( m_audioPort.effects(), SIGNAL( dataChanged() ),
+				this, SLOT( connectFreezeSources() ),
+				Qt::UniqueConnection );
+	connect( m_audioPort.effects(), SIGNAL( dataChanged() ),
+				this, SLOT( invalidateFreezeCache() ),
+				Qt::UniqueConnection );
+	connect( Engine::getSong(), SIGNAL( projectLoaded() ),
+				this, SLOT( connectFreezeSources() ),
+				Qt::UniqueConnection );
+}
+
+
+
+
 Instrument * InstrumentTrack::loadInstrument( const QString & _plugin_name )
 {
 	silenceAllNotes( true );
@@ -1023,6 +1292,42 @@ void InstrumentTrackView::assignFxLine(int channelIndex)
 
 
 
+
+void InstrumentTrackView::toggleFrozen( bool frozen )
+{
+	if( !frozen )
+	{
+		model()->frozenModel()->setValue( false );
+		return;
+	}
+
+	// the song is rendered in the background - the modal dialog keeps it
+	// from being edited meanwhile
+	QProgressDialog * pd = new QProgressDialog(
+				tr( "Freezing %1..." ).arg( model()->name() ),
+				tr( "Cancel" ), 0, 100, gui->mainWindow() );
+	pd->setWindowTitle( tr( "Please wait..." ) );
+	pd->setWindowModality( Qt::ApplicationModal );
+	pd->setMinimumDuration( 0 );
+	pd->setAutoReset( false );
+	pd->setAutoClose( false );
+
+	FreezeRenderer * renderer = new FreezeRenderer( model() );
+	connect( renderer, SIGNAL( progressChanged( int ) ),
+					pd, SLOT( setValue( int ) ) );
+	connect( pd, SIGNAL( canceled() ),
+					renderer, SLOT( abortProcessing() ) );
+	connect( renderer, SIGNAL( finishedFreezing( bool ) ),
+					pd, SLOT( deleteLater() ) );
+	connect( renderer, SIGNAL( finishedFreezing( bool ) ),
+					renderer, SLOT( deleteLater() ) );
+
+	pd->show();
+	renderer->startProcessing();
+}
+
+
+
 // TODO: Add windows to free list on freeInstrumentTrackWindow.
 // But, don't NULL m_window or disconnect signals.  This will allow windows
 // that are being show/hidden frequently to stay connected.
@@ -54,6 +54,7 @@ Pattern::Pattern( InstrumentTrack * _instrument_track ) :
 	TrackContentObject( _instrument_track ),
 	m_instrumentTrack( _instrument_track ),
 	m_patternType( BeatPattern ),
+	m_maxNoteLength( 0 ),
 	m_steps( MidiTime::stepsPerTact() )
 {
 	setName( _instrument_track->name() );
@@ -73,6 +74,8 @@ Pattern::Pattern( const Pattern& other ) :
 	TrackContentObject( other.m_instrumentTrack ),
 	m_instrumentTrack( other.m_instrumentTrack ),
 	m_patternType( other.m_patternType ),
+	m_noteData( other.m_noteData ),
+	m_maxNoteLength( other.m_maxNoteLength ),
 	m_steps( other.m_steps )
 {
 	for( NoteVector::ConstIterator it = other.m_notes.begin(); it != other.m_notes.end(); ++it )
@@ -112,6 +115,52 @@ Pattern::~Pattern()
 
 
 
+int Pattern::firstNoteAt( const MidiTime & _pos ) const
+{
+	const QVector<tick_t> & positions = m_noteData.positions;
+	return std::lower_bound( positions.begin(), positions.end(),
+					_pos.getTicks() ) - positions.begin();
+}
+
+
+
+
+void Pattern::notesInRange( const MidiTime & _start, const MidiTime & _end,
+						int & _first, int & _last ) const
+{
+	_first = firstNoteAt( _start - m_maxNoteLength );
+	_last = firstNoteAt( _end + 1 );
+}
+
+
+
+
+void Pattern::updateNoteData()
+{
+	const int count = m_notes.size();
+	m_noteData.positions.resize( count );
+	m_noteData.lengths.resize( count );
+	m_noteData.keys.resize( count );
+	m_noteData.volumes.resize( count );
+	m_noteData.pannings.resize( count );
+
+	m_maxNoteLength = 0;
+	for( int i = 0; i < count; ++i )
+	{
+		const Note * note = m_notes[i];
+		m_noteData.positions[i] = note->pos();
+		m_noteData.lengths[i] = note->length();
+		m_noteData.keys[i] = note->key();
+		m_noteData.volumes[i] = note->getVolume();
+		m_noteData.pannings[i] = note->getPanning();
+		m_maxNoteLength = qMax<tick_t>( m_maxNoteLength,
+						m_noteData.lengths[i] );
+	}
+}
+
+
+
+
 void Pattern::resizeToFirstTrack()
 {
 	// Resize this track to be the same as existing tracks in the BB
@@ -141,6 +190,9 @@ void Pattern::init()
 {
 	connect( Engine::getSong(), SIGNAL( timeSignatureChanged( int, int ) ),
 				this, SLOT( changeTimeSignature() ) );
+	// the editors change notes in place and tell us afterwards
+	connect( this, SIGNAL( dataChanged() ),
+			this, SLOT( rearrangeAllNotes() ), Qt::DirectConnection );
 	saveJournallingState( false );
 
 	updateLength();
@@ -161,13 +213,14 @@ void Pattern::updateLength()
 
 	tick_t max_length = MidiTime::ticksPerTact();
 
-	for( NoteVector::ConstIterator it = m_notes.begin();
-						it != m_notes.end(); ++it )
+	const QVector<tick_t> & positions = m_noteData.positions;
+	const QVector<tick_t> & lengths = m_noteData.lengths;
+	for( int i = 0; i < lengths.size(); ++i )
 	{
-		if( ( *it )->length() > 0 )
+		if( lengths[i] > 0 )
 		{
 			max_length = qMax<tick_t>( max_length,
-							( *it )->endPos() );
+						positions[i] + lengths[i] );
 		}
 	}
 	changeLength( MidiTime( max_length ).nextFullTact() *
@@ -182,13 +235,14 @@ MidiTime Pattern::beatPatternLength() const
 {
 	tick_t max_length = MidiTime::ticksPerTact();
 
-	for( NoteVector::ConstIterator it = m_notes.begin();
-						it != m_notes.end(); ++it )
+	const QVector<tick_t> & positions = m_noteData.positions;
+	const QVector<tick_t> & lengths = m_noteData.lengths;
+	for( int i = 0; i < lengths.size(); ++i )
 	{
-		if( ( *it )->length() < 0 )
+		if( lengths[i] < 0 )
 		{
 			max_length = qMax<tick_t>( max_length,
-				( *it )->pos() + 1 );
+							positions[i] + 1 );
 		}
 	}
 
@@ -214,6 +268,7 @@ Note * Pattern::addNote( const Note & _new_note, const bool _quant_pos )
 
 	instrumentTrack()->lock();
 	m_notes.insert(std::upper_bound(m_notes.begin(), m_notes.end(), new_note, Note::lessThan), new_note);
+	updateNoteData();
 	instrumentTrack()->unlock();
 
 	checkType();
@@ -227,6 +282,43 @@ Note * Pattern::addNote( const Note & _new_note, const bool _quant_pos )
 
 
 
+void Pattern::addNotes( const QVector<Note> & _new_notes,
+						const bool _quant_pos )
+{
+	if( _new_notes.isEmpty() )
+	{
+		return;
+	}
+
+	const bool quantize = _quant_pos && gui->pianoRoll();
+
+	instrumentTrack()->lock();
+	m_notes.reserve( m_notes.size() + _new_notes.size() );
+	for( QVector<Note>::ConstIterator it = _new_notes.begin();
+						it != _new_notes.end(); ++it )
+	{
+		Note * new_note = new Note( *it );
+		if( quantize )
+		{
+			new_note->quantizePos( gui->pianoRoll()->quantization() );
+		}
+		m_notes.push_back( new_note );
+	}
+	// keeps notes at equal positions in the order they were added, just
+	// like addNote() does
+	std::stable_sort( m_notes.begin(), m_notes.end(), Note::lessThan );
+	updateNoteData();
+	instrumentTrack()->unlock();
+
+	checkType();
+	updateLength();
+
+	emit dataChanged();
+}
+
+
+
+
 void Pattern::removeNote( Note * _note_to_del )
 {
 	instrumentTrack()->lock();
@@ -241,6 +333,7 @@ void Pattern::removeNote( Note * _note_to_del )
 		}
 		++it;
 	}
+	updateNoteData();
 	instrumentTrack()->unlock();
 
 	checkType();
@@ -254,13 +347,13 @@ void Pattern::removeNote( Note * _note_to_del )
 
 Note * Pattern::noteAtStep( int _step )
 {
-	for( NoteVector::Iterator it = m_notes.begin(); it != m_notes.end();
-									++it )
+	const tick_t pos = MidiTime::stepPosition( _step );
+	for( int i = firstNoteAt( pos ); i < m_notes.size() &&
+					m_noteData.positions[i] == pos; ++i )
 	{
-		if( ( *it )->pos() == MidiTime::stepPosition( _step )
-						&& ( *it )->length() < 0 )
+		if( m_noteData.lengths[i] < 0 )
 		{
-			return *it;
+			return m_notes[i];
 		}
 	}
 	return NULL;
@@ -270,8 +363,12 @@ Note * Pattern::noteAtStep( int _step )
 
 void Pattern::rearrangeAllNotes()
 {
-	// sort notes by start time
-	std::sort(m_notes.begin(), m_notes.end(), Note::lessThan);
+	// sort notes by start time - notes at equal positions keep their
+	// order, as this is also done while notes are being dragged around
+	instrumentTrack()->lock();
+	std::stable_sort( m_notes.begin(), m_notes.end(), Note::lessThan );
+	updateNoteData();
+	instrumentTrack()->unlock();
 }
 
 
@@ -285,6 +382,7 @@ void Pattern::clearNotes()
 		delete *it;
 	}
 	m_notes.clear();
+	updateNoteData();
 	instrumentTrack()->unlock();
 
 	checkType();
@@ -337,15 +435,13 @@ void Pattern::setType( PatternTypes _new_pattern_type )
 
 void Pattern::checkType()
 {
-	NoteVector::Iterator it = m_notes.begin();
-	while( it != m_notes.end() )
+	for( tick_t length : m_noteData.lengths )
 	{
-		if( ( *it )->length() > 0 )
+		if( length > 0 )
 		{
 			setType( MelodyPattern );
 			return;
 		}
-		++it;
 	}
 	setType( BeatPattern );
 }
@@ -412,6 +508,10 @@ void Pattern::loadSettings( const QDomElement & _this )
 		node = node.nextSibling();
         }
 
+	instrumentTrack()->lock();
+	updateNoteData();
+	instrumentTrack()->unlock();
+
 	m_steps = _this.attribute( "steps" ).toInt();
 	if( m_steps == 0 )
 	{
@@ -486,6 +586,7 @@ void Pattern::cloneSteps()
 			newNote->setVolume( toCopy->getVolume() );
 		}
 	}
+	rearrangeAllNotes();
 	updateLength();
 	emit dataChanged();
 }
@@ -581,6 +682,10 @@ PatternView::PatternView( Pattern* pattern, TrackView* parent ) :
 	connect( gui->pianoRoll(), SIGNAL( currentPatternChanged() ),
 			this, SLOT( update() ) );
 
+	// the cached pixmap covers the whole view, so there's no need to
+	// paint the track's background first
+	setAttribute( Qt::WA_OpaquePaintEvent, true );
+
 	if( s_stepBtnOn0 == NULL )
 	{
 		s_stepBtnOn0 = new QPixmap( embed::getIconPixmap(
@@ -818,6 +923,7 @@ void PatternView::wheelEvent( QWheelEvent * _we )
 			{
 				n->setVolume( qMax( 0, vol - 5 ) );
 			}
+			m_pat->dataChanged();
 
 			Engine::getSong()->setModified();
 			update();
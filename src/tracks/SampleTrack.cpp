@@ -58,6 +58,10 @@ SampleTCO::SampleTCO( Track * _track ) :
 	setSampleFile( "" );
 	restoreJournallingState();
 
+	// long samples get their waveform overview a bit later
+	connect( m_sampleBuffer, SIGNAL( peaksUpdated() ),
+					this, SIGNAL( sampleChanged() ) );
+
 	// we need to receive bpm-change-events, because then we have to
 	// change length of this TCO
 	connect( Engine::getSong(), SIGNAL( tempoChanged( bpm_t ) ),
@@ -133,8 +137,12 @@ const QString & SampleTCO::sampleFile() const
 
 void SampleTCO::setSampleBuffer( SampleBuffer* sb )
 {
+	disconnect( m_sampleBuffer, SIGNAL( peaksUpdated() ),
+					this, SIGNAL( sampleChanged() ) );
 	sharedObject::unref( m_sampleBuffer );
 	m_sampleBuffer = sb;
+	connect( m_sampleBuffer, SIGNAL( peaksUpdated() ),
+					this, SIGNAL( sampleChanged() ) );
 	updateLength();
 
 	emit sampleChanged();
@@ -289,6 +297,7 @@ SampleTCOView::SampleTCOView( SampleTCO * _tco, TrackView * _tv ) :
 	connect( m_tco, SIGNAL( sampleChanged() ),
 			this, SLOT( updateSample() ) );
 
+	setAttribute( Qt::WA_OpaquePaintEvent, true );
 	setStyle( QApplication::style() );
 }
 
@@ -0,0 +1,75 @@
+/*
+ * SampleBufferTest.cpp
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include "QTestSuite.h"
+
+#include "SampleBuffer.h"
+
+class SampleBufferTest : QTestSuite
+{
+	Q_OBJECT
+private slots:
+	void testUpdateKeepsRawDataLength()
+	{
+		const f_cnt_t frames = 100;
+		sampleFrame data[frames];
+		for (f_cnt_t f = 0; f < frames; ++f)
+		{
+			data[f][0] = f / 100.0f;
+			data[f][1] = -f / 100.0f;
+		}
+
+		SampleBuffer buffer(data, frames);
+		QCOMPARE(buffer.frames(), frames);
+		QCOMPARE(buffer.endFrame(), frames);
+
+		// both end up in update(true) on a buffer that isn't backed by
+		// a file
+		buffer.setReversed(true);
+		QCOMPARE(buffer.frames(), frames);
+		QCOMPARE(buffer.endFrame(), frames);
+
+		buffer.sampleRateChanged();
+		QCOMPARE(buffer.frames(), frames);
+		QCOMPARE(buffer.endFrame(), frames);
+		QCOMPARE(buffer.data()[42][0], data[42][0]);
+		QCOMPARE(buffer.data()[99][1], data[99][1]);
+	}
+
+	void testUpdateKeepsPointFrames()
+	{
+		const f_cnt_t frames = 64;
+		sampleFrame data[frames] = {};
+
+		SampleBuffer buffer(data, frames);
+		buffer.setAllPointFrames(8, 48, 16, 32);
+		buffer.sampleRateChanged();
+
+		QCOMPARE(buffer.frames(), frames);
+		QCOMPARE(buffer.startFrame(), 8);
+		QCOMPARE(buffer.endFrame(), 48);
+		QCOMPARE(buffer.loopStartFrame(), 16);
+		QCOMPARE(buffer.loopEndFrame(), 32);
+	}
+} SampleBufferTests;
+
+#include "SampleBufferTest.moc"
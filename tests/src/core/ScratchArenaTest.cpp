@@ -0,0 +1,106 @@
+/*
+ * ScratchArenaTest.cpp
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include "QTestSuite.h"
+
+#include <cstdint>
+
+#include "ScratchArena.h"
+
+class ScratchArenaTest : QTestSuite
+{
+	Q_OBJECT
+private slots:
+	void testAllocIsAlignedAndDisjoint()
+	{
+		ScratchArena::reset();
+
+		char * a = SCRATCH_ALLOC( char, 3 );
+		char * b = SCRATCH_ALLOC( char, 100 );
+		QVERIFY(a != NULL);
+		QVERIFY(b != NULL);
+		QCOMPARE(reinterpret_cast<uintptr_t>(a) % 16, uintptr_t(0));
+		QCOMPARE(reinterpret_cast<uintptr_t>(b) % 16, uintptr_t(0));
+		QVERIFY(b >= a + 3);
+
+		SCRATCH_FREE( b );
+		SCRATCH_FREE( a );
+		ScratchArena::reset();
+	}
+
+	void testFreeLastReusesMemory()
+	{
+		ScratchArena::reset();
+
+		float * a = SCRATCH_ALLOC( float, 64 );
+		float * b = SCRATCH_ALLOC( float, 64 );
+		SCRATCH_FREE( b );
+		float * c = SCRATCH_ALLOC( float, 64 );
+		QCOMPARE(c, b);
+
+		// freeing anything but the most recent allocation keeps it in use
+		SCRATCH_FREE( a );
+		float * d = SCRATCH_ALLOC( float, 64 );
+		QVERIFY(d != a);
+		QVERIFY(d != c);
+
+		ScratchArena::reset();
+	}
+
+	void testResetStartsOver()
+	{
+		ScratchArena::reset();
+
+		int * a = SCRATCH_ALLOC( int, 16 );
+		SCRATCH_ALLOC( int, 1000 );
+		SCRATCH_ALLOC( int, 1000 );
+		ScratchArena::reset();
+
+		int * b = SCRATCH_ALLOC( int, 16 );
+		QCOMPARE(b, a);
+
+		ScratchArena::reset();
+	}
+
+	void testOversizedAllocFallsBack()
+	{
+		ScratchArena::reset();
+
+		// larger than the whole arena
+		const size_t count = 2 * 1024 * 1024;
+		char * big = SCRATCH_ALLOC( char, count );
+		QVERIFY(big != NULL);
+		big[0] = 1;
+		big[count - 1] = 1;
+
+		// the arena itself is still usable
+		char * small = SCRATCH_ALLOC( char, 16 );
+		QVERIFY(small != NULL);
+		QVERIFY(small + 16 <= big || small >= big + count);
+
+		SCRATCH_FREE( small );
+		SCRATCH_FREE( big );
+		ScratchArena::reset();
+	}
+} ScratchArenaTests;
+
+#include "ScratchArenaTest.moc"
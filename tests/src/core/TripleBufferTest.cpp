@@ -0,0 +1,93 @@
+/*
+ * TripleBufferTest.cpp
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include "QTestSuite.h"
+
+#include "TripleBuffer.h"
+
+class TripleBufferTest : QTestSuite
+{
+	Q_OBJECT
+private slots:
+	void testNothingPublished()
+	{
+		TripleBuffer<int> buffer;
+		QVERIFY(buffer.isConsumed());
+		QVERIFY(!buffer.update());
+	}
+
+	void testPublishUpdate()
+	{
+		TripleBuffer<int> buffer;
+		buffer.at(0) = buffer.at(1) = buffer.at(2) = 0;
+
+		buffer.writeBuffer() = 42;
+		buffer.publish();
+		QVERIFY(!buffer.isConsumed());
+
+		QVERIFY(buffer.update());
+		QVERIFY(buffer.isConsumed());
+		QCOMPARE(buffer.readBuffer(), 42);
+
+		// nothing new, the read buffer stays as it is
+		QVERIFY(!buffer.update());
+		QCOMPARE(buffer.readBuffer(), 42);
+	}
+
+	void testReaderSeesLatestPublication()
+	{
+		TripleBuffer<int> buffer;
+
+		for (int i = 1; i <= 5; ++i)
+		{
+			buffer.writeBuffer() = i;
+			buffer.publish();
+		}
+
+		QVERIFY(buffer.update());
+		QCOMPARE(buffer.readBuffer(), 5);
+		QVERIFY(!buffer.update());
+	}
+
+	void testWriterNeverTouchesReadBuffer()
+	{
+		TripleBuffer<int> buffer;
+
+		buffer.writeBuffer() = 1;
+		buffer.publish();
+		QVERIFY(buffer.update());
+
+		// keep publishing without the reader picking anything up
+		for (int i = 2; i <= 10; ++i)
+		{
+			QVERIFY(&buffer.writeBuffer() != &buffer.readBuffer());
+			buffer.writeBuffer() = i;
+			buffer.publish();
+			QCOMPARE(buffer.readBuffer(), 1);
+		}
+
+		QVERIFY(buffer.update());
+		QCOMPARE(buffer.readBuffer(), 10);
+	}
+} TripleBufferTests;
+
+#include "TripleBufferTest.moc"
@@ -0,0 +1,160 @@
+/*
+ * PatternTest.cpp
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include "QTestSuite.h"
+
+#include "InstrumentTrack.h"
+#include "Note.h"
+#include "Pattern.h"
+
+#include "Engine.h"
+#include "Song.h"
+
+class PatternTest : QTestSuite
+{
+	Q_OBJECT
+private:
+	// checks that [first, last) covers every note overlapping the ticks
+	// from start to end and no note starting after end
+	static void checkRange(Pattern* pattern, int start, int end)
+	{
+		int first, last;
+		pattern->notesInRange(start, end, first, last);
+
+		const NoteVector& notes = pattern->notes();
+		QVERIFY(first >= 0);
+		QVERIFY(first <= last);
+		QVERIFY(last <= notes.size());
+
+		for (int i = 0; i < notes.size(); ++i)
+		{
+			const Note* note = notes[i];
+			if (note->pos() <= end && note->endPos() >= start)
+			{
+				QVERIFY(i >= first && i < last);
+			}
+			if (note->pos() > end)
+			{
+				QVERIFY(i >= last);
+			}
+		}
+	}
+
+	static Pattern* createPattern()
+	{
+		InstrumentTrack* instrumentTrack = dynamic_cast<InstrumentTrack*>(
+				Track::create(Track::InstrumentTrack, Engine::getSong()));
+		return dynamic_cast<Pattern*>(instrumentTrack->createTCO(0));
+	}
+
+private slots:
+	void testNotesInRangeEmpty()
+	{
+		Pattern* pattern = createPattern();
+
+		int first, last;
+		pattern->notesInRange(0, 1000, first, last);
+		QCOMPARE(first, 0);
+		QCOMPARE(last, 0);
+	}
+
+	void testNotesInRange()
+	{
+		Pattern* pattern = createPattern();
+		pattern->addNote(Note(MidiTime(10), MidiTime(0), 60), false);
+		pattern->addNote(Note(MidiTime(100), MidiTime(20), 62), false);
+		pattern->addNote(Note(MidiTime(5), MidiTime(50), 64), false);
+		pattern->addNote(Note(MidiTime(10), MidiTime(200), 65), false);
+
+		checkRange(pattern, 0, 0);
+		checkRange(pattern, 15, 18);
+		checkRange(pattern, 60, 70);
+		checkRange(pattern, 100, 119);
+		checkRange(pattern, 0, 1000);
+
+		// only the long note overlaps these ticks
+		int first, last;
+		pattern->notesInRange(60, 70, first, last);
+		QCOMPARE(last, 3);
+
+		// all notes end long before these ticks
+		pattern->notesInRange(400, 500, first, last);
+		QCOMPARE(first, 4);
+		QCOMPARE(last, 4);
+	}
+
+	void testNotesInRangeAfterEdit()
+	{
+		Pattern* pattern = createPattern();
+		pattern->addNote(Note(MidiTime(10), MidiTime(0), 60), false);
+		Note* note = pattern->addNote(Note(MidiTime(10), MidiTime(100), 62), false);
+		pattern->addNote(Note(MidiTime(10), MidiTime(200), 64), false);
+
+		note->setPos(MidiTime(300));
+		pattern->rearrangeAllNotes();
+		checkRange(pattern, 95, 105);
+		checkRange(pattern, 295, 305);
+
+		int first, last;
+		pattern->notesInRange(295, 305, first, last);
+		QVERIFY(first <= 2 && last == 3);
+		QCOMPARE(pattern->notes()[2], note);
+
+		pattern->removeNote(note);
+		pattern->notesInRange(295, 305, first, last);
+		QCOMPARE(first, 2);
+		QCOMPARE(last, 2);
+	}
+
+	void testNoteDataAfterEdit()
+	{
+		Pattern* pattern = createPattern();
+		pattern->addNote(Note(MidiTime(10), MidiTime(0), 60), false);
+		Note* note = pattern->addNote(Note(MidiTime(10), MidiTime(100), 62), false);
+
+		// editors change notes in place and emit dataChanged() afterwards
+		note->setPos(MidiTime(0));
+		note->setLength(MidiTime(400));
+		note->setKey(70);
+		note->setVolume(50);
+		note->setPanning(-20);
+		pattern->dataChanged();
+
+		const Pattern::NoteData& data = pattern->noteData();
+		QCOMPARE(data.positions.size(), pattern->notes().size());
+		for (int i = 0; i < pattern->notes().size(); ++i)
+		{
+			const Note* n = pattern->notes()[i];
+			QCOMPARE(data.positions[i], n->pos().getTicks());
+			QCOMPARE(data.lengths[i], n->length().getTicks());
+			QCOMPARE(data.keys[i], n->key());
+			QCOMPARE(data.volumes[i], n->getVolume());
+			QCOMPARE(data.pannings[i], n->getPanning());
+		}
+
+		pattern->updateLength();
+		QCOMPARE(pattern->length().getTicks(),
+				MidiTime(400).nextFullTact() * MidiTime::ticksPerTact());
+	}
+} PatternTests;
+
+#include "PatternTest.moc"